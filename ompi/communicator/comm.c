@@ -52,12 +52,21 @@
 #include "ompi/communicator/communicator.h"
 #include "ompi/mca/pml/pml.h"
 #include "ompi/request/request.h"
+#include "ompi/runtime/params.h"
 
 /*
 ** sort-function for MPI_Comm_split
 */
 static int rankkeycompare(const void *, const void *);
 
+/*
+** sort-function for the distributed MPI_Comm_split
+*/
+static int colorkeyrankcompare(const void *, const void *);
+
+static int ompi_comm_split_distributed (ompi_communicator_t *comm, int color, int key,
+                                        int **lranks_out, int *lsize_out);
+
 /**
  * to fill the rest of the stuff for the communicator
  */
@@ -398,6 +407,175 @@ int ompi_comm_create ( ompi_communicator_t *comm, ompi_group_t *group,
 }
 
 
+/**********************************************************************/
+/**********************************************************************/
+/**********************************************************************/
+/*
+** Distributed (color, key) exchange of ompi_comm_split for large
+** intra-communicators. Each color is owned by the rank its hash selects:
+** every process with a color sends its (color, key) to the owner, and the
+** owners, which cannot know how many messages they get, keep receiving
+** until a non-blocking barrier entered once their own send was matched
+** completes. An owner then sorts the members of each of its colors and
+** returns to every member the original ranks of its new group, so no
+** process holds more than the membership of the colors it owns.
+**
+** On return lranks_out holds the ranks of the new group in key order. A
+** process passing MPI_UNDEFINED only gets itself, the communicator
+** built from it is freed by the caller.
+*/
+static int ompi_comm_split_distributed (ompi_communicator_t *comm, int color, int key,
+                                        int **lranks_out, int *lsize_out)
+{
+    int size = ompi_comm_size (comm), rank = ompi_comm_rank (comm);
+    int myinfo[2], owner = -1, flag, done = 0, in_barrier = 0;
+    int count = 0, max = 0, nreqs = 0, first, i, j, n, rc = OMPI_SUCCESS;
+    int *members = NULL, *ranks = NULL, *lranks = NULL, *tmp;
+    ompi_request_t *sreq = MPI_REQUEST_NULL, *breq = MPI_REQUEST_NULL, **reqs = NULL;
+    ompi_status_public_t status;
+
+    *lranks_out = NULL;
+    *lsize_out = 0;
+
+    myinfo[0] = color;
+    myinfo[1] = key;
+
+    /* Step 1: send our (color, key) to the owner of the color. The send is
+     * synchronous so its completion tells the owner got it. */
+    if ( MPI_UNDEFINED != color ) {
+        owner = (int) (((uint32_t) color * 2654435761u) % (uint32_t) size);
+        rc = MCA_PML_CALL(isend (myinfo, 2, MPI_INT, owner, OMPI_COMM_SPLIT_INFO_TAG,
+                                 MCA_PML_BASE_SEND_SYNCHRONOUS, comm, &sreq));
+        if ( OMPI_SUCCESS != rc ) {
+            return rc;
+        }
+    }
+
+    /* Step 2: receive the (color, key, rank) of the colors we own */
+    while ( !done ) {
+        rc = MCA_PML_CALL(iprobe (MPI_ANY_SOURCE, OMPI_COMM_SPLIT_INFO_TAG, comm, &flag, &status));
+        if ( OMPI_SUCCESS != rc ) {
+            goto exit;
+        }
+        if ( flag ) {
+            if ( count == max ) {
+                max = (0 == max) ? 16 : 2 * max;
+                tmp = (int *) realloc (members, 3 * max * sizeof (int));
+                if ( NULL == tmp ) {
+                    rc = OMPI_ERR_OUT_OF_RESOURCE;
+                    goto exit;
+                }
+                members = tmp;
+            }
+            rc = MCA_PML_CALL(recv (members + 3 * count, 2, MPI_INT, status.MPI_SOURCE,
+                                    OMPI_COMM_SPLIT_INFO_TAG, comm, MPI_STATUS_IGNORE));
+            if ( OMPI_SUCCESS != rc ) {
+                goto exit;
+            }
+            members[3 * count + 2] = status.MPI_SOURCE;
+            ++count;
+            continue;
+        }
+
+        if ( in_barrier ) {
+            rc = ompi_request_test (&breq, &done, MPI_STATUS_IGNORE);
+        } else {
+            flag = 1;
+            if ( MPI_REQUEST_NULL != sreq ) {
+                rc = ompi_request_test (&sreq, &flag, MPI_STATUS_IGNORE);
+            }
+            if ( OMPI_SUCCESS == rc && flag ) {
+                rc = comm->c_coll->coll_ibarrier (comm, &breq, comm->c_coll->coll_ibarrier_module);
+                in_barrier = 1;
+            }
+        }
+        if ( OMPI_SUCCESS != rc ) {
+            goto exit;
+        }
+    }
+
+    /* Step 3: hand every member of our colors the ranks of its group */
+    if ( 0 < count ) {
+        if ( count > 1 ) {
+            qsort (members, count, sizeof(int) * 3, colorkeyrankcompare);
+        }
+
+        ranks = (int *) malloc (count * sizeof (int));
+        reqs = (ompi_request_t **) malloc (count * sizeof (ompi_request_t *));
+        if ( NULL == ranks || NULL == reqs ) {
+            rc = OMPI_ERR_OUT_OF_RESOURCE;
+            goto exit;
+        }
+        for ( i = 0; i < count; i++ ) {
+            ranks[i] = members[3 * i + 2];
+        }
+
+        for ( first = 0; first < count; first += n ) {
+            for ( n = 1; first + n < count && members[3 * (first + n)] == members[3 * first]; n++ );
+            for ( j = first; j < first + n; j++ ) {
+                rc = MCA_PML_CALL(isend (ranks + first, n, MPI_INT, ranks[j],
+                                         OMPI_COMM_SPLIT_MEMBERS_TAG, MCA_PML_BASE_SEND_STANDARD,
+                                         comm, &reqs[nreqs]));
+                if ( OMPI_SUCCESS != rc ) {
+                    goto exit;
+                }
+                nreqs++;
+            }
+        }
+    }
+
+    if ( MPI_UNDEFINED != color ) {
+        rc = MCA_PML_CALL(probe (owner, OMPI_COMM_SPLIT_MEMBERS_TAG, comm, &status));
+        if ( OMPI_SUCCESS != rc ) {
+            goto exit;
+        }
+        n = (int) (status._ucount / sizeof (int));
+    } else {
+        n = 1;
+    }
+
+    lranks = (int *) malloc (n * sizeof (int));
+    if ( NULL == lranks ) {
+        rc = OMPI_ERR_OUT_OF_RESOURCE;
+        goto exit;
+    }
+
+    if ( MPI_UNDEFINED != color ) {
+        rc = MCA_PML_CALL(recv (lranks, n, MPI_INT, owner, OMPI_COMM_SPLIT_MEMBERS_TAG,
+                                comm, MPI_STATUS_IGNORE));
+        if ( OMPI_SUCCESS != rc ) {
+            goto exit;
+        }
+    } else {
+        lranks[0] = rank;
+    }
+
+    *lranks_out = lranks;
+    *lsize_out = n;
+    lranks = NULL;
+
+ exit:
+    if ( 0 < nreqs ) {
+        if ( OMPI_SUCCESS == rc ) {
+            rc = ompi_request_wait_all (nreqs, reqs, MPI_STATUSES_IGNORE);
+        } else {
+            (void) ompi_request_wait_all (nreqs, reqs, MPI_STATUSES_IGNORE);
+        }
+        if ( OMPI_SUCCESS != rc ) {
+            free (*lranks_out);
+            *lranks_out = NULL;
+            *lsize_out = 0;
+        }
+    }
+    free (members);
+    free (ranks);
+    free (reqs);
+    free (lranks);
+
+    return rc;
+}
+
+
 /**********************************************************************/
 /**********************************************************************/
 /**********************************************************************/
@@ -432,6 +610,20 @@ int ompi_comm_split( ompi_communicator_t* comm, int color, int key,
 
     size     = ompi_comm_size ( comm );
     inter    = OMPI_COMM_IS_INTER(comm);
+
+    /* large intra-communicators: only learn the membership of our new group */
+    if ( !inter && 0 < ompi_mpi_comm_split_distributed_min &&
+         size >= ompi_mpi_comm_split_distributed_min &&
+         NULL != comm->c_coll->coll_ibarrier ) {
+        rc = ompi_comm_split_distributed (comm, color, key, &lranks, &my_size);
+        if ( OMPI_SUCCESS != rc ) {
+            goto exit;
+        }
+        rranks = NULL;
+        mode = OMPI_COMM_CID_INTRA;
+        goto set_comm;
+    }
+
     if ( inter ) {
         allgatherfct = (ompi_comm_allgatherfct *)ompi_comm_allgather_emulate_intra;
     } else {
@@ -567,6 +759,7 @@ int ompi_comm_split( ompi_communicator_t* comm, int color, int key,
     /* --------------------------------------------------------- */
     /* Create the communicator finally */
 
+ set_comm:
     rc = ompi_comm_set ( &newcomp,           /* new comm */
                          comm,               /* old comm */
                          my_size,            /* local_size */
@@ -1831,6 +2024,23 @@ int ompi_comm_dump ( ompi_communicator_t *comm )
 /********************************************************************************/
 /********************************************************************************/
 /* static functions */
+/*
+** colorkeyrankcompare() orders (color,key,rank) triples by color and then
+** in the order a MPI_Comm_split gives the members of one color
+*/
+static int colorkeyrankcompare (const void *p, const void *q)
+{
+    const int *a = (const int *) p, *b = (const int *) q;
+
+    if (a[0] != b[0]) {
+        return (a[0] < b[0]) ? -1 : 1;
+    }
+    if (a[1] != b[1]) {
+        return (a[1] < b[1]) ? -1 : 1;
+    }
+    return (a[2] < b[2]) ? -1 : (a[2] > b[2]);
+}
+
 /*
 ** rankkeygidcompare() compares a tuple of (rank,key,gid) producing
 ** sorted lists that match the rules needed for a MPI_Comm_split
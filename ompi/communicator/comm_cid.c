@@ -42,11 +42,13 @@
 #include "ompi/constants.h"
 #include "opal/class/opal_pointer_array.h"
 #include "opal/class/opal_list.h"
+#include "opal/class/opal_bitmap.h"
 #include "ompi/mca/pml/pml.h"
 #include "ompi/runtime/ompi_rte.h"
 #include "ompi/mca/coll/base/base.h"
 #include "ompi/request/request.h"
 #include "ompi/runtime/mpiruntime.h"
+#include "ompi/runtime/params.h"
 
 struct ompi_comm_cid_context_t;
 
@@ -68,6 +70,10 @@ struct ompi_comm_cid_context_t {
     int nextcid;
     int nextlocal_cid;
     int start;
+    /** number of consecutive cids to agree on */
+    int block;
+    /** start of the cid search, kept to retry with a single cid */
+    int first_start;
     int flag, rflag;
     int local_leader;
     int remote_leader;
@@ -158,12 +164,66 @@ static int ompi_comm_allreduce_intra_bridge_nb (int *inbuf, int *outbuf, int cou
 
 static opal_mutex_t ompi_cid_lock = OPAL_MUTEX_STATIC_INIT;
 
+/* cids reserved by a parent for its future children. They are kept out of
+ * ompi_mpi_communicators, which must only reference real communicators */
+static opal_bitmap_t ompi_comm_cid_reserved;
+
+/* c_id_start_index of a parent while a block is being agreed on for it */
+#define OMPI_COMM_CID_BLOCK_PENDING -2
+
 
 int ompi_comm_cid_init (void)
 {
+    OBJ_CONSTRUCT(&ompi_comm_cid_reserved, opal_bitmap_t);
+    return opal_bitmap_init (&ompi_comm_cid_reserved, 64);
+}
+
+int ompi_comm_cid_finalize (void)
+{
+    OBJ_DESTRUCT(&ompi_comm_cid_reserved);
     return OMPI_SUCCESS;
 }
 
+void ompi_comm_cid_release_block (ompi_communicator_t *comm)
+{
+    if (0 > comm->c_id_start_index) {
+        return;
+    }
+
+    OPAL_THREAD_LOCK(&ompi_cid_lock);
+    for (int i = comm->c_id_available ; i < comm->c_id_start_index + ompi_mpi_comm_cid_block_size ; ++i) {
+        (void) opal_bitmap_clear_bit (&ompi_comm_cid_reserved, i);
+    }
+    comm->c_id_start_index = MPI_UNDEFINED;
+    comm->c_id_available = MPI_UNDEFINED;
+    OPAL_THREAD_UNLOCK(&ompi_cid_lock);
+}
+
+static void ompi_comm_cid_release_range (unsigned int cid, int count)
+{
+    for (int i = 0 ; i < count ; ++i) {
+        opal_pointer_array_set_item (&ompi_mpi_communicators, cid + i, NULL);
+    }
+}
+
+/* claim the cids [cid, cid + count) for comm, either all of them or none */
+static bool ompi_comm_cid_claim_range (unsigned int cid, int count, ompi_communicator_t *comm)
+{
+    if (cid + count > mca_pml.pml_max_contextid) {
+        return false;
+    }
+
+    for (int i = 0 ; i < count ; ++i) {
+        if (opal_bitmap_is_set_bit (&ompi_comm_cid_reserved, cid + i) ||
+            !opal_pointer_array_test_and_set_item (&ompi_mpi_communicators, cid + i, comm)) {
+            ompi_comm_cid_release_range (cid, i);
+            return false;
+        }
+    }
+
+    return true;
+}
+
 static ompi_comm_cid_context_t *mca_comm_cid_context_alloc (ompi_communicator_t *newcomm, ompi_communicator_t *comm,
                                                             ompi_communicator_t *bridgecomm, const void *arg0,
                                                             const void *arg1, const char *pmix_tag, bool send_first,
@@ -239,6 +299,8 @@ static ompi_comm_allreduce_context_t *ompi_comm_allreduce_context_alloc (int *in
     return context;
 }
 
+/* take the next cid reserved by the parent or agree on a new block */
+static int ompi_comm_nextcid_from_block (ompi_comm_request_t *request);
 /* find the next available local cid and start an allreduce */
 static int ompi_comm_allreduce_getnextcid (ompi_comm_request_t *request);
 /* verify that the maximum cid is locally available and start an allreduce */
@@ -261,7 +323,14 @@ int ompi_comm_nextcid_nb (ompi_communicator_t *newcomm, ompi_communicator_t *com
         return OMPI_ERR_OUT_OF_RESOURCE;
     }
 
-    context->start = ompi_mpi_communicators.lowest_free;
+    context->start = context->first_start = ompi_mpi_communicators.lowest_free;
+
+    /* all the processes of an intra-communicator create its children in the
+     * same order, so they can hand them out a block of cids agreed on once */
+    context->block = 1;
+    if (OMPI_COMM_CID_INTRA == mode && 1 < ompi_mpi_comm_cid_block_size) {
+        context->block = ompi_mpi_comm_cid_block_size;
+    }
 
     request = ompi_comm_request_get ();
     if (NULL == request) {
@@ -271,7 +340,11 @@ int ompi_comm_nextcid_nb (ompi_communicator_t *newcomm, ompi_communicator_t *com
 
     request->context = &context->super;
 
-    ompi_comm_request_schedule_append (request, ompi_comm_allreduce_getnextcid, NULL, 0);
+    if (1 < context->block) {
+        ompi_comm_request_schedule_append (request, ompi_comm_nextcid_from_block, NULL, 0);
+    } else {
+        ompi_comm_request_schedule_append (request, ompi_comm_allreduce_getnextcid, NULL, 0);
+    }
     ompi_comm_request_start (request);
 
     *req = &request->super;
@@ -299,6 +372,75 @@ int ompi_comm_nextcid (ompi_communicator_t *newcomm, ompi_communicator_t *comm,
     return rc;
 }
 
+/* Non-blocking creations progress in the order they were started, so a
+ * creation waits for a block being agreed on by an earlier one. Otherwise
+ * the processes might not agree on which creation reserves the next block. */
+static int ompi_comm_nextcid_from_block (ompi_comm_request_t *request)
+{
+    ompi_comm_cid_context_t *context = (ompi_comm_cid_context_t *) request->context;
+    ompi_communicator_t *comm = context->comm;
+    int cid;
+
+    if (OPAL_THREAD_TRYLOCK(&ompi_cid_lock)) {
+        return ompi_comm_request_schedule_append (request, ompi_comm_nextcid_from_block, NULL, 0);
+    }
+
+    if (OMPI_COMM_CID_BLOCK_PENDING == comm->c_id_start_index) {
+        OPAL_THREAD_UNLOCK(&ompi_cid_lock);
+        return ompi_comm_request_schedule_append (request, ompi_comm_nextcid_from_block, NULL, 0);
+    }
+
+    if (0 <= comm->c_id_start_index &&
+        comm->c_id_available < comm->c_id_start_index + ompi_mpi_comm_cid_block_size) {
+        cid = comm->c_id_available++;
+        (void) opal_bitmap_clear_bit (&ompi_comm_cid_reserved, cid);
+        /* reserved cids are never handed out by claim_range */
+        if (OPAL_LIKELY(opal_pointer_array_test_and_set_item (&ompi_mpi_communicators, cid,
+                                                              context->newcomm))) {
+            context->newcomm->c_contextid = cid;
+            OPAL_THREAD_UNLOCK(&ompi_cid_lock);
+            return OMPI_SUCCESS;
+        }
+
+        /* the cid was taken despite the reservation: give the rest of the
+         * block back and agree on a cid the regular way */
+        for (int i = comm->c_id_available ; i < comm->c_id_start_index + ompi_mpi_comm_cid_block_size ; ++i) {
+            (void) opal_bitmap_clear_bit (&ompi_comm_cid_reserved, i);
+        }
+    }
+
+    /* the parent has no block or used it up, agree on a new one */
+    comm->c_id_start_index = OMPI_COMM_CID_BLOCK_PENDING;
+    OPAL_THREAD_UNLOCK(&ompi_cid_lock);
+
+    return ompi_comm_allreduce_getnextcid (request);
+}
+
+/* keep the agreed cids following the new communicator's for the next
+ * children of the parent. Called with the cid lock held. */
+static void ompi_comm_nextcid_block_done (ompi_comm_cid_context_t *context, bool success)
+{
+    ompi_communicator_t *comm = context->comm;
+
+    if (OMPI_COMM_CID_BLOCK_PENDING != comm->c_id_start_index) {
+        return;
+    }
+
+    comm->c_id_start_index = MPI_UNDEFINED;
+    comm->c_id_available = MPI_UNDEFINED;
+
+    if (!success || 1 == context->block) {
+        return;
+    }
+
+    for (int i = 1 ; i < context->block ; ++i) {
+        opal_pointer_array_set_item (&ompi_mpi_communicators, context->nextcid + i, NULL);
+        (void) opal_bitmap_set_bit (&ompi_comm_cid_reserved, context->nextcid + i);
+    }
+    comm->c_id_start_index = context->nextcid;
+    comm->c_id_available = context->nextcid + 1;
+}
+
 static int ompi_comm_allreduce_getnextcid (ompi_comm_request_t *request)
 {
     ompi_comm_cid_context_t *context = (ompi_comm_cid_context_t *) request->context;
@@ -306,7 +448,9 @@ static int ompi_comm_allreduce_getnextcid (ompi_comm_request_t *request)
     ompi_request_t *subreq;
     bool flag = false;
     int ret = OMPI_SUCCESS;
-    int participate = (context->newcomm->c_local_group->grp_my_rank != MPI_UNDEFINED);
+    /* a block belongs to the parent, so everybody has to reserve it */
+    int participate = (context->newcomm->c_local_group->grp_my_rank != MPI_UNDEFINED ||
+                       1 < context->block);
 
     if (OPAL_THREAD_TRYLOCK(&ompi_cid_lock)) {
         return ompi_comm_request_schedule_append (request, ompi_comm_allreduce_getnextcid, NULL, 0);
@@ -325,9 +469,8 @@ static int ompi_comm_allreduce_getnextcid (ompi_comm_request_t *request)
     if( participate ){
         flag = false;
         context->nextlocal_cid = mca_pml.pml_max_contextid;
-        for (unsigned int i = context->start ; i < mca_pml.pml_max_contextid ; ++i) {
-            flag = opal_pointer_array_test_and_set_item (&ompi_mpi_communicators, i,
-                                                         context->comm);
+        for (unsigned int i = context->start ; i + context->block <= mca_pml.pml_max_contextid ; ++i) {
+            flag = ompi_comm_cid_claim_range (i, context->block, context->comm);
             if (true == flag) {
                 context->nextlocal_cid = i;
                 break;
@@ -346,7 +489,8 @@ static int ompi_comm_allreduce_getnextcid (ompi_comm_request_t *request)
         goto err_exit;
     }
 
-    if ( ((unsigned int) context->nextlocal_cid == mca_pml.pml_max_contextid) ) {
+    if ( 1 == context->block &&
+         ((unsigned int) context->nextlocal_cid == mca_pml.pml_max_contextid) ) {
         /* Our local CID space is out, others already aware (allreduce above) */
         ret = OMPI_ERR_OUT_OF_RESOURCE;
         goto err_exit;
@@ -357,8 +501,9 @@ static int ompi_comm_allreduce_getnextcid (ompi_comm_request_t *request)
     return ompi_comm_request_schedule_append (request, ompi_comm_checkcid, &subreq, 1);
 err_exit:
     if (participate && flag) {
-        opal_pointer_array_test_and_set_item(&ompi_mpi_communicators, context->nextlocal_cid, NULL);
+        ompi_comm_cid_release_range (context->nextlocal_cid, context->block);
     }
+    ompi_comm_nextcid_block_done (context, false);
     ompi_comm_cid_lowest_id = INT64_MAX;
     OPAL_THREAD_UNLOCK(&ompi_cid_lock);
     return ret;
@@ -370,12 +515,20 @@ static int ompi_comm_checkcid (ompi_comm_request_t *request)
     ompi_comm_cid_context_t *context = (ompi_comm_cid_context_t *) request->context;
     ompi_request_t *subreq;
     int ret;
-    int participate = (context->newcomm->c_local_group->grp_my_rank != MPI_UNDEFINED);
+    int participate = (context->newcomm->c_local_group->grp_my_rank != MPI_UNDEFINED ||
+                       1 < context->block);
+    bool local_found = ((unsigned int) context->nextlocal_cid != mca_pml.pml_max_contextid);
 
     if (OMPI_SUCCESS != request->super.req_status.MPI_ERROR) {
-        if (participate) {
-            opal_pointer_array_set_item(&ompi_mpi_communicators, context->nextlocal_cid, NULL);
+        if (OPAL_THREAD_TRYLOCK(&ompi_cid_lock)) {
+            return ompi_comm_request_schedule_append (request, ompi_comm_checkcid, NULL, 0);
+        }
+        if (participate && local_found) {
+            ompi_comm_cid_release_range (context->nextlocal_cid, context->block);
         }
+        ompi_comm_nextcid_block_done (context, false);
+        ompi_comm_cid_lowest_id = INT64_MAX;
+        OPAL_THREAD_UNLOCK(&ompi_cid_lock);
         return request->super.req_status.MPI_ERROR;
     }
 
@@ -383,15 +536,29 @@ static int ompi_comm_checkcid (ompi_comm_request_t *request)
         return ompi_comm_request_schedule_append (request, ompi_comm_checkcid, NULL, 0);
     }
 
+    if (1 < context->block && (unsigned int) context->nextcid == mca_pml.pml_max_contextid) {
+        /* some process has no free block left: everybody knows it from the
+         * allreduce, so all fall back to agreeing on a single cid */
+        if (local_found) {
+            ompi_comm_cid_release_range (context->nextlocal_cid, context->block);
+        }
+        context->block = 1;
+        context->start = context->first_start;
+        ++context->iter;
+        OPAL_THREAD_UNLOCK(&ompi_cid_lock);
+        return ompi_comm_allreduce_getnextcid (request);
+    }
+
     if( !participate ){
         context->flag = 1;
     } else {
         context->flag = (context->nextcid == context->nextlocal_cid);
         if ( participate && !context->flag) {
-            opal_pointer_array_set_item(&ompi_mpi_communicators, context->nextlocal_cid, NULL);
+            if (local_found) {
+                ompi_comm_cid_release_range (context->nextlocal_cid, context->block);
+            }
 
-            context->flag = opal_pointer_array_test_and_set_item (&ompi_mpi_communicators,
-                                                                  context->nextcid, context->comm);
+            context->flag = ompi_comm_cid_claim_range (context->nextcid, context->block, context->comm);
         }
     }
 
@@ -402,8 +569,9 @@ static int ompi_comm_checkcid (ompi_comm_request_t *request)
         ompi_comm_request_schedule_append (request, ompi_comm_nextcid_check_flag, &subreq, 1);
     } else {
         if (participate && context->flag ) {
-            opal_pointer_array_test_and_set_item(&ompi_mpi_communicators, context->nextlocal_cid, NULL);
+            ompi_comm_cid_release_range (context->nextcid, context->block);
         }
+        ompi_comm_nextcid_block_done (context, false);
         ompi_comm_cid_lowest_id = INT64_MAX;
     }
 
@@ -414,12 +582,19 @@ static int ompi_comm_checkcid (ompi_comm_request_t *request)
 static int ompi_comm_nextcid_check_flag (ompi_comm_request_t *request)
 {
     ompi_comm_cid_context_t *context = (ompi_comm_cid_context_t *) request->context;
-    int participate = (context->newcomm->c_local_group->grp_my_rank != MPI_UNDEFINED);
+    int participate = (context->newcomm->c_local_group->grp_my_rank != MPI_UNDEFINED ||
+                       1 < context->block);
 
     if (OMPI_SUCCESS != request->super.req_status.MPI_ERROR) {
-        if (participate) {
-            opal_pointer_array_set_item(&ompi_mpi_communicators, context->nextcid, NULL);
+        if (OPAL_THREAD_TRYLOCK(&ompi_cid_lock)) {
+            return ompi_comm_request_schedule_append (request, ompi_comm_nextcid_check_flag, NULL, 0);
+        }
+        if (participate && context->flag) {
+            ompi_comm_cid_release_range (context->nextcid, context->block);
         }
+        ompi_comm_nextcid_block_done (context, false);
+        ompi_comm_cid_lowest_id = INT64_MAX;
+        OPAL_THREAD_UNLOCK(&ompi_cid_lock);
         return request->super.req_status.MPI_ERROR;
     }
 
@@ -435,10 +610,8 @@ static int ompi_comm_nextcid_check_flag (ompi_comm_request_t *request)
              */
             context->nextlocal_cid = mca_pml.pml_max_contextid;
             for (unsigned int i = context->start ; i < mca_pml.pml_max_contextid ; ++i) {
-                bool flag;
-                flag = opal_pointer_array_test_and_set_item (&ompi_mpi_communicators, i,
-                                                                context->comm);
-                if (true == flag) {
+                /* skip cids reserved for the children of other parents */
+                if (ompi_comm_cid_claim_range (i, 1, context->comm)) {
                     context->nextlocal_cid = i;
                     break;
                 }
@@ -449,6 +622,7 @@ static int ompi_comm_nextcid_check_flag (ompi_comm_request_t *request)
         /* set the according values to the newcomm */
         context->newcomm->c_contextid = context->nextcid;
         opal_pointer_array_set_item (&ompi_mpi_communicators, context->nextcid, context->newcomm);
+        ompi_comm_nextcid_block_done (context, true);
 
         /* unlock the cid generator */
         ompi_comm_cid_lowest_id = INT64_MAX;
@@ -460,7 +634,7 @@ static int ompi_comm_nextcid_check_flag (ompi_comm_request_t *request)
 
     if (participate && (0 != context->flag)) {
         /* we could use this cid, but other don't agree */
-        opal_pointer_array_set_item (&ompi_mpi_communicators, context->nextcid, NULL);
+        ompi_comm_cid_release_range (context->nextcid, context->block);
         context->start = context->nextcid + 1; /* that's where we can start the next round */
     }
 
@@ -113,7 +113,12 @@ int ompi_comm_init(void)
 
     for (size_t i = 0 ; i < size ; ++i) {
         opal_process_name_t name = {.vpid = i, .jobid = OMPI_PROC_MY_NAME->jobid};
-        /* look for existing ompi_proc_t that matches this name */
+        /* look for existing ompi_proc_t that matches this name. with lazy
+         * procs only the local process has one */
+        if (ompi_mpi_lazy_procs && i != OMPI_PROC_MY_NAME->vpid) {
+            group->grp_proc_pointers[i] = (ompi_proc_t *) ompi_proc_name_to_sentinel (name);
+            continue;
+        }
         group->grp_proc_pointers[i] = (ompi_proc_t *) ompi_proc_lookup (name);
         if (NULL == group->grp_proc_pointers[i]) {
             /* set sentinel value */
@@ -128,8 +133,8 @@ int ompi_comm_init(void)
     ompi_set_group_rank(group, ompi_proc_local());
 
     ompi_mpi_comm_world.comm.c_contextid    = 0;
-    ompi_mpi_comm_world.comm.c_id_start_index = 4;
-    ompi_mpi_comm_world.comm.c_id_available = 4;
+    ompi_mpi_comm_world.comm.c_id_start_index = MPI_UNDEFINED;
+    ompi_mpi_comm_world.comm.c_id_available = MPI_UNDEFINED;
     ompi_mpi_comm_world.comm.c_my_rank      = group->grp_my_rank;
     ompi_mpi_comm_world.comm.c_local_group  = group;
     ompi_mpi_comm_world.comm.c_remote_group = group;
@@ -182,8 +187,8 @@ int ompi_comm_init(void)
     OMPI_GROUP_SET_DENSE (group);
 
     ompi_mpi_comm_self.comm.c_contextid    = 1;
-    ompi_mpi_comm_self.comm.c_id_start_index = 20;
-    ompi_mpi_comm_self.comm.c_id_available = 20;
+    ompi_mpi_comm_self.comm.c_id_start_index = MPI_UNDEFINED;
+    ompi_mpi_comm_self.comm.c_id_available = MPI_UNDEFINED;
     ompi_mpi_comm_self.comm.c_my_rank      = group->grp_my_rank;
     ompi_mpi_comm_self.comm.c_local_group  = group;
     ompi_mpi_comm_self.comm.c_remote_group = group;
@@ -351,6 +356,8 @@ int ompi_comm_finalize(void)
     OBJ_DESTRUCT (&ompi_mpi_communicators);
     OBJ_DESTRUCT (&ompi_comm_f_to_c_table);
 
+    ompi_comm_cid_finalize ();
+
     /* finalize communicator requests */
     ompi_comm_request_fini ();
 
@@ -450,6 +457,9 @@ static void ompi_comm_destruct(ompi_communicator_t* comm)
         comm->error_handler = NULL;
     }
 
+    /* give back the cids reserved for children that were never created */
+    ompi_comm_cid_release_block (comm);
+
     /* mark this cid as available */
     if ( MPI_UNDEFINED != (int)comm->c_contextid &&
          NULL != opal_pointer_array_get_item(&ompi_mpi_communicators,
@@ -92,6 +92,9 @@ OMPI_DECLSPEC OBJ_CLASS_DECLARATION(ompi_communicator_t);
 #define OMPI_COMM_ALLGATHER_TAG -31078
 #define OMPI_COMM_BARRIER_TAG   -31079
 #define OMPI_COMM_ALLREDUCE_TAG -31080
+#define OMPI_COMM_SPLIT_INFO_TAG    -31081
+#define OMPI_COMM_SPLIT_MEMBERS_TAG -31082
+#define OMPI_COMM_PRECONNECT_TAG    -31083
 
 #define OMPI_COMM_ASSERT_NO_ANY_TAG     0x00000001
 #define OMPI_COMM_ASSERT_NO_ANY_SOURCE  0x00000002
@@ -145,7 +148,8 @@ struct ompi_communicator_t {
     int c_id_available; /* the currently available Cid for allocation
                to a child*/
     int c_id_start_index; /* the starting index of the block of cids
-                 allocated to this communicator*/
+                 reserved by this communicator for its children, or
+                 MPI_UNDEFINED */
 
     ompi_group_t        *c_local_group;
     ompi_group_t       *c_remote_group;
@@ -712,6 +716,17 @@ extern int ompi_comm_num_dyncomm;
 */
 OMPI_DECLSPEC int ompi_comm_cid_init ( void );
 
+/**
+ * Release the resources of the context ID allocator
+ */
+int ompi_comm_cid_finalize ( void );
+
+/**
+ * Give back the context IDs a communicator reserved for children it
+ * did not create. Called when the communicator is destroyed.
+ */
+void ompi_comm_cid_release_block (ompi_communicator_t *comm);
+
 
 void ompi_comm_assert_subscribe (ompi_communicator_t *comm, int32_t assert_flag);
 
@@ -43,6 +43,56 @@ int ompi_group_free ( ompi_group_t **group )
     return OMPI_SUCCESS;
 }
 
+/* groups from this size on get a rank index when ranks are translated into them */
+#define OMPI_GROUP_RANK_INDEX_MIN 64
+
+static inline uint64_t ompi_group_name_key (opal_process_name_t name)
+{
+    return ((uint64_t) name.jobid << 32) | (uint64_t) name.vpid;
+}
+
+/*
+ * Return the process name to rank index of a group, building it on first
+ * use. The index is immutable once published, so concurrent translations
+ * can read it without a lock; a thread losing the race to publish its
+ * index drops it.
+ */
+static opal_hash_table_t *ompi_group_get_rank_index (ompi_group_t *group)
+{
+    opal_hash_table_t *index = (opal_hash_table_t *) group->grp_rank_index;
+    intptr_t expected = 0;
+
+    if (NULL != index) {
+        return index;
+    }
+
+    index = OBJ_NEW(opal_hash_table_t);
+    if (NULL == index) {
+        return NULL;
+    }
+    if (OPAL_SUCCESS != opal_hash_table_init (index, group->grp_proc_count)) {
+        OBJ_RELEASE(index);
+        return NULL;
+    }
+
+    /* walk backwards so a process present twice maps to its lowest rank,
+     * like the linear search does */
+    for (int rank = group->grp_proc_count - 1 ; rank >= 0 ; --rank) {
+        uint64_t key = ompi_group_name_key (ompi_group_get_proc_name (group, rank));
+        if (OPAL_SUCCESS != opal_hash_table_set_value_uint64 (index, key, (void *) (intptr_t) rank)) {
+            OBJ_RELEASE(index);
+            return NULL;
+        }
+    }
+
+    if (!opal_atomic_compare_exchange_strong_ptr (&group->grp_rank_index, &expected, (intptr_t) index)) {
+        OBJ_RELEASE(index);
+        index = (opal_hash_table_t *) expected;
+    }
+
+    return index;
+}
+
 int ompi_group_translate_ranks ( ompi_group_t *group1,
                                  int n_ranks, const int *ranks1,
                                  ompi_group_t *group2,
@@ -100,6 +150,33 @@ int ompi_group_translate_ranks ( ompi_group_t *group1,
     }
 #endif
 
+    /* large groups: look the ranks up by process name */
+    if (group2->grp_proc_count >= OMPI_GROUP_RANK_INDEX_MIN) {
+        opal_hash_table_t *index = ompi_group_get_rank_index (group2);
+
+        if (NULL != index) {
+            for (int proc = 0; proc < n_ranks; ++proc) {
+                int rank = ranks1[proc];
+                void *rank2;
+
+                if ( MPI_PROC_NULL == rank) {
+                    ranks2[proc] = MPI_PROC_NULL;
+                    continue;
+                }
+
+                if (OPAL_SUCCESS == opal_hash_table_get_value_uint64 (index,
+                                                                      ompi_group_name_key (ompi_group_get_proc_name (group1, rank)),
+                                                                      &rank2)) {
+                    ranks2[proc] = (int) (intptr_t) rank2;
+                } else {
+                    ranks2[proc] = MPI_UNDEFINED;
+                }
+            }
+
+            return MPI_SUCCESS;
+        }
+    }
+
     /* loop over all ranks */
     for (int proc = 0; proc < n_ranks; ++proc) {
         struct ompi_proc_t *proc1_pointer, *proc2_pointer;
@@ -37,6 +37,7 @@
 #include "ompi/proc/proc.h"
 #include "mpi.h"
 #include "opal/class/opal_pointer_array.h"
+#include "opal/class/opal_hash_table.h"
 #include "opal/util/output.h"
 
 BEGIN_C_DECLS
@@ -97,6 +98,9 @@ struct ompi_group_t {
         struct ompi_group_strided_data_t  grp_strided;
         struct ompi_group_bitmap_data_t   grp_bitmap;
     } sparse_data;
+    /** process name to rank index, built by the first rank translation
+        into a large group */
+    opal_atomic_intptr_t grp_rank_index;
 };
 
 typedef struct ompi_group_t ompi_group_t;
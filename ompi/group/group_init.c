@@ -262,6 +262,8 @@ static void ompi_group_construct(ompi_group_t *new_group)
 
     /* default the sparse values for groups */
     new_group->grp_parent_group_ptr = NULL;
+
+    new_group->grp_rank_index = 0;
 }
 
 
@@ -281,6 +283,11 @@ static void ompi_group_destruct(ompi_group_t *group)
 #endif
 	ompi_group_decrement_proc_count (group);
 
+    if (0 != group->grp_rank_index) {
+        opal_hash_table_t *index = (opal_hash_table_t *) group->grp_rank_index;
+        OBJ_RELEASE(index);
+    }
+
     /* release thegrp_proc_pointers memory */
     if (NULL != group->grp_proc_pointers) {
         free(group->grp_proc_pointers);
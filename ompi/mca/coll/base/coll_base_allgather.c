@@ -362,7 +362,8 @@ int ompi_coll_base_allgather_intra_ring(const void *sbuf, int scount,
                                          struct ompi_communicator_t *comm,
                                          mca_coll_base_module_t *module)
 {
-    int line = -1, rank, size, err, sendto, recvfrom, i, recvdatafrom, senddatafrom;
+    int line = -1, rank, vrank, size, err, sendto, recvfrom, i, recvdatafrom, senddatafrom;
+    const int *order, *vranks;
     ptrdiff_t rlb, rext;
     char *tmpsend = NULL, *tmprecv = NULL;
 
@@ -394,12 +395,16 @@ int ompi_coll_base_allgather_intra_ring(const void *sbuf, int scount,
        [(r - i + size) % size]
        - sends message which starts at begining of rbuf and has size
     */
-    sendto = (rank + 1) % size;
-    recvfrom  = (rank - 1 + size) % size;
+    /* The ring follows the locality aware order of the ranks, if any */
+    ompi_coll_base_topo_get_locality_order(comm, module, &order, &vranks);
+    vrank = (NULL == order) ? rank : vranks[rank];
+
+    sendto = COLL_BASE_TOPO_RANK(order, (vrank + 1) % size);
+    recvfrom  = COLL_BASE_TOPO_RANK(order, (vrank - 1 + size) % size);
 
     for (i = 0; i < size - 1; i++) {
-        recvdatafrom = (rank - i - 1 + size) % size;
-        senddatafrom = (rank - i + size) % size;
+        recvdatafrom = COLL_BASE_TOPO_RANK(order, (vrank - i - 1 + size) % size);
+        senddatafrom = COLL_BASE_TOPO_RANK(order, (vrank - i + size) % size);
 
         tmprecv = (char*)rbuf + (ptrdiff_t)recvdatafrom * (ptrdiff_t)rcount * rext;
         tmpsend = (char*)rbuf + (ptrdiff_t)senddatafrom * (ptrdiff_t)rcount * rext;
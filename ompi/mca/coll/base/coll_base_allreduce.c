@@ -344,7 +344,8 @@ ompi_coll_base_allreduce_intra_ring(const void *sbuf, void *rbuf, int count,
                                      struct ompi_communicator_t *comm,
                                      mca_coll_base_module_t *module)
 {
-    int ret, line, rank, size, k, recv_from, send_to, block_count, inbi;
+    int ret, line, rank, vrank, size, k, recv_from, send_to, block_count, inbi;
+    const int *order, *vranks;
     int early_segcount, late_segcount, split_rank, max_segcount;
     size_t typelng;
     char *tmpsend = NULL, *tmprecv = NULL, *inbuf[2] = {NULL, NULL};
@@ -376,6 +377,11 @@ ompi_coll_base_allreduce_intra_ring(const void *sbuf, void *rbuf, int count,
                                                                   comm, module));
     }
 
+    /* The ring follows the locality aware order of the ranks, if any: the
+       blocks are assigned by virtual rank */
+    ompi_coll_base_topo_get_locality_order(comm, module, &order, &vranks);
+    vrank = (NULL == order) ? rank : vranks[rank];
+
     /* Allocate and initialize temporary buffers */
     ret = ompi_datatype_get_extent(dtype, &lb, &extent);
     if (MPI_SUCCESS != ret) { line = __LINE__; goto error_hndl; }
@@ -427,8 +433,8 @@ ompi_coll_base_allreduce_intra_ring(const void *sbuf, void *rbuf, int count,
        Note that we must be careful when computing the begining of buffers and
        for send operations and computation we must compute the exact block size.
     */
-    send_to = (rank + 1) % size;
-    recv_from = (rank + size - 1) % size;
+    send_to = COLL_BASE_TOPO_RANK(order, (vrank + 1) % size);
+    recv_from = COLL_BASE_TOPO_RANK(order, (vrank + size - 1) % size);
 
     inbi = 0;
     /* Initialize first receive from the neighbor on the left */
@@ -436,10 +442,10 @@ ompi_coll_base_allreduce_intra_ring(const void *sbuf, void *rbuf, int count,
                              MCA_COLL_BASE_TAG_ALLREDUCE, comm, &reqs[inbi]));
     if (MPI_SUCCESS != ret) { line = __LINE__; goto error_hndl; }
     /* Send first block (my block) to the neighbor on the right */
-    block_offset = ((rank < split_rank)?
-                    ((ptrdiff_t)rank * (ptrdiff_t)early_segcount) :
-                    ((ptrdiff_t)rank * (ptrdiff_t)late_segcount + split_rank));
-    block_count = ((rank < split_rank)? early_segcount : late_segcount);
+    block_offset = ((vrank < split_rank)?
+                    ((ptrdiff_t)vrank * (ptrdiff_t)early_segcount) :
+                    ((ptrdiff_t)vrank * (ptrdiff_t)late_segcount + split_rank));
+    block_count = ((vrank < split_rank)? early_segcount : late_segcount);
     tmpsend = ((char*)rbuf) + block_offset * extent;
     ret = MCA_PML_CALL(send(tmpsend, block_count, dtype, send_to,
                             MCA_COLL_BASE_TAG_ALLREDUCE,
@@ -447,7 +453,7 @@ ompi_coll_base_allreduce_intra_ring(const void *sbuf, void *rbuf, int count,
     if (MPI_SUCCESS != ret) { line = __LINE__; goto error_hndl; }
 
     for (k = 2; k < size; k++) {
-        const int prevblock = (rank + size - k + 1) % size;
+        const int prevblock = (vrank + size - k + 1) % size;
 
         inbi = inbi ^ 0x1;
 
@@ -483,7 +489,7 @@ ompi_coll_base_allreduce_intra_ring(const void *sbuf, void *rbuf, int count,
 
     /* Apply operation on the last block (from neighbor (rank + 1)
        rbuf[rank+1] = inbuf[inbi] (op) rbuf[rank + 1] */
-    recv_from = (rank + 1) % size;
+    recv_from = (vrank + 1) % size;
     block_offset = ((recv_from < split_rank)?
                     ((ptrdiff_t)recv_from * early_segcount) :
                     ((ptrdiff_t)recv_from * late_segcount + split_rank));
@@ -492,11 +498,11 @@ ompi_coll_base_allreduce_intra_ring(const void *sbuf, void *rbuf, int count,
     ompi_op_reduce(op, inbuf[inbi], tmprecv, block_count, dtype);
 
     /* Distribution loop - variation of ring allgather */
-    send_to = (rank + 1) % size;
-    recv_from = (rank + size - 1) % size;
+    send_to = COLL_BASE_TOPO_RANK(order, (vrank + 1) % size);
+    recv_from = COLL_BASE_TOPO_RANK(order, (vrank + size - 1) % size);
     for (k = 0; k < size - 1; k++) {
-        const int recv_data_from = (rank + size - k) % size;
-        const int send_data_from = (rank + 1 + size - k) % size;
+        const int recv_data_from = (vrank + size - k) % size;
+        const int send_data_from = (vrank + 1 + size - k) % size;
         const int send_block_offset =
             ((send_data_from < split_rank)?
              ((ptrdiff_t)send_data_from * early_segcount) :
@@ -622,7 +628,8 @@ ompi_coll_base_allreduce_intra_ring_segmented(const void *sbuf, void *rbuf, int
                                                mca_coll_base_module_t *module,
                                                uint32_t segsize)
 {
-    int ret, line, rank, size, k, recv_from, send_to;
+    int ret, line, rank, vrank, size, k, recv_from, send_to;
+    const int *order, *vranks;
     int early_blockcount, late_blockcount, split_rank;
     int segcount, max_segcount, num_phases, phase, block_count, inbi;
     size_t typelng;
@@ -659,6 +666,11 @@ ompi_coll_base_allreduce_intra_ring_segmented(const void *sbuf, void *rbuf, int
                                                          comm, module));
         }
 
+    /* The ring follows the locality aware order of the ranks, if any: the
+       blocks are assigned by virtual rank */
+    ompi_coll_base_topo_get_locality_order(comm, module, &order, &vranks);
+    vrank = (NULL == order) ? rank : vranks[rank];
+
     /* Determine the number of phases of the algorithm */
     num_phases = count / (size * segcount);
     if ((count % (size * segcount) >= size) &&
@@ -720,8 +732,8 @@ ompi_coll_base_allreduce_intra_ring_segmented(const void *sbuf, void *rbuf, int
            Note that we must be careful when computing the begining of buffers and
            for send operations and computation we must compute the exact block size.
         */
-        send_to = (rank + 1) % size;
-        recv_from = (rank + size - 1) % size;
+        send_to = COLL_BASE_TOPO_RANK(order, (vrank + 1) % size);
+        recv_from = COLL_BASE_TOPO_RANK(order, (vrank + size - 1) % size);
 
         inbi = 0;
         /* Initialize first receive from the neighbor on the left */
@@ -731,10 +743,10 @@ ompi_coll_base_allreduce_intra_ring_segmented(const void *sbuf, void *rbuf, int
         /* Send first block (my block) to the neighbor on the right:
            - compute my block and phase offset
            - send data */
-        block_offset = ((rank < split_rank)?
-                        ((ptrdiff_t)rank * (ptrdiff_t)early_blockcount) :
-                        ((ptrdiff_t)rank * (ptrdiff_t)late_blockcount + split_rank));
-        block_count = ((rank < split_rank)? early_blockcount : late_blockcount);
+        block_offset = ((vrank < split_rank)?
+                        ((ptrdiff_t)vrank * (ptrdiff_t)early_blockcount) :
+                        ((ptrdiff_t)vrank * (ptrdiff_t)late_blockcount + split_rank));
+        block_count = ((vrank < split_rank)? early_blockcount : late_blockcount);
         COLL_BASE_COMPUTE_BLOCKCOUNT(block_count, num_phases, split_phase,
                                       early_phase_segcount, late_phase_segcount)
         phase_count = ((phase < split_phase)?
@@ -749,7 +761,7 @@ ompi_coll_base_allreduce_intra_ring_segmented(const void *sbuf, void *rbuf, int
         if (MPI_SUCCESS != ret) { line = __LINE__; goto error_hndl; }
 
         for (k = 2; k < size; k++) {
-            const int prevblock = (rank + size - k + 1) % size;
+            const int prevblock = (vrank + size - k + 1) % size;
 
             inbi = inbi ^ 0x1;
 
@@ -794,7 +806,7 @@ ompi_coll_base_allreduce_intra_ring_segmented(const void *sbuf, void *rbuf, int
 
         /* Apply operation on the last block (from neighbor (rank + 1)
            rbuf[rank+1] = inbuf[inbi] (op) rbuf[rank + 1] */
-        recv_from = (rank + 1) % size;
+        recv_from = (vrank + 1) % size;
         block_offset = ((recv_from < split_rank)?
                         ((ptrdiff_t)recv_from * (ptrdiff_t)early_blockcount) :
                         ((ptrdiff_t)recv_from * (ptrdiff_t)late_blockcount + split_rank));
@@ -812,11 +824,11 @@ ompi_coll_base_allreduce_intra_ring_segmented(const void *sbuf, void *rbuf, int
     }
 
     /* Distribution loop - variation of ring allgather */
-    send_to = (rank + 1) % size;
-    recv_from = (rank + size - 1) % size;
+    send_to = COLL_BASE_TOPO_RANK(order, (vrank + 1) % size);
+    recv_from = COLL_BASE_TOPO_RANK(order, (vrank + size - 1) % size);
     for (k = 0; k < size - 1; k++) {
-        const int recv_data_from = (rank + size - k) % size;
-        const int send_data_from = (rank + 1 + size - k) % size;
+        const int recv_data_from = (vrank + size - k) % size;
+        const int send_data_from = (vrank + 1 + size - k) % size;
         const int send_block_offset =
             ((send_data_from < split_rank)?
              ((ptrdiff_t)send_data_from * (ptrdiff_t)early_blockcount) :
@@ -26,6 +26,8 @@
 
 #include "ompi_config.h"
 
+#include <string.h>
+
 #include "mpi.h"
 #include "ompi/constants.h"
 #include "ompi/datatype/ompi_datatype.h"
@@ -290,3 +292,608 @@ ompi_coll_base_alltoallv_intra_basic_linear(const void *sbuf, const int *scounts
 
     return err;
 }
+
+/*
+ * Sparse alltoallv: only the peers with data to exchange get a request,
+ * which keeps the cost proportional to the number of neighbors when most
+ * of the counts are zero. Peers are skipped on the size in bytes of the
+ * message, which both sides agree on whatever their counts and datatypes.
+ */
+int
+ompi_coll_base_alltoallv_intra_sparse(const void *sbuf, const int *scounts, const int *sdisps,
+                                      struct ompi_datatype_t *sdtype,
+                                      void *rbuf, const int *rcounts, const int *rdisps,
+                                      struct ompi_datatype_t *rdtype,
+                                      struct ompi_communicator_t *comm,
+                                      mca_coll_base_module_t *module)
+{
+    int i, size, rank, err = MPI_SUCCESS, nreqs = 0, npeers = 0;
+    size_t sdsize, rdsize;
+    ptrdiff_t sext, rext;
+    ompi_request_t **reqs = NULL;
+    mca_coll_base_comm_t *data = module->base_data;
+
+    if (MPI_IN_PLACE == sbuf) {
+        return mca_coll_base_alltoallv_intra_basic_inplace (rbuf, rcounts, rdisps,
+                                                             rdtype, comm, module);
+    }
+
+    size = ompi_comm_size(comm);
+    rank = ompi_comm_rank(comm);
+
+    OPAL_OUTPUT((ompi_coll_base_framework.framework_output,
+                 "coll:base:alltoallv_intra_sparse rank %d", rank));
+
+    ompi_datatype_type_extent(sdtype, &sext);
+    ompi_datatype_type_extent(rdtype, &rext);
+    ompi_datatype_type_size(sdtype, &sdsize);
+    ompi_datatype_type_size(rdtype, &rdsize);
+
+    if (0 != scounts[rank]) {
+        err = ompi_datatype_sndrcv((char *) sbuf + (ptrdiff_t)sdisps[rank] * sext, scounts[rank], sdtype,
+                                   (char *) rbuf + (ptrdiff_t)rdisps[rank] * rext, rcounts[rank], rdtype);
+        if (MPI_SUCCESS != err) {
+            return err;
+        }
+    }
+
+    for (i = 0; i < size; ++i) {
+        if (i == rank) {
+            continue;
+        }
+        if (0 != rcounts[i] && 0 != rdsize) ++npeers;
+        if (0 != scounts[i] && 0 != sdsize) ++npeers;
+    }
+    if (0 == npeers) {
+        return MPI_SUCCESS;
+    }
+
+    reqs = ompi_coll_base_comm_get_reqs(data, npeers);
+    if (NULL == reqs) { err = OMPI_ERR_OUT_OF_RESOURCE; goto err_hndl; }
+
+    /* Post all receives first */
+    for (i = 0; i < size; ++i) {
+        if (i == rank || 0 == rcounts[i] || 0 == rdsize) {
+            continue;
+        }
+        err = MCA_PML_CALL(irecv((char *) rbuf + (ptrdiff_t)rdisps[i] * rext, rcounts[i], rdtype,
+                                 i, MCA_COLL_BASE_TAG_ALLTOALLV, comm, &reqs[nreqs]));
+        if (MPI_SUCCESS != err) { goto err_hndl; }
+        ++nreqs;
+    }
+
+    for (i = 0; i < size; ++i) {
+        if (i == rank || 0 == scounts[i] || 0 == sdsize) {
+            continue;
+        }
+        err = MCA_PML_CALL(isend((char *) sbuf + (ptrdiff_t)sdisps[i] * sext, scounts[i], sdtype,
+                                 i, MCA_COLL_BASE_TAG_ALLTOALLV,
+                                 MCA_PML_BASE_SEND_STANDARD, comm, &reqs[nreqs]));
+        if (MPI_SUCCESS != err) { goto err_hndl; }
+        ++nreqs;
+    }
+
+    err = ompi_request_wait_all(nreqs, reqs, MPI_STATUSES_IGNORE);
+
+ err_hndl:
+    if (MPI_SUCCESS != err) {
+        /* find a real error code */
+        if (MPI_ERR_IN_STATUS == err) {
+            for( i = 0; i < nreqs; i++ ) {
+                if (MPI_REQUEST_NULL == reqs[i]) continue;
+                if (MPI_ERR_PENDING == reqs[i]->req_status.MPI_ERROR) continue;
+                err = reqs[i]->req_status.MPI_ERROR;
+                break;
+            }
+        }
+        ompi_coll_base_free_reqs(reqs, nreqs);
+    }
+
+    return err;
+}
+
+/*
+ * Node aggregated sparse alltoallv.
+ *
+ * The messages of at most max_aggregated bytes between two nodes are
+ * routed through the node leaders (the lowest rank of each node): every
+ * rank hands its leader one message with all of them, the leaders
+ * exchange one message per pair of nodes with traffic, and each leader
+ * hands every rank of its node one message with all it receives. The
+ * other messages go straight to their peer, as in the sparse algorithm.
+ *
+ * The messages routed through a leader carry a header per original
+ * message followed by its packed data. The message to a leader also
+ * starts with the list of the leaders its sender expects data from, the
+ * leaders have no other way to know which of them will send. A leader
+ * probes for the size of the messages it receives, the other ranks know
+ * what they receive from their counts.
+ *
+ * Every pair of processes sends its direct message before the routed
+ * one, and receives them in that order.
+ */
+typedef struct {
+    int32_t src;
+    int32_t dst;
+    int32_t nbytes;
+} coll_base_a2av_hdr_t;
+
+/* a record in a buffer, and the leader of the node it goes to */
+typedef struct {
+    const char *rec;
+    int leader;
+} coll_base_a2av_rec_t;
+
+static int coll_base_a2av_rec_cmp(const void *a, const void *b)
+{
+    const coll_base_a2av_rec_t *ra = (const coll_base_a2av_rec_t *) a;
+    const coll_base_a2av_rec_t *rb = (const coll_base_a2av_rec_t *) b;
+
+    if (ra->leader != rb->leader) {
+        return (ra->leader < rb->leader) ? -1 : 1;
+    }
+    /* keep the order of the records of a buffer */
+    return (ra->rec < rb->rec) ? -1 : ((ra->rec > rb->rec) ? 1 : 0);
+}
+
+static int coll_base_a2av_int_cmp(const void *a, const void *b)
+{
+    int ia = *(const int *) a, ib = *(const int *) b;
+    return (ia < ib) ? -1 : ((ia > ib) ? 1 : 0);
+}
+
+static inline size_t coll_base_a2av_rec_len(const char *rec)
+{
+    coll_base_a2av_hdr_t hdr;
+    memcpy(&hdr, rec, sizeof(hdr));
+    return sizeof(hdr) + (size_t) hdr.nbytes;
+}
+
+/* unpack the data of a record into the receive buffer */
+static inline int coll_base_a2av_unpack(const char *rec, void *rbuf, const int *rcounts,
+                                        const int *rdisps, ptrdiff_t rext,
+                                        struct ompi_datatype_t *rdtype)
+{
+    coll_base_a2av_hdr_t hdr;
+
+    memcpy(&hdr, rec, sizeof(hdr));
+    return ompi_datatype_sndrcv(rec + sizeof(hdr), hdr.nbytes, MPI_PACKED,
+                                (char *) rbuf + (ptrdiff_t)rdisps[hdr.src] * rext,
+                                rcounts[hdr.src], rdtype);
+}
+
+/* append the records of a buffer to recs, with the leader of their destination */
+static int coll_base_a2av_add_recs(const char *buf, size_t len, const int *leaders,
+                                   coll_base_a2av_rec_t **recs, int *nrecs, int *maxrecs)
+{
+    coll_base_a2av_hdr_t hdr;
+    size_t pos = 0;
+
+    while (pos + sizeof(hdr) <= len) {
+        memcpy(&hdr, buf + pos, sizeof(hdr));
+        if (*nrecs == *maxrecs) {
+            coll_base_a2av_rec_t *tmp;
+            *maxrecs = (0 == *maxrecs) ? 64 : 2 * *maxrecs;
+            tmp = (coll_base_a2av_rec_t *) realloc(*recs, *maxrecs * sizeof(coll_base_a2av_rec_t));
+            if (NULL == tmp) {
+                return OMPI_ERR_OUT_OF_RESOURCE;
+            }
+            *recs = tmp;
+        }
+        (*recs)[*nrecs].rec = buf + pos;
+        (*recs)[*nrecs].leader = leaders[hdr.dst];
+        ++*nrecs;
+        pos += sizeof(hdr) + (size_t) hdr.nbytes;
+    }
+
+    return OMPI_SUCCESS;
+}
+
+/* Pack the sorted records in one buffer and send the run of each leader
+ * (or of each destination when by_dst) in one message. */
+static int coll_base_a2av_send_recs(coll_base_a2av_rec_t *recs, int nrecs, bool by_dst,
+                                    char **buf, ompi_request_t ***reqs, int *nreqs,
+                                    struct ompi_communicator_t *comm)
+{
+    coll_base_a2av_hdr_t hdr;
+    size_t total = 0, pos = 0, first;
+    int i, j, peer, err, npeers = 0;
+
+    for (i = 0; i < nrecs; ++i) {
+        total += coll_base_a2av_rec_len(recs[i].rec);
+        if (0 == i || recs[i].leader != recs[i - 1].leader) {
+            ++npeers;
+        }
+    }
+    if (0 == nrecs) {
+        return OMPI_SUCCESS;
+    }
+
+    *buf = (char *) malloc(total);
+    *reqs = (ompi_request_t **) malloc(npeers * sizeof(ompi_request_t *));
+    if (NULL == *buf || NULL == *reqs) {
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+
+    for (i = 0; i < nrecs; i = j) {
+        first = pos;
+        for (j = i; j < nrecs && recs[j].leader == recs[i].leader; ++j) {
+            size_t len = coll_base_a2av_rec_len(recs[j].rec);
+            memcpy(*buf + pos, recs[j].rec, len);
+            pos += len;
+        }
+        if (by_dst) {
+            memcpy(&hdr, recs[i].rec, sizeof(hdr));
+            peer = hdr.dst;
+        } else {
+            peer = recs[i].leader;
+        }
+        if (pos - first > INT_MAX) {
+            return OMPI_ERR_NOT_SUPPORTED;
+        }
+        err = MCA_PML_CALL(isend(*buf + first, (int)(pos - first), MPI_BYTE, peer,
+                                 MCA_COLL_BASE_TAG_ALLTOALLV, MCA_PML_BASE_SEND_STANDARD,
+                                 comm, *reqs + *nreqs));
+        if (MPI_SUCCESS != err) {
+            return err;
+        }
+        ++*nreqs;
+    }
+
+    return OMPI_SUCCESS;
+}
+
+/* receive a message of unknown size from peer */
+static int coll_base_a2av_probe_recv(int peer, char **buf, size_t *len,
+                                     struct ompi_communicator_t *comm)
+{
+    ompi_status_public_t status;
+    int err;
+
+    err = MCA_PML_CALL(probe(peer, MCA_COLL_BASE_TAG_ALLTOALLV, comm, &status));
+    if (MPI_SUCCESS != err) {
+        return err;
+    }
+    *len = status._ucount;
+    *buf = (char *) malloc(*len + 1);
+    if (NULL == *buf) {
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+    err = MCA_PML_CALL(recv(*buf, (int) *len, MPI_BYTE, peer, MCA_COLL_BASE_TAG_ALLTOALLV,
+                            comm, MPI_STATUS_IGNORE));
+    if (MPI_SUCCESS != err) {
+        free(*buf);
+        *buf = NULL;
+    }
+    return err;
+}
+
+int
+ompi_coll_base_alltoallv_intra_sparse_node(const void *sbuf, const int *scounts, const int *sdisps,
+                                           struct ompi_datatype_t *sdtype,
+                                           void *rbuf, const int *rcounts, const int *rdisps,
+                                           struct ompi_datatype_t *rdtype,
+                                           struct ompi_communicator_t *comm,
+                                           mca_coll_base_module_t *module,
+                                           int max_aggregated)
+{
+    int i, size, rank, me, err, line = -1, nreqs = 0, npeers = 0, nsrcl = 0, nlsrc = 0;
+    int nrecs = 0, maxrecs = 0, nfwd_reqs = 0, ndst_reqs = 0, nin = 0, nmembers = 0;
+    size_t sdsize, rdsize, nbytes, up_len = 0, down_len = 0, *in_len = NULL;
+    ptrdiff_t sext, rext;
+    const int *leaders;
+    int *srcl = NULL;
+    char *up = NULL, *down = NULL, *fwd_buf = NULL, *dst_buf = NULL, **in = NULL;
+    coll_base_a2av_hdr_t hdr;
+    coll_base_a2av_rec_t *recs = NULL;
+    ompi_request_t **reqs = NULL, **fwd_reqs = NULL, **dst_reqs = NULL, *up_req = MPI_REQUEST_NULL;
+    ompi_request_t *down_req = MPI_REQUEST_NULL;
+    mca_coll_base_comm_t *data = module->base_data;
+    bool leader;
+
+    if (MPI_IN_PLACE == sbuf) {
+        return mca_coll_base_alltoallv_intra_basic_inplace (rbuf, rcounts, rdisps,
+                                                             rdtype, comm, module);
+    }
+
+    err = ompi_coll_base_topo_get_node_leaders(comm, module, &leaders);
+    if (MPI_SUCCESS != err) {
+        /* every rank gets the same answer, so all fall back together */
+        return ompi_coll_base_alltoallv_intra_sparse(sbuf, scounts, sdisps, sdtype,
+                                                     rbuf, rcounts, rdisps, rdtype,
+                                                     comm, module);
+    }
+
+    size = ompi_comm_size(comm);
+    rank = ompi_comm_rank(comm);
+    me = leaders[rank];
+    leader = (me == rank);
+
+    OPAL_OUTPUT((ompi_coll_base_framework.framework_output,
+                 "coll:base:alltoallv_intra_sparse_node rank %d leader %d", rank, me));
+
+    ompi_datatype_type_extent(sdtype, &sext);
+    ompi_datatype_type_extent(rdtype, &rext);
+    ompi_datatype_type_size(sdtype, &sdsize);
+    ompi_datatype_type_size(rdtype, &rdsize);
+
+    if (max_aggregated < 0) {
+        max_aggregated = 0;
+    }
+#define A2AV_ROUTED(PEER, NBYTES) \
+    (0 != (NBYTES) && (NBYTES) <= (size_t) max_aggregated && leaders[(PEER)] != me)
+
+    if (0 != scounts[rank]) {
+        err = ompi_datatype_sndrcv((char *) sbuf + (ptrdiff_t)sdisps[rank] * sext, scounts[rank], sdtype,
+                                   (char *) rbuf + (ptrdiff_t)rdisps[rank] * rext, rcounts[rank], rdtype);
+        if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+    }
+
+    /* sort out the peers: the direct ones get a request, the routed
+     * ones add up in the messages to and from the leader */
+    up_len = sizeof(int32_t);
+    for (i = 0; i < size; ++i) {
+        if (i == rank) {
+            continue;
+        }
+        nbytes = (size_t) rcounts[i] * rdsize;
+        if (A2AV_ROUTED(i, nbytes)) {
+            down_len += sizeof(hdr) + nbytes;
+            ++nlsrc;
+        } else if (0 != nbytes) {
+            ++npeers;
+        }
+        nbytes = (size_t) scounts[i] * sdsize;
+        if (A2AV_ROUTED(i, nbytes)) {
+            up_len += sizeof(hdr) + nbytes;
+        } else if (0 != nbytes) {
+            ++npeers;
+        }
+    }
+
+    /* the leaders the routed data comes from */
+    srcl = (int *) malloc((nlsrc + 1) * sizeof(int));
+    if (NULL == srcl) { err = OMPI_ERR_OUT_OF_RESOURCE; line = __LINE__; goto err_hndl; }
+    for (i = 0; i < size; ++i) {
+        if (i != rank && A2AV_ROUTED(i, (size_t) rcounts[i] * rdsize)) {
+            srcl[nsrcl++] = leaders[i];
+        }
+    }
+    qsort(srcl, nsrcl, sizeof(int), coll_base_a2av_int_cmp);
+    for (i = 0, nlsrc = 0; i < nsrcl; ++i) {
+        if (0 == i || srcl[i] != srcl[nlsrc - 1]) {
+            srcl[nlsrc++] = srcl[i];
+        }
+    }
+    nsrcl = nlsrc;
+    up_len += nsrcl * sizeof(int32_t);
+
+    /* direct messages */
+    if (0 < npeers) {
+        reqs = ompi_coll_base_comm_get_reqs(data, npeers);
+        if (NULL == reqs) { err = OMPI_ERR_OUT_OF_RESOURCE; line = __LINE__; goto err_hndl; }
+    }
+    for (i = 0; i < size; ++i) {
+        nbytes = (size_t) rcounts[i] * rdsize;
+        if (i == rank || 0 == nbytes || A2AV_ROUTED(i, nbytes)) {
+            continue;
+        }
+        err = MCA_PML_CALL(irecv((char *) rbuf + (ptrdiff_t)rdisps[i] * rext, rcounts[i], rdtype,
+                                 i, MCA_COLL_BASE_TAG_ALLTOALLV, comm, &reqs[nreqs]));
+        if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+        ++nreqs;
+    }
+    for (i = 0; i < size; ++i) {
+        nbytes = (size_t) scounts[i] * sdsize;
+        if (i == rank || 0 == nbytes || A2AV_ROUTED(i, nbytes)) {
+            continue;
+        }
+        err = MCA_PML_CALL(isend((char *) sbuf + (ptrdiff_t)sdisps[i] * sext, scounts[i], sdtype,
+                                 i, MCA_COLL_BASE_TAG_ALLTOALLV,
+                                 MCA_PML_BASE_SEND_STANDARD, comm, &reqs[nreqs]));
+        if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+        ++nreqs;
+    }
+
+    /* pack the routed data for the leader: the source leaders, then
+     * the records */
+    if (up_len > INT_MAX || down_len > INT_MAX) {
+        err = OMPI_ERR_NOT_SUPPORTED; line = __LINE__; goto err_hndl;
+    }
+    up = (char *) malloc(up_len);
+    if (NULL == up) { err = OMPI_ERR_OUT_OF_RESOURCE; line = __LINE__; goto err_hndl; }
+    {
+        int32_t n32 = nsrcl;
+        size_t pos = sizeof(int32_t);
+
+        memcpy(up, &n32, sizeof(n32));
+        for (i = 0; i < nsrcl; ++i, pos += sizeof(int32_t)) {
+            n32 = srcl[i];
+            memcpy(up + pos, &n32, sizeof(n32));
+        }
+        for (i = 0; i < size; ++i) {
+            nbytes = (size_t) scounts[i] * sdsize;
+            if (i == rank || !A2AV_ROUTED(i, nbytes)) {
+                continue;
+            }
+            hdr.src = rank;
+            hdr.dst = i;
+            hdr.nbytes = (int32_t) nbytes;
+            memcpy(up + pos, &hdr, sizeof(hdr));
+            pos += sizeof(hdr);
+            err = ompi_datatype_sndrcv((char *) sbuf + (ptrdiff_t)sdisps[i] * sext, scounts[i], sdtype,
+                                       up + pos, (int) nbytes, MPI_PACKED);
+            if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+            pos += nbytes;
+        }
+    }
+
+    if (!leader) {
+        err = MCA_PML_CALL(isend(up, (int) up_len, MPI_BYTE, me, MCA_COLL_BASE_TAG_ALLTOALLV,
+                                 MCA_PML_BASE_SEND_STANDARD, comm, &up_req));
+        if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+
+        if (0 < down_len) {
+            down = (char *) malloc(down_len);
+            if (NULL == down) { err = OMPI_ERR_OUT_OF_RESOURCE; line = __LINE__; goto err_hndl; }
+            err = MCA_PML_CALL(irecv(down, (int) down_len, MPI_BYTE, me, MCA_COLL_BASE_TAG_ALLTOALLV,
+                                     comm, &down_req));
+            if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+        }
+    } else {
+        /* the leader collects the messages of its node, its own included */
+        for (i = 0; i < size; ++i) {
+            if (leaders[i] == rank) ++nmembers;
+        }
+        in = (char **) calloc(nmembers, sizeof(char *));
+        in_len = (size_t *) calloc(nmembers, sizeof(size_t));
+        if (NULL == in || NULL == in_len) { err = OMPI_ERR_OUT_OF_RESOURCE; line = __LINE__; goto err_hndl; }
+
+        nsrcl = 0;
+        for (i = 0; i < size; ++i) {
+            size_t pos;
+            int32_t n32, l32;
+
+            if (leaders[i] != rank) {
+                continue;
+            }
+            if (i == rank) {
+                in[nin] = up;
+                in_len[nin] = up_len;
+                up = NULL;
+            } else {
+                err = coll_base_a2av_probe_recv(i, &in[nin], &in_len[nin], comm);
+                if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+            }
+
+            /* merge the source leaders in srcl, sorted out below */
+            memcpy(&n32, in[nin], sizeof(n32));
+            pos = sizeof(int32_t);
+            if (0 < n32) {
+                int *tmp = (int *) realloc(srcl, (nsrcl + n32 + 1) * sizeof(int));
+                if (NULL == tmp) { err = OMPI_ERR_OUT_OF_RESOURCE; line = __LINE__; goto err_hndl; }
+                srcl = tmp;
+            }
+            for (int k = 0; k < n32; ++k, pos += sizeof(int32_t)) {
+                memcpy(&l32, in[nin] + pos, sizeof(l32));
+                srcl[nsrcl++] = l32;
+            }
+
+            err = coll_base_a2av_add_recs(in[nin] + pos, in_len[nin] - pos, leaders,
+                                          &recs, &nrecs, &maxrecs);
+            if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+            ++nin;
+        }
+
+        /* forward the records to the leaders of their nodes */
+        qsort(recs, nrecs, sizeof(coll_base_a2av_rec_t), coll_base_a2av_rec_cmp);
+        err = coll_base_a2av_send_recs(recs, nrecs, false, &fwd_buf, &fwd_reqs, &nfwd_reqs, comm);
+        if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+
+        /* receive from the other leaders and sort their records by destination */
+        qsort(srcl, nsrcl, sizeof(int), coll_base_a2av_int_cmp);
+        for (i = 0, nlsrc = 0; i < nsrcl; ++i) {
+            if (0 == i || srcl[i] != srcl[nlsrc - 1]) {
+                srcl[nlsrc++] = srcl[i];
+            }
+        }
+        nsrcl = nlsrc;
+        if (0 < nsrcl) {
+            char **tmp = (char **) realloc(in, (nin + nsrcl) * sizeof(char *));
+            size_t *tmp_len;
+            if (NULL == tmp) { err = OMPI_ERR_OUT_OF_RESOURCE; line = __LINE__; goto err_hndl; }
+            in = tmp;
+            tmp_len = (size_t *) realloc(in_len, (nin + nsrcl) * sizeof(size_t));
+            if (NULL == tmp_len) { err = OMPI_ERR_OUT_OF_RESOURCE; line = __LINE__; goto err_hndl; }
+            in_len = tmp_len;
+        }
+        nrecs = 0;
+        for (i = 0; i < nsrcl; ++i) {
+            err = coll_base_a2av_probe_recv(srcl[i], &in[nin], &in_len[nin], comm);
+            if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+            err = coll_base_a2av_add_recs(in[nin], in_len[nin], leaders, &recs, &nrecs, &maxrecs);
+            if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+            ++nin;
+        }
+        /* group by destination rank: all of them are on this node */
+        for (i = 0; i < nrecs; ++i) {
+            memcpy(&hdr, recs[i].rec, sizeof(hdr));
+            recs[i].leader = hdr.dst;
+        }
+        qsort(recs, nrecs, sizeof(coll_base_a2av_rec_t), coll_base_a2av_rec_cmp);
+
+        /* the leader is the lowest rank of its node, so its own records
+         * come first; the others are handed out to their destination */
+        for (i = 0; i < nrecs && recs[i].leader == rank; ++i) {
+            err = coll_base_a2av_unpack(recs[i].rec, rbuf, rcounts, rdisps, rext, rdtype);
+            if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+        }
+        err = coll_base_a2av_send_recs(recs + i, nrecs - i, true, &dst_buf, &dst_reqs,
+                                       &ndst_reqs, comm);
+        if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+    }
+
+    /* wait for the direct messages and the routed ones */
+    if (0 < nreqs) {
+        err = ompi_request_wait_all(nreqs, reqs, MPI_STATUSES_IGNORE);
+        if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+    }
+    if (!leader) {
+        err = ompi_request_wait(&up_req, MPI_STATUS_IGNORE);
+        if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+        if (MPI_REQUEST_NULL != down_req) {
+            size_t pos = 0;
+
+            err = ompi_request_wait(&down_req, MPI_STATUS_IGNORE);
+            if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+            while (pos < down_len) {
+                err = coll_base_a2av_unpack(down + pos, rbuf, rcounts, rdisps, rext, rdtype);
+                if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+                pos += coll_base_a2av_rec_len(down + pos);
+            }
+        }
+    } else {
+        if (0 < nfwd_reqs) {
+            err = ompi_request_wait_all(nfwd_reqs, fwd_reqs, MPI_STATUSES_IGNORE);
+            if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+        }
+        if (0 < ndst_reqs) {
+            err = ompi_request_wait_all(ndst_reqs, dst_reqs, MPI_STATUSES_IGNORE);
+            if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+        }
+    }
+
+#undef A2AV_ROUTED
+
+ err_hndl:
+    if (MPI_SUCCESS != err) {
+        OPAL_OUTPUT((ompi_coll_base_framework.framework_output,
+                     "%s:%4d\tError occurred %d, rank %2d", __FILE__, line, err, rank));
+        (void)line;  // silence compiler warning
+        /* do not leave started operations behind */
+        (void) ompi_request_wait_all(nreqs, reqs, MPI_STATUSES_IGNORE);
+        (void) ompi_request_wait_all(nfwd_reqs, fwd_reqs, MPI_STATUSES_IGNORE);
+        (void) ompi_request_wait_all(ndst_reqs, dst_reqs, MPI_STATUSES_IGNORE);
+        (void) ompi_request_wait(&up_req, MPI_STATUS_IGNORE);
+        (void) ompi_request_wait(&down_req, MPI_STATUS_IGNORE);
+        ompi_coll_base_free_reqs(reqs, nreqs);
+        ompi_coll_base_free_reqs(fwd_reqs, nfwd_reqs);
+        ompi_coll_base_free_reqs(dst_reqs, ndst_reqs);
+    }
+
+    for (i = 0; i < nin; ++i) {
+        free(in[i]);
+    }
+    free(in);
+    free(in_len);
+    free(recs);
+    free(srcl);
+    free(up);
+    free(down);
+    free(fwd_buf);
+    free(fwd_reqs);
+    free(dst_buf);
+    free(dst_reqs);
+
+    return err;
+}
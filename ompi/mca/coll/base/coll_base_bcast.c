@@ -362,7 +362,7 @@ ompi_coll_base_bcast_intra_split_bintree ( void* buffer,
                                             mca_coll_base_module_t *module,
                                             uint32_t segsize )
 {
-    int err=0, line, rank, size, segindex, i, lr, pair;
+    int err=0, line, rank, vrank, vroot, size, segindex, i, lr, pair;
     uint32_t counts[2];
     int segcount[2];       /* Number of elements sent with each segment */
     int num_segments[2];   /* Number of segmenets */
@@ -372,6 +372,7 @@ ompi_coll_base_bcast_intra_split_bintree ( void* buffer,
     ptrdiff_t type_extent, lb;
     ompi_request_t *base_req, *new_req;
     ompi_coll_tree_t *tree;
+    const int *order, *vranks;
 
     size = ompi_comm_size(comm);
     rank = ompi_comm_rank(comm);
@@ -386,6 +387,12 @@ ompi_coll_base_bcast_intra_split_bintree ( void* buffer,
     COLL_BASE_UPDATE_BINTREE( comm, module, root );
     tree = module->base_data->cached_bintree;
 
+    /* the tree is built on the locality aware order of the ranks, if any,
+       and so are the left/right halves and the pairs below */
+    ompi_coll_base_topo_get_locality_order( comm, module, &order, &vranks );
+    vrank = (NULL == order) ? rank : vranks[rank];
+    vroot = (NULL == order) ? root : vranks[root];
+
     err = ompi_datatype_type_size( datatype, &type_size );
 
     /* Determine number of segments and number of elements per segment */
@@ -437,7 +444,7 @@ ompi_coll_base_bcast_intra_split_bintree ( void* buffer,
     */
 
     /* determine if I am left (0) or right (1), (root is right) */
-    lr = ((rank + size - root)%size + 1)%2;
+    lr = ((vrank + size - vroot)%size + 1)%2;
 
     /* root code */
     if( rank == root ) {
@@ -551,9 +558,9 @@ ompi_coll_base_bcast_intra_split_bintree ( void* buffer,
        If we have even number of nodes the rank (size-1) will pair up with root.
     */
     if (lr == 0) {
-        pair = (rank+1)%size;
+        pair = COLL_BASE_TOPO_RANK(order, (vrank+1)%size);
     } else {
-        pair = (rank+size-1)%size;
+        pair = COLL_BASE_TOPO_RANK(order, (vrank+size-1)%size);
     }
 
     if ( (size%2) != 0 && rank != root) {
@@ -568,13 +575,14 @@ ompi_coll_base_bcast_intra_split_bintree ( void* buffer,
         /* root sends right buffer to the last node */
         if( rank == root ) {
             err = MCA_PML_CALL(send(tmpbuf[1], counts[1], datatype,
-                                    (root+size-1)%size, MCA_COLL_BASE_TAG_BCAST,
+                                    COLL_BASE_TOPO_RANK(order, (vroot+size-1)%size),
+                                    MCA_COLL_BASE_TAG_BCAST,
                                     MCA_PML_BASE_SEND_STANDARD, comm));
             if (err != MPI_SUCCESS) { line = __LINE__; goto error_hndl; }
 
         }
         /* last node receives right buffer from the root */
-        else if (rank == (root+size-1)%size) {
+        else if (vrank == (vroot+size-1)%size) {
             err = MCA_PML_CALL(recv(tmpbuf[1], counts[1], datatype,
                                     root, MCA_COLL_BASE_TAG_BCAST,
                                     comm, MPI_STATUS_IGNORE));
@@ -108,6 +108,9 @@ coll_base_comm_destruct(mca_coll_base_comm_t *data)
     if (data->cached_in_order_bintree) { /* destroy in order bintree if defined */
         ompi_coll_base_topo_destroy_tree (&data->cached_in_order_bintree);
     }
+    free(data->cached_locality_order);
+    free(data->cached_locality_vranks);
+    free(data->cached_node_leaders);
 }
 
 OBJ_CLASS_INSTANCE(mca_coll_base_comm_t, opal_object_t,
@@ -130,5 +133,22 @@ ompi_request_t** ompi_coll_base_comm_get_reqs(mca_coll_base_comm_t* data, int nr
     return data->mcct_reqs;
 }
 
-MCA_BASE_FRAMEWORK_DECLARE(ompi, coll, "Collectives", NULL, NULL, NULL,
+bool ompi_coll_base_topo_locality = false;
+
+static int coll_base_register(mca_base_register_flag_t flags)
+{
+    ompi_coll_base_topo_locality = false;
+    (void) mca_base_var_register("ompi", "coll", "base", "topo_locality",
+                                 "Build the trees and rings of the base collective algorithms on a "
+                                 "locality aware order of the ranks, so that most edges stay inside a "
+                                 "socket or a node (default: false)",
+                                 MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0,
+                                 OPAL_INFO_LVL_6,
+                                 MCA_BASE_VAR_SCOPE_READONLY,
+                                 &ompi_coll_base_topo_locality);
+
+    return OMPI_SUCCESS;
+}
+
+MCA_BASE_FRAMEWORK_DECLARE(ompi, coll, "Collectives", coll_base_register, NULL, NULL,
                            mca_coll_base_static_components, 0);
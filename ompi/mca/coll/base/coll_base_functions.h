@@ -223,6 +223,8 @@ int mca_coll_base_alltoall_intra_basic_inplace(const void *rbuf, int rcount,
 /* AlltoAllV */
 int ompi_coll_base_alltoallv_intra_pairwise(ALLTOALLV_ARGS);
 int ompi_coll_base_alltoallv_intra_basic_linear(ALLTOALLV_ARGS);
+int ompi_coll_base_alltoallv_intra_sparse(ALLTOALLV_ARGS);
+int ompi_coll_base_alltoallv_intra_sparse_node(ALLTOALLV_ARGS, int max_aggregated);
 int mca_coll_base_alltoallv_intra_basic_inplace(const void *rbuf, const int *rcounts, const int *rdisps,
                                                 struct ompi_datatype_t *rdtype,
                                                 struct ompi_communicator_t *comm,
@@ -311,7 +313,9 @@ do {
         if( coll_comm->cached_bintree ) { /* destroy previous binomial if defined */       \
             ompi_coll_base_topo_destroy_tree( &(coll_comm->cached_bintree) );             \
         }                                                                                  \
-        coll_comm->cached_bintree = ompi_coll_base_topo_build_tree(2,(OMPI_COMM),(ROOT)); \
+        const int *order_, *vranks_;                                                      \
+        ompi_coll_base_topo_get_locality_order((OMPI_COMM), (BASE_MODULE), &order_, &vranks_); \
+        coll_comm->cached_bintree = ompi_coll_base_topo_build_tree_ordered(2,(OMPI_COMM),(ROOT),order_,vranks_); \
         coll_comm->cached_bintree_root = (ROOT);                                           \
     }                                                                                      \
 } while (0)
@@ -324,7 +328,9 @@ do {
         if( coll_comm->cached_bmtree ) { /* destroy previous binomial if defined */          \
             ompi_coll_base_topo_destroy_tree( &(coll_comm->cached_bmtree) );                \
         }                                                                                    \
-        coll_comm->cached_bmtree = ompi_coll_base_topo_build_bmtree( (OMPI_COMM), (ROOT) ); \
+        const int *order_, *vranks_;                                                        \
+        ompi_coll_base_topo_get_locality_order((OMPI_COMM), (BASE_MODULE), &order_, &vranks_); \
+        coll_comm->cached_bmtree = ompi_coll_base_topo_build_bmtree_ordered( (OMPI_COMM), (ROOT), order_, vranks_ ); \
         coll_comm->cached_bmtree_root = (ROOT);                                              \
     }                                                                                        \
 } while (0)
@@ -352,7 +358,9 @@ do {
         if (coll_comm->cached_kmtree ) { /* destroy previous k-nomial tree if defined */     \
             ompi_coll_base_topo_destroy_tree(&(coll_comm->cached_kmtree));                  \
         }                                                                                    \
-        coll_comm->cached_kmtree = ompi_coll_base_topo_build_kmtree((OMPI_COMM), (ROOT), (RADIX)); \
+        const int *order_, *vranks_;                                                        \
+        ompi_coll_base_topo_get_locality_order((OMPI_COMM), (BASE_MODULE), &order_, &vranks_); \
+        coll_comm->cached_kmtree = ompi_coll_base_topo_build_kmtree_ordered((OMPI_COMM), (ROOT), (RADIX), order_, vranks_); \
         coll_comm->cached_kmtree_root = (ROOT);                                              \
         coll_comm->cached_kmtree_radix = (RADIX);                                              \
     }                                                                                        \
@@ -366,7 +374,9 @@ do {
         if (coll_comm->cached_pipeline) { /* destroy previous pipeline if defined */             \
             ompi_coll_base_topo_destroy_tree( &(coll_comm->cached_pipeline) );                  \
         }                                                                                        \
-        coll_comm->cached_pipeline = ompi_coll_base_topo_build_chain( 1, (OMPI_COMM), (ROOT) ); \
+        const int *order_, *vranks_;                                                            \
+        ompi_coll_base_topo_get_locality_order((OMPI_COMM), (BASE_MODULE), &order_, &vranks_); \
+        coll_comm->cached_pipeline = ompi_coll_base_topo_build_chain_ordered( 1, (OMPI_COMM), (ROOT), order_, vranks_ ); \
         coll_comm->cached_pipeline_root = (ROOT);                                                \
     }                                                                                            \
 } while (0)
@@ -380,7 +390,9 @@ do {
         if( coll_comm->cached_chain) { /* destroy previous chain if defined */                   \
             ompi_coll_base_topo_destroy_tree( &(coll_comm->cached_chain) );                     \
         }                                                                                        \
-        coll_comm->cached_chain = ompi_coll_base_topo_build_chain((FANOUT), (OMPI_COMM), (ROOT)); \
+        const int *order_, *vranks_;                                                            \
+        ompi_coll_base_topo_get_locality_order((OMPI_COMM), (BASE_MODULE), &order_, &vranks_); \
+        coll_comm->cached_chain = ompi_coll_base_topo_build_chain_ordered((FANOUT), (OMPI_COMM), (ROOT), order_, vranks_); \
         coll_comm->cached_chain_root = (ROOT);                                                   \
         coll_comm->cached_chain_fanout = (FANOUT);                                               \
     }                                                                                            \
@@ -492,6 +504,15 @@ struct mca_coll_base_comm_t {
 
     /* in-order binary tree (root of the in-order binary tree is rank 0) */
     ompi_coll_tree_t *cached_in_order_bintree;
+
+    /* locality aware order of the ranks (NULL if the ranks keep their order) */
+    bool cached_locality_done;
+    int *cached_locality_order;
+    int *cached_locality_vranks;
+
+    /* lowest rank on the node of each rank */
+    bool cached_node_done;
+    int *cached_node_leaders;
 };
 typedef struct mca_coll_base_comm_t mca_coll_base_comm_t;
 OMPI_DECLSPEC OBJ_CLASS_DECLARATION(mca_coll_base_comm_t);
@@ -20,8 +20,13 @@
 
 #include "ompi_config.h"
 
+#include <stdlib.h>
+#include <string.h>
+
 #include "mpi.h"
 #include "opal/util/bit_ops.h"
+#include "opal/util/proc.h"
+#include "opal/mca/hwloc/base/base.h"
 #include "ompi/constants.h"
 #include "ompi/communicator/communicator.h"
 #include "ompi/mca/coll/base/coll_tags.h"
@@ -62,6 +67,314 @@ static int calculate_num_nodes_up_to_level( int fanout, int level )
     return ((pown(fanout,level) - 1)/(fanout - 1));
 }
 
+/*
+ * Translate a tree built on virtual ranks back to communicator ranks.
+ * Negative entries (no parent, no child) are left alone.
+ */
+static ompi_coll_tree_t*
+topo_tree_to_ranks( ompi_coll_tree_t* tree, const int *order )
+{
+    int i;
+
+    if( NULL == tree ) {
+        return NULL;
+    }
+    if( tree->tree_root >= 0 ) tree->tree_root = order[tree->tree_root];
+    if( tree->tree_prev >= 0 ) tree->tree_prev = order[tree->tree_prev];
+    for( i = 0; i < tree->tree_nextsize; i++ ) {
+        if( tree->tree_next[i] >= 0 ) {
+            tree->tree_next[i] = order[tree->tree_next[i]];
+        }
+    }
+    return tree;
+}
+
+/*
+ * Locality aware ordering of the ranks.
+ *
+ * The builders below derive the parents and children from rank arithmetic,
+ * so neighbours in the tree or in a ring are neighbours in rank order. When
+ * the ranks are mapped round-robin over the nodes or the sockets most edges
+ * then cross the network. With coll_base_topo_locality set the ranks are
+ * renumbered so that the ranks of a node, and of a socket in a node, have
+ * consecutive virtual ranks, and the trees and rings are built on the
+ * virtual ranks. The nodes and the sockets keep the order of their lowest
+ * rank, and the ranks keep their order inside a socket.
+ */
+typedef struct topo_locality_key_t {
+    int node;     /* lowest rank on the same node */
+    int socket;   /* socket index on the node, -1 if unknown or not bound */
+    int rank;
+} topo_locality_key_t;
+
+static int topo_locality_key_cmp( const void *a, const void *b )
+{
+    const topo_locality_key_t *ka = (const topo_locality_key_t*)a;
+    const topo_locality_key_t *kb = (const topo_locality_key_t*)b;
+
+    if( ka->node != kb->node ) return ka->node - kb->node;
+    if( ka->socket != kb->socket ) return ka->socket - kb->socket;
+    return ka->rank - kb->rank;
+}
+
+static int topo_my_socket( void )
+{
+    hwloc_cpuset_t cpuset;
+    hwloc_obj_t obj;
+    int socket = -1;
+
+    if( OPAL_SUCCESS != opal_hwloc_base_get_topology() ) {
+        return -1;
+    }
+    cpuset = hwloc_bitmap_alloc();
+    if( NULL == cpuset ) {
+        return -1;
+    }
+    if( 0 == hwloc_get_cpubind(opal_hwloc_topology, cpuset, HWLOC_CPUBIND_PROCESS) ) {
+        /* only a process bound inside one socket has a socket */
+        obj = hwloc_get_obj_covering_cpuset(opal_hwloc_topology, cpuset);
+        while( NULL != obj && HWLOC_OBJ_SOCKET != obj->type ) {
+            obj = obj->parent;
+        }
+        if( NULL != obj ) {
+            socket = (int)obj->logical_index;
+        }
+    }
+    hwloc_bitmap_free(cpuset);
+    return socket;
+}
+
+static uint32_t topo_hash_string( const char *str )
+{
+    uint32_t hash = 5381;
+
+    while( NULL != str && '\0' != *str ) {
+        hash = hash * 33 + (unsigned char)*str++;
+    }
+    return hash;
+}
+
+/* order of the (host hash, rank) pairs, the hashes are compared as
+ * values as their difference may not fit */
+static int topo_locality_host_cmp( const void *a, const void *b )
+{
+    const topo_locality_key_t *ka = (const topo_locality_key_t*)a;
+    const topo_locality_key_t *kb = (const topo_locality_key_t*)b;
+
+    if( ka->node != kb->node ) return (ka->node < kb->node) ? -1 : 1;
+    return ka->rank - kb->rank;
+}
+
+/* every rank has to take the same decision, otherwise the ranks would
+ * build different trees. Returns the lowest error of all the ranks */
+static int topo_locality_agree( int err, struct ompi_communicator_t* comm,
+                                mca_coll_base_module_t *module )
+{
+    if( MPI_SUCCESS != ompi_coll_base_allreduce_intra_recursivedoubling(MPI_IN_PLACE, &err, 1, MPI_INT,
+                                                                         MPI_MIN, comm, module) ) {
+        return OMPI_ERROR;
+    }
+    return err;
+}
+
+static int topo_build_locality_order( struct ompi_communicator_t* comm,
+                                      mca_coll_base_module_t *module,
+                                      mca_coll_base_comm_t *data )
+{
+    int size = ompi_comm_size(comm), i, first, err = OMPI_SUCCESS;
+    int32_t mine[2], *all = NULL;
+    int *order = NULL, *vranks = NULL;
+    topo_locality_key_t *keys = NULL;
+    bool identity = true;
+
+    all = (int32_t*)malloc(2 * size * sizeof(int32_t));
+    keys = (topo_locality_key_t*)malloc(size * sizeof(topo_locality_key_t));
+    order = (int*)malloc(size * sizeof(int));
+    vranks = (int*)malloc(size * sizeof(int));
+    if( NULL == all || NULL == keys || NULL == order || NULL == vranks ) {
+        err = OMPI_ERR_OUT_OF_RESOURCE;
+    }
+
+    err = topo_locality_agree(err, comm, module);
+    if( OMPI_SUCCESS != err ) {
+        goto cleanup;
+    }
+
+    /* the node only needs to compare equal on the same node, a collision
+     * merely misplaces some ranks */
+    mine[0] = (int32_t)topo_hash_string(OPAL_PROC_MY_HOSTNAME);
+    mine[1] = topo_my_socket();
+
+    /* all the ranks need the same view to build the same trees, so the
+     * keys are exchanged rather than derived from the local locality flags */
+    err = ompi_coll_base_allgather_intra_bruck(mine, 2, MPI_INT32_T, all, 2, MPI_INT32_T,
+                                               comm, module);
+    /* nothing can fail locally past this point */
+    err = topo_locality_agree(err, comm, module);
+    if( OMPI_SUCCESS != err ) {
+        goto cleanup;
+    }
+
+    /* group the ranks by host, a node is named by its lowest rank. Once
+     * sorted, the hashes in all are replaced by the node */
+    for( i = 0; i < size; i++ ) {
+        keys[i].node = all[2 * i];
+        keys[i].socket = all[2 * i + 1];
+        keys[i].rank = i;
+    }
+    qsort(keys, size, sizeof(topo_locality_key_t), topo_locality_host_cmp);
+    for( i = 0, first = 0; i < size; i++ ) {
+        if( keys[i].node != keys[first].node ) {
+            first = i;
+        }
+        all[2 * keys[i].rank] = keys[first].rank;
+    }
+
+    for( i = 0; i < size; i++ ) {
+        keys[i].node = all[2 * i];
+        keys[i].socket = all[2 * i + 1];
+        keys[i].rank = i;
+    }
+    qsort(keys, size, sizeof(topo_locality_key_t), topo_locality_key_cmp);
+
+    for( i = 0; i < size; i++ ) {
+        if( keys[i].rank != i ) {
+            identity = false;
+            break;
+        }
+    }
+
+    /* an identity order is not worth remapping every tree */
+    if( !identity ) {
+        for( i = 0; i < size; i++ ) {
+            order[i] = keys[i].rank;
+            vranks[keys[i].rank] = i;
+        }
+        data->cached_locality_order = order;
+        data->cached_locality_vranks = vranks;
+        order = vranks = NULL;
+    }
+
+    OPAL_OUTPUT((ompi_coll_base_framework.framework_output,
+                 "coll:base:topo:locality_order comm %d size %d %s",
+                 comm->c_contextid, size, identity ? "keeps the rank order" : "reorders the ranks"));
+
+ cleanup:
+    free(all);
+    free(keys);
+    free(order);
+    free(vranks);
+    return err;
+}
+
+int ompi_coll_base_topo_get_locality_order( struct ompi_communicator_t* comm,
+                                            mca_coll_base_module_t *module,
+                                            const int **order, const int **vranks )
+{
+    mca_coll_base_comm_t *data = module->base_data;
+    int err = OMPI_SUCCESS;
+
+    *order = NULL;
+    if( NULL != vranks ) *vranks = NULL;
+
+    if( !ompi_coll_base_topo_locality || NULL == data || OMPI_COMM_IS_INTER(comm) ||
+        ompi_comm_size(comm) < 3 ) {
+        return OMPI_SUCCESS;
+    }
+
+    /* computed once per communicator, on the first collective that asks.
+     * A failure is seen by all the ranks, which all try again next time */
+    if( !data->cached_locality_done ) {
+        err = topo_build_locality_order(comm, module, data);
+        if( OMPI_SUCCESS != err ) {
+            return err;
+        }
+        data->cached_locality_done = true;
+    }
+
+    *order = data->cached_locality_order;
+    if( NULL != vranks ) *vranks = data->cached_locality_vranks;
+    return err;
+}
+
+static int topo_node_key_cmp( const void *a, const void *b )
+{
+    const int32_t *ka = (const int32_t*)a, *kb = (const int32_t*)b;
+
+    if( ka[0] != kb[0] ) return (ka[0] < kb[0]) ? -1 : 1;
+    return (ka[1] < kb[1]) ? -1 : ((ka[1] > kb[1]) ? 1 : 0);
+}
+
+static int topo_build_node_leaders( struct ompi_communicator_t* comm,
+                                    mca_coll_base_module_t *module,
+                                    mca_coll_base_comm_t *data )
+{
+    int size = ompi_comm_size(comm), i, first, err;
+    int32_t mine, *keys = NULL;
+
+    keys = (int32_t*)malloc(2 * size * sizeof(int32_t));
+    data->cached_node_leaders = (int*)malloc(size * sizeof(int));
+    if( NULL == keys || NULL == data->cached_node_leaders ) {
+        err = OMPI_ERR_OUT_OF_RESOURCE;
+        goto cleanup;
+    }
+
+    /* a hash collision only merges two nodes, which costs an extra hop
+     * to the peers of the other node but never a wrong result */
+    mine = (int32_t)topo_hash_string(OPAL_PROC_MY_HOSTNAME);
+    err = ompi_coll_base_allgather_intra_bruck(&mine, 1, MPI_INT32_T, keys, 1, MPI_INT32_T,
+                                               comm, module);
+    if( MPI_SUCCESS != err ) {
+        goto cleanup;
+    }
+
+    /* spread the hashes to (hash, rank) pairs, from the end to not
+     * overwrite the hashes not yet moved */
+    for( i = size - 1; i >= 0; i-- ) {
+        keys[2 * i] = keys[i];
+        keys[2 * i + 1] = i;
+    }
+    qsort(keys, size, 2 * sizeof(int32_t), topo_node_key_cmp);
+
+    /* the leader of a node is its lowest rank */
+    for( i = 0, first = 0; i < size; i++ ) {
+        if( keys[2 * i] != keys[2 * first] ) {
+            first = i;
+        }
+        data->cached_node_leaders[keys[2 * i + 1]] = keys[2 * first + 1];
+    }
+
+ cleanup:
+    if( MPI_SUCCESS != err ) {
+        free(data->cached_node_leaders);
+        data->cached_node_leaders = NULL;
+    }
+    free(keys);
+    return err;
+}
+
+int ompi_coll_base_topo_get_node_leaders( struct ompi_communicator_t* comm,
+                                          mca_coll_base_module_t *module,
+                                          const int **leaders )
+{
+    mca_coll_base_comm_t *data = module->base_data;
+    int err = OMPI_SUCCESS;
+
+    *leaders = NULL;
+    if( NULL == data || OMPI_COMM_IS_INTER(comm) ) {
+        return OMPI_ERR_NOT_SUPPORTED;
+    }
+
+    /* computed once per communicator, on the first collective that asks */
+    if( !data->cached_node_done ) {
+        err = topo_build_node_leaders(comm, module, data);
+        data->cached_node_done = true;
+    }
+
+    *leaders = data->cached_node_leaders;
+    return (NULL == *leaders && OMPI_SUCCESS == err) ? OMPI_ERROR : err;
+}
+
 /*
  * And now the building functions.
  *
@@ -74,12 +387,10 @@ static int calculate_num_nodes_up_to_level( int fanout, int level )
  *         3   5 4   6      <-- delta = 4 (fanout^2)
  */
 
-ompi_coll_tree_t*
-ompi_coll_base_topo_build_tree( int fanout,
-                                 struct ompi_communicator_t* comm,
-                                 int root )
+static ompi_coll_tree_t*
+topo_build_tree( int fanout, int size, int rank, int root )
 {
-    int rank, size, schild, sparent, shiftedrank, i;
+    int schild, sparent, shiftedrank, i;
     int level; /* location of my rank in the tree structure of size */
     int delta; /* number of nodes on my level */
     int slimit; /* total number of nodes on levels above me */
@@ -96,12 +407,6 @@ ompi_coll_base_topo_build_tree( int fanout,
         return NULL;
     }
 
-    /*
-     * Get size and rank of the process in this communicator
-     */
-    size = ompi_comm_size(comm);
-    rank = ompi_comm_rank(comm);
-
     tree = (ompi_coll_tree_t*)malloc(COLL_TREE_SIZE(MAXTREEFANOUT));
     if (!tree) {
         OPAL_OUTPUT((ompi_coll_base_framework.framework_output,"coll:base:topo_build_tree PANIC::out of memory"));
@@ -174,6 +479,27 @@ ompi_coll_base_topo_build_tree( int fanout,
     return tree;
 }
 
+ompi_coll_tree_t*
+ompi_coll_base_topo_build_tree( int fanout,
+                                 struct ompi_communicator_t* comm,
+                                 int root )
+{
+    return topo_build_tree( fanout, ompi_comm_size(comm), ompi_comm_rank(comm), root );
+}
+
+ompi_coll_tree_t*
+ompi_coll_base_topo_build_tree_ordered( int fanout,
+                                         struct ompi_communicator_t* comm,
+                                         int root, const int *order, const int *vranks )
+{
+    if( NULL == order ) {
+        return ompi_coll_base_topo_build_tree( fanout, comm, root );
+    }
+    return topo_tree_to_ranks( topo_build_tree( fanout, ompi_comm_size(comm),
+                                                vranks[ompi_comm_rank(comm)], vranks[root] ),
+                               order );
+}
+
 /*
  * Constructs in-order binary tree which can be used for non-commutative reduce
  * operations.
@@ -322,21 +648,14 @@ int ompi_coll_base_topo_destroy_tree( ompi_coll_tree_t** tree )
  *                                                                |
  *                                                                7
  */
-ompi_coll_tree_t*
-ompi_coll_base_topo_build_bmtree( struct ompi_communicator_t* comm,
-                                   int root )
+static ompi_coll_tree_t*
+topo_build_bmtree( int size, int rank, int root )
 {
-    int childs = 0, rank, size, mask = 1, index, remote, i;
+    int childs = 0, mask = 1, index, remote, i;
     ompi_coll_tree_t *bmtree;
 
     OPAL_OUTPUT((ompi_coll_base_framework.framework_output,"coll:base:topo:build_bmtree rt %d", root));
 
-    /*
-     * Get size and rank of the process in this communicator
-     */
-    size = ompi_comm_size(comm);
-    rank = ompi_comm_rank(comm);
-
     index = rank -root;
 
     bmtree = (ompi_coll_tree_t*)malloc(COLL_TREE_SIZE(MAXTREEFANOUT));
@@ -385,6 +704,25 @@ ompi_coll_base_topo_build_bmtree( struct ompi_communicator_t* comm,
     return bmtree;
 }
 
+ompi_coll_tree_t*
+ompi_coll_base_topo_build_bmtree( struct ompi_communicator_t* comm,
+                                   int root )
+{
+    return topo_build_bmtree( ompi_comm_size(comm), ompi_comm_rank(comm), root );
+}
+
+ompi_coll_tree_t*
+ompi_coll_base_topo_build_bmtree_ordered( struct ompi_communicator_t* comm,
+                                           int root, const int *order, const int *vranks )
+{
+    if( NULL == order ) {
+        return ompi_coll_base_topo_build_bmtree( comm, root );
+    }
+    return topo_tree_to_ranks( topo_build_bmtree( ompi_comm_size(comm),
+                                                  vranks[ompi_comm_rank(comm)], vranks[root] ),
+                               order );
+}
+
 /*
  * Constructs in-order binomial tree which can be used for gather/scatter
  * operations.
@@ -470,14 +808,11 @@ ompi_coll_base_topo_build_in_order_bmtree( struct ompi_communicator_t* comm,
  *     |
  *     7
  */
-ompi_coll_tree_t*
-ompi_coll_base_topo_build_kmtree(struct ompi_communicator_t* comm,
-                                 int root, int radix)
+static ompi_coll_tree_t*
+topo_build_kmtree(int comm_size, int rank, int root, int radix)
 {
     OPAL_OUTPUT((ompi_coll_base_framework.framework_output,
                  "coll:base:topo:build_kmtree root %d, radix %d", root, radix));
-    int comm_size = ompi_comm_size(comm);
-    int rank = ompi_comm_rank(comm);
 
     /* nchilds <= (radix - 1) * \ceil(\log_{radix}(comm_size)) */
     int log_radix = 0;
@@ -528,21 +863,33 @@ ompi_coll_base_topo_build_kmtree(struct ompi_communicator_t* comm,
 }
 
 ompi_coll_tree_t*
-ompi_coll_base_topo_build_chain( int fanout,
-                                  struct ompi_communicator_t* comm,
-                                  int root )
+ompi_coll_base_topo_build_kmtree(struct ompi_communicator_t* comm,
+                                 int root, int radix)
+{
+    return topo_build_kmtree(ompi_comm_size(comm), ompi_comm_rank(comm), root, radix);
+}
+
+ompi_coll_tree_t*
+ompi_coll_base_topo_build_kmtree_ordered(struct ompi_communicator_t* comm,
+                                         int root, int radix,
+                                         const int *order, const int *vranks)
 {
-    int i, maxchainlen, mark, head, len, rank, size, srank /* shifted rank */;
+    if (NULL == order) {
+        return ompi_coll_base_topo_build_kmtree(comm, root, radix);
+    }
+    return topo_tree_to_ranks(topo_build_kmtree(ompi_comm_size(comm), vranks[ompi_comm_rank(comm)],
+                                                vranks[root], radix),
+                              order);
+}
+
+static ompi_coll_tree_t*
+topo_build_chain( int fanout, int size, int rank, int root )
+{
+    int i, maxchainlen, mark, head, len, srank /* shifted rank */;
     ompi_coll_tree_t *chain;
 
     OPAL_OUTPUT((ompi_coll_base_framework.framework_output,"coll:base:topo:build_chain fo %d rt %d", fanout, root));
 
-    /*
-     * Get size and rank of the process in this communicator
-     */
-    size = ompi_comm_size(comm);
-    rank = ompi_comm_rank(comm);
-
     if( fanout < 1 ) {
         OPAL_OUTPUT((ompi_coll_base_framework.framework_output,"coll:base:topo:build_chain WARNING invalid fanout of ZERO, forcing to 1 (pipeline)!"));
         fanout = 1;
@@ -672,6 +1019,27 @@ ompi_coll_base_topo_build_chain( int fanout,
     return chain;
 }
 
+ompi_coll_tree_t*
+ompi_coll_base_topo_build_chain( int fanout,
+                                  struct ompi_communicator_t* comm,
+                                  int root )
+{
+    return topo_build_chain( fanout, ompi_comm_size(comm), ompi_comm_rank(comm), root );
+}
+
+ompi_coll_tree_t*
+ompi_coll_base_topo_build_chain_ordered( int fanout,
+                                          struct ompi_communicator_t* comm,
+                                          int root, const int *order, const int *vranks )
+{
+    if( NULL == order ) {
+        return ompi_coll_base_topo_build_chain( fanout, comm, root );
+    }
+    return topo_tree_to_ranks( topo_build_chain( fanout, ompi_comm_size(comm),
+                                                 vranks[ompi_comm_rank(comm)], vranks[root] ),
+                               order );
+}
+
 int ompi_coll_base_topo_dump_tree (ompi_coll_tree_t* tree, int rank)
 {
     int i;
@@ -21,6 +21,7 @@
 
 #include "ompi_config.h"
 #include <stddef.h>
+#include <stdbool.h>
 
 #define MAXTREEFANOUT 32
 
@@ -62,6 +63,55 @@ ompi_coll_base_topo_build_chain( int fanout,
                                   struct ompi_communicator_t* com,
                                   int root );
 
+/*
+ * Locality aware variants of the builders: the tree is built on the
+ * virtual ranks given by ompi_coll_base_topo_get_locality_order(), order
+ * maps virtual ranks to ranks and vranks ranks to virtual ranks. A NULL
+ * order builds the same tree as the plain builders.
+ */
+ompi_coll_tree_t*
+ompi_coll_base_topo_build_tree_ordered( int fanout,
+                                         struct ompi_communicator_t* com,
+                                         int root, const int *order, const int *vranks );
+
+ompi_coll_tree_t*
+ompi_coll_base_topo_build_bmtree_ordered( struct ompi_communicator_t* comm,
+                                           int root, const int *order, const int *vranks );
+
+ompi_coll_tree_t*
+ompi_coll_base_topo_build_kmtree_ordered(struct ompi_communicator_t* comm,
+                                         int root, int radix,
+                                         const int *order, const int *vranks);
+
+ompi_coll_tree_t*
+ompi_coll_base_topo_build_chain_ordered( int fanout,
+                                          struct ompi_communicator_t* com,
+                                          int root, const int *order, const int *vranks );
+
+/* rank of the virtual rank VRANK in a locality aware order, NULL if none */
+#define COLL_BASE_TOPO_RANK(ORDER, VRANK) ((NULL == (ORDER)) ? (VRANK) : (ORDER)[(VRANK)])
+
+/* set by the coll_base_topo_locality MCA parameter */
+OMPI_DECLSPEC extern bool ompi_coll_base_topo_locality;
+
+/*
+ * Return the locality aware order of the ranks of comm, computing it on the
+ * first call. This is collective over comm the first time. *order (and
+ * *vranks) are set to NULL when the ranks keep their order.
+ */
+int ompi_coll_base_topo_get_locality_order( struct ompi_communicator_t* comm,
+                                            struct mca_coll_base_module_2_3_0_t *module,
+                                            const int **order, const int **vranks );
+
+/*
+ * Return for each rank of comm the lowest rank on the same node, computing
+ * it on the first call. This is collective over comm the first time, and
+ * every rank gets the same map.
+ */
+int ompi_coll_base_topo_get_node_leaders( struct ompi_communicator_t* comm,
+                                          struct mca_coll_base_module_2_3_0_t *module,
+                                          const int **leaders );
+
 int ompi_coll_base_topo_destroy_tree( ompi_coll_tree_t** tree );
 
 /* debugging stuff, will be removed later */
@@ -0,0 +1,155 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#ifndef MCA_COLL_HIER_EXPORT_H
+#define MCA_COLL_HIER_EXPORT_H
+
+#include "ompi_config.h"
+
+#include "mpi.h"
+
+#include "opal/class/opal_object.h"
+#include "opal/mca/mca.h"
+#include "opal/util/output.h"
+
+#include "ompi/constants.h"
+#include "ompi/mca/coll/coll.h"
+#include "ompi/mca/coll/base/base.h"
+#include "ompi/communicator/communicator.h"
+#include "ompi/datatype/ompi_datatype.h"
+
+BEGIN_C_DECLS
+
+/*
+ * The hier component runs collectives in two levels. Each communicator
+ * is split into one node-local communicator per node and a leaders
+ * communicator made of the first rank of each node. Intra-node phases
+ * run on the collectives selected for the node-local communicators
+ * (coll/sm when its priority allows it, else tuned) and inter-node
+ * phases on those selected for the leaders communicator (tuned).
+ * Messages larger than a segment are pipelined: while the leaders
+ * exchange one segment the nodes reduce the next one and broadcast the
+ * previous one, using the non-blocking collectives of the sub-communicators.
+ *
+ * The sub-communicators are created on the first collective call that
+ * needs them, as every rank of the communicator takes part in it.
+ */
+
+/* API functions */
+
+int mca_coll_hier_init_query(bool enable_progress_threads,
+                             bool enable_mpi_threads);
+mca_coll_base_module_t
+*mca_coll_hier_comm_query(struct ompi_communicator_t *comm,
+                          int *priority);
+
+int mca_coll_hier_module_enable(mca_coll_base_module_t *module,
+                                struct ompi_communicator_t *comm);
+
+int mca_coll_hier_allreduce_intra(const void *sbuf, void *rbuf, int count,
+                                  struct ompi_datatype_t *dtype,
+                                  struct ompi_op_t *op,
+                                  struct ompi_communicator_t *comm,
+                                  mca_coll_base_module_t *module);
+
+int mca_coll_hier_barrier_intra(struct ompi_communicator_t *comm,
+                                mca_coll_base_module_t *module);
+
+int mca_coll_hier_bcast_intra(void *buff, int count,
+                              struct ompi_datatype_t *datatype,
+                              int root,
+                              struct ompi_communicator_t *comm,
+                              mca_coll_base_module_t *module);
+
+int mca_coll_hier_ft_event(int status);
+
+/* Types */
+/* Module */
+
+typedef struct mca_coll_hier_module_t {
+    mca_coll_base_module_t super;
+
+    /* Pointers to the collective functions this module replaces. They are
+     * used for small communicators, unsupported arguments and while the
+     * sub-communicators are being created. */
+    mca_coll_base_comm_coll_t c_coll;
+
+    /* Sub-communicators are set up (or the module fell back for good) */
+    bool subcomms_ready;
+
+    /* The communicator does not have a two level structure: all the ranks
+     * are on one node or every node holds a single rank */
+    bool flat;
+
+    /* Sub-communicators are being created */
+    bool in_setup;
+
+    /* Ranks of this node */
+    struct ompi_communicator_t *low_comm;
+
+    /* Leaders of all the nodes (MPI_COMM_NULL on non-leaders) */
+    struct ompi_communicator_t *up_comm;
+
+    /* For each rank of the communicator, the rank of its node leader in
+     * up_comm and its own rank in its node-local communicator */
+    int *node_leader;
+    int *node_rank;
+} mca_coll_hier_module_t;
+
+OBJ_CLASS_DECLARATION(mca_coll_hier_module_t);
+
+/* Component */
+
+typedef struct mca_coll_hier_component_t {
+    mca_coll_base_component_2_0_0_t super;
+
+    /* Priority of this component */
+    int priority;
+
+    /* Size of a pipeline segment, in bytes */
+    int segment_size;
+} mca_coll_hier_component_t;
+
+/* Globally exported variables */
+
+OMPI_MODULE_DECLSPEC extern mca_coll_hier_component_t mca_coll_hier_component;
+
+/* Internal functions */
+
+/**
+ * Create the sub-communicators of the module on first use.
+ *
+ * @return true if the collective should run hierarchically, false if the
+ *         caller has to fall back to the previously selected function.
+ */
+bool mca_coll_hier_subcomms_setup(struct ompi_communicator_t *comm,
+                                  mca_coll_hier_module_t *module);
+
+/* Number of elements per pipeline segment */
+static inline int mca_coll_hier_segment_count(struct ompi_datatype_t *dtype, int count)
+{
+    size_t type_size;
+    int seg_count;
+
+    ompi_datatype_type_size(dtype, &type_size);
+    if (0 == type_size) {
+        return count;
+    }
+
+    seg_count = (int) (mca_coll_hier_component.segment_size / type_size);
+    if (seg_count <= 0) {
+        seg_count = 1;
+    }
+
+    return (seg_count < count) ? seg_count : count;
+}
+
+END_C_DECLS
+
+#endif /* MCA_COLL_HIER_EXPORT_H */
@@ -0,0 +1,147 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+
+#include "mpi.h"
+#include "ompi/constants.h"
+#include "ompi/communicator/communicator.h"
+#include "ompi/op/op.h"
+#include "ompi/request/request.h"
+#include "coll_hier.h"
+
+
+/*
+ *	allreduce_intra
+ *
+ *	Function:	- hierarchical allreduce
+ *	Accepts:	- same as MPI_Allreduce()
+ *	Returns:	- MPI_SUCCESS or error code
+ *
+ *	Each node reduces to its leader, the leaders allreduce among
+ *	themselves and each leader broadcasts the result on its node.
+ *	Large buffers are cut in segments and the three phases are
+ *	pipelined: at step s the nodes reduce segment s, the leaders
+ *	allreduce segment s-1 and the nodes broadcast segment s-2.
+ */
+int mca_coll_hier_allreduce_intra(const void *sbuf, void *rbuf, int count,
+                                  struct ompi_datatype_t *dtype,
+                                  struct ompi_op_t *op,
+                                  struct ompi_communicator_t *comm,
+                                  mca_coll_base_module_t *module)
+{
+    mca_coll_hier_module_t *h = (mca_coll_hier_module_t*) module;
+    ompi_communicator_t *low, *up;
+    ompi_request_t *reqs[3];
+    ptrdiff_t lb, extent, offset;
+    int err = OMPI_SUCCESS, seg_count, num_segs, nreqs, seg, seg_len;
+    bool leader;
+
+    /* the two level order of the ranks differs from the communicator
+     * order, which only commutative operations can ignore */
+    if (0 == count || !ompi_op_is_commute(op) || !mca_coll_hier_subcomms_setup(comm, h)) {
+        return h->c_coll.coll_allreduce(sbuf, rbuf, count, dtype, op, comm,
+                                        h->c_coll.coll_allreduce_module);
+    }
+
+    low = h->low_comm;
+    up = h->up_comm;
+    leader = (0 == ompi_comm_rank(low));
+
+    ompi_datatype_get_extent(dtype, &lb, &extent);
+    seg_count = mca_coll_hier_segment_count(dtype, count);
+    num_segs = (count + seg_count - 1) / seg_count;
+
+    if (1 == num_segs) {
+        if (leader) {
+            err = low->c_coll->coll_reduce(sbuf, rbuf, count, dtype, op, 0, low,
+                                           low->c_coll->coll_reduce_module);
+        } else {
+            err = low->c_coll->coll_reduce((MPI_IN_PLACE == sbuf) ? rbuf : sbuf, NULL, count,
+                                           dtype, op, 0, low, low->c_coll->coll_reduce_module);
+        }
+        if (OMPI_SUCCESS != err) {
+            return err;
+        }
+
+        if (leader) {
+            err = up->c_coll->coll_allreduce(MPI_IN_PLACE, rbuf, count, dtype, op, up,
+                                             up->c_coll->coll_allreduce_module);
+            if (OMPI_SUCCESS != err) {
+                return err;
+            }
+        }
+
+        return low->c_coll->coll_bcast(rbuf, count, dtype, 0, low,
+                                       low->c_coll->coll_bcast_module);
+    }
+
+#define HIER_SEG_LEN(s) (((s) == num_segs - 1) ? count - (s) * seg_count : seg_count)
+#define HIER_SEG_OFFSET(s) ((ptrdiff_t) (s) * seg_count * extent)
+
+    for (int step = 0 ; step < num_segs + 2 ; ++step) {
+        nreqs = 0;
+
+        if (step < num_segs) {
+            seg = step;
+            seg_len = HIER_SEG_LEN(seg);
+            offset = HIER_SEG_OFFSET(seg);
+            if (leader) {
+                err = low->c_coll->coll_ireduce((MPI_IN_PLACE == sbuf) ? MPI_IN_PLACE : (char *) sbuf + offset,
+                                                (char *) rbuf + offset, seg_len, dtype, op, 0, low,
+                                                reqs + nreqs, low->c_coll->coll_ireduce_module);
+            } else {
+                err = low->c_coll->coll_ireduce((MPI_IN_PLACE == sbuf) ? (char *) rbuf + offset : (char *) sbuf + offset,
+                                                NULL, seg_len, dtype, op, 0, low,
+                                                reqs + nreqs, low->c_coll->coll_ireduce_module);
+            }
+            if (OMPI_SUCCESS != err) {
+                break;
+            }
+            ++nreqs;
+        }
+
+        if (leader && step >= 1 && step <= num_segs) {
+            seg = step - 1;
+            err = up->c_coll->coll_iallreduce(MPI_IN_PLACE, (char *) rbuf + HIER_SEG_OFFSET(seg),
+                                              HIER_SEG_LEN(seg), dtype, op, up, reqs + nreqs,
+                                              up->c_coll->coll_iallreduce_module);
+            if (OMPI_SUCCESS != err) {
+                break;
+            }
+            ++nreqs;
+        }
+
+        if (step >= 2) {
+            seg = step - 2;
+            err = low->c_coll->coll_ibcast((char *) rbuf + HIER_SEG_OFFSET(seg), HIER_SEG_LEN(seg),
+                                           dtype, 0, low, reqs + nreqs, low->c_coll->coll_ibcast_module);
+            if (OMPI_SUCCESS != err) {
+                break;
+            }
+            ++nreqs;
+        }
+
+        err = ompi_request_wait_all(nreqs, reqs, MPI_STATUSES_IGNORE);
+        nreqs = 0;
+        if (OMPI_SUCCESS != err) {
+            break;
+        }
+    }
+
+    if (0 < nreqs) {
+        /* do not leave started operations behind on error */
+        (void) ompi_request_wait_all(nreqs, reqs, MPI_STATUSES_IGNORE);
+    }
+
+#undef HIER_SEG_LEN
+#undef HIER_SEG_OFFSET
+
+    return err;
+}
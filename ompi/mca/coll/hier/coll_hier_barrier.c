@@ -0,0 +1,55 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+
+#include "mpi.h"
+#include "ompi/constants.h"
+#include "ompi/communicator/communicator.h"
+#include "coll_hier.h"
+
+
+/*
+ *	barrier_intra
+ *
+ *	Function:	- hierarchical barrier
+ *	Accepts:	- same as MPI_Barrier()
+ *	Returns:	- MPI_SUCCESS or error code
+ *
+ *	The nodes synchronize locally, then the leaders synchronize and
+ *	finally the leaders release their nodes.
+ */
+int mca_coll_hier_barrier_intra(struct ompi_communicator_t *comm,
+                                mca_coll_base_module_t *module)
+{
+    mca_coll_hier_module_t *h = (mca_coll_hier_module_t*) module;
+    ompi_communicator_t *low, *up;
+    int err;
+
+    if (!mca_coll_hier_subcomms_setup(comm, h)) {
+        return h->c_coll.coll_barrier(comm, h->c_coll.coll_barrier_module);
+    }
+
+    low = h->low_comm;
+    up = h->up_comm;
+
+    err = low->c_coll->coll_barrier(low, low->c_coll->coll_barrier_module);
+    if (OMPI_SUCCESS != err) {
+        return err;
+    }
+
+    if (MPI_COMM_NULL != up) {
+        err = up->c_coll->coll_barrier(up, up->c_coll->coll_barrier_module);
+        if (OMPI_SUCCESS != err) {
+            return err;
+        }
+    }
+
+    return low->c_coll->coll_barrier(low, low->c_coll->coll_barrier_module);
+}
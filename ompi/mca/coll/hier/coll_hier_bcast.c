@@ -0,0 +1,138 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+
+#include "mpi.h"
+#include "ompi/constants.h"
+#include "ompi/communicator/communicator.h"
+#include "ompi/request/request.h"
+#include "coll_hier.h"
+
+
+/*
+ *	bcast_intra
+ *
+ *	Function:	- hierarchical broadcast
+ *	Accepts:	- same as MPI_Bcast()
+ *	Returns:	- MPI_SUCCESS or error code
+ *
+ *	The root broadcasts on its node, which hands the data to the
+ *	node leader, the leaders broadcast among themselves and the
+ *	other leaders broadcast on their nodes. Large buffers are cut
+ *	in segments: at step s the root node broadcasts segment s, the
+ *	leaders segment s-1 and the other nodes segment s-2.
+ */
+int mca_coll_hier_bcast_intra(void *buff, int count,
+                              struct ompi_datatype_t *datatype,
+                              int root,
+                              struct ompi_communicator_t *comm,
+                              mca_coll_base_module_t *module)
+{
+    mca_coll_hier_module_t *h = (mca_coll_hier_module_t*) module;
+    ompi_communicator_t *low, *up;
+    ompi_request_t *reqs[2];
+    ptrdiff_t lb, extent;
+    int err = OMPI_SUCCESS, seg_count, num_segs, nreqs, seg, low_root, root_leader, delay;
+    bool leader;
+
+    if (0 == count || !mca_coll_hier_subcomms_setup(comm, h)) {
+        return h->c_coll.coll_bcast(buff, count, datatype, root, comm,
+                                    h->c_coll.coll_bcast_module);
+    }
+
+    low = h->low_comm;
+    up = h->up_comm;
+    leader = (0 == ompi_comm_rank(low));
+    root_leader = h->node_leader[root];
+
+    /* on the root node the root starts the intra-node broadcast, the other
+     * nodes wait for their leader to get the data from the leaders */
+    if (h->node_leader[ompi_comm_rank(comm)] == root_leader) {
+        low_root = h->node_rank[root];
+        delay = 0;
+    } else {
+        low_root = 0;
+        delay = 2;
+    }
+
+    ompi_datatype_get_extent(datatype, &lb, &extent);
+    seg_count = mca_coll_hier_segment_count(datatype, count);
+    num_segs = (count + seg_count - 1) / seg_count;
+
+    if (1 == num_segs) {
+        if (0 == delay) {
+            err = low->c_coll->coll_bcast(buff, count, datatype, low_root, low,
+                                          low->c_coll->coll_bcast_module);
+            if (OMPI_SUCCESS != err) {
+                return err;
+            }
+        }
+
+        if (leader) {
+            err = up->c_coll->coll_bcast(buff, count, datatype, root_leader, up,
+                                         up->c_coll->coll_bcast_module);
+            if (OMPI_SUCCESS != err) {
+                return err;
+            }
+        }
+
+        if (0 != delay) {
+            err = low->c_coll->coll_bcast(buff, count, datatype, 0, low,
+                                          low->c_coll->coll_bcast_module);
+        }
+
+        return err;
+    }
+
+#define HIER_SEG_LEN(s) (((s) == num_segs - 1) ? count - (s) * seg_count : seg_count)
+#define HIER_SEG_OFFSET(s) ((ptrdiff_t) (s) * seg_count * extent)
+
+    for (int step = 0 ; step < num_segs + 2 ; ++step) {
+        nreqs = 0;
+
+        seg = step - delay;
+        if (seg >= 0 && seg < num_segs) {
+            err = low->c_coll->coll_ibcast((char *) buff + HIER_SEG_OFFSET(seg), HIER_SEG_LEN(seg),
+                                           datatype, low_root, low, reqs + nreqs,
+                                           low->c_coll->coll_ibcast_module);
+            if (OMPI_SUCCESS != err) {
+                break;
+            }
+            ++nreqs;
+        }
+
+        seg = step - 1;
+        if (leader && seg >= 0 && seg < num_segs) {
+            err = up->c_coll->coll_ibcast((char *) buff + HIER_SEG_OFFSET(seg), HIER_SEG_LEN(seg),
+                                          datatype, root_leader, up, reqs + nreqs,
+                                          up->c_coll->coll_ibcast_module);
+            if (OMPI_SUCCESS != err) {
+                break;
+            }
+            ++nreqs;
+        }
+
+        err = ompi_request_wait_all(nreqs, reqs, MPI_STATUSES_IGNORE);
+        nreqs = 0;
+        if (OMPI_SUCCESS != err) {
+            break;
+        }
+    }
+
+    if (0 < nreqs) {
+        /* do not leave started operations behind on error */
+        (void) ompi_request_wait_all(nreqs, reqs, MPI_STATUSES_IGNORE);
+    }
+
+#undef HIER_SEG_LEN
+#undef HIER_SEG_OFFSET
+
+    return err;
+}
@@ -0,0 +1,88 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+
+#include <string.h>
+
+#include "opal/util/output.h"
+
+#include "mpi.h"
+#include "ompi/constants.h"
+#include "coll_hier.h"
+
+/*
+ * Public string showing the coll ompi_hier component version number
+ */
+const char *mca_coll_hier_component_version_string =
+    "Open MPI hier collective MCA component version " OMPI_VERSION;
+
+/*
+ * Local function
+ */
+static int hier_register(void);
+
+/*
+ * Instantiate the public struct with all of our public information
+ * and pointers to our public functions in it
+ */
+
+mca_coll_hier_component_t mca_coll_hier_component = {
+    {
+        /* First, the mca_component_t struct containing meta information
+         * about the component itself */
+
+       .collm_version = {
+            MCA_COLL_BASE_VERSION_2_0_0,
+
+            /* Component name and version */
+            .mca_component_name = "hier",
+            MCA_BASE_MAKE_VERSION(component, OMPI_MAJOR_VERSION, OMPI_MINOR_VERSION,
+                                  OMPI_RELEASE_VERSION),
+
+            /* Component open and close functions */
+            .mca_register_component_params = hier_register
+        },
+        .collm_data = {
+            /* The component is checkpoint ready */
+            MCA_BASE_METADATA_PARAM_CHECKPOINT
+        },
+
+        /* Initialization / querying functions */
+
+        .collm_init_query = mca_coll_hier_init_query,
+        .collm_comm_query = mca_coll_hier_comm_query
+    },
+};
+
+
+static int hier_register(void)
+{
+    mca_base_component_t *c = &mca_coll_hier_component.super.collm_version;
+
+    mca_coll_hier_component.priority = 0;
+    (void) mca_base_component_var_register(c, "priority",
+                                           "Priority of the hier coll component. It must be higher than the priority "
+                                           "of tuned to be used; 0 disables the component",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                           OPAL_INFO_LVL_6,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &mca_coll_hier_component.priority);
+
+    mca_coll_hier_component.segment_size = 65536;
+    (void) mca_base_component_var_register(c, "segment_size",
+                                           "Size, in bytes, of the segments the intra-node and inter-node phases of "
+                                           "large collectives are pipelined by",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                           OPAL_INFO_LVL_6,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &mca_coll_hier_component.segment_size);
+
+    return OMPI_SUCCESS;
+}
@@ -0,0 +1,257 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+
+#include <string.h>
+#include <stdio.h>
+
+#include "mpi.h"
+
+#include "opal/threads/thread_usage.h"
+#include "opal/util/show_help.h"
+
+#include "ompi/constants.h"
+#include "ompi/communicator/communicator.h"
+#include "ompi/group/group.h"
+#include "ompi/mca/coll/coll.h"
+#include "ompi/mca/coll/base/base.h"
+#include "coll_hier.h"
+
+
+/* Set while this thread creates sub-communicators so the hier component
+ * does not select itself on them. Communicator creation is collective, so
+ * every process sees the flag set for the same communicators. */
+#if OPAL_HAVE_THREAD_LOCAL
+static opal_thread_local bool hier_creating_subcomms = false;
+#else
+static bool hier_creating_subcomms = false;
+#endif
+
+
+static void mca_coll_hier_module_construct(mca_coll_hier_module_t *module)
+{
+    memset(&(module->c_coll), 0, sizeof(module->c_coll));
+    module->subcomms_ready = false;
+    module->flat = false;
+    module->in_setup = false;
+    module->low_comm = MPI_COMM_NULL;
+    module->up_comm = MPI_COMM_NULL;
+    module->node_leader = NULL;
+    module->node_rank = NULL;
+}
+
+static void mca_coll_hier_module_destruct(mca_coll_hier_module_t *module)
+{
+    if (NULL != module->c_coll.coll_allreduce_module) {
+        OBJ_RELEASE(module->c_coll.coll_allreduce_module);
+        OBJ_RELEASE(module->c_coll.coll_barrier_module);
+        OBJ_RELEASE(module->c_coll.coll_bcast_module);
+    }
+
+    if (MPI_COMM_NULL != module->low_comm) {
+        ompi_comm_free(&module->low_comm);
+    }
+    if (MPI_COMM_NULL != module->up_comm) {
+        ompi_comm_free(&module->up_comm);
+    }
+
+    free(module->node_leader);
+    free(module->node_rank);
+}
+
+OBJ_CLASS_INSTANCE(mca_coll_hier_module_t, mca_coll_base_module_t,
+                   mca_coll_hier_module_construct,
+                   mca_coll_hier_module_destruct);
+
+
+/*
+ * Initial query function that is invoked during MPI_INIT, allowing
+ * this component to disqualify itself if it doesn't support the
+ * required level of thread support.
+ */
+int mca_coll_hier_init_query(bool enable_progress_threads,
+                             bool enable_mpi_threads)
+{
+    /* Nothing to do */
+    return OMPI_SUCCESS;
+}
+
+
+/*
+ * Invoked when there's a new communicator that has been created.
+ * Look at the communicator and decide which set of functions and
+ * priority we want to return.
+ */
+mca_coll_base_module_t *
+mca_coll_hier_comm_query(struct ompi_communicator_t *comm,
+                         int *priority)
+{
+    mca_coll_hier_module_t *hier_module;
+
+    if (mca_coll_hier_component.priority <= 0 || hier_creating_subcomms) {
+        return NULL;
+    }
+
+    /* Only intra-communicators spanning several nodes have a hierarchy to
+     * exploit. Whether all the peers are local is the same on every rank, so
+     * all the ranks agree on the selection. */
+    if (OMPI_COMM_IS_INTER(comm) || ompi_comm_size(comm) < 3 ||
+        !ompi_group_have_remote_peers(comm->c_local_group)) {
+        opal_output_verbose(10, ompi_coll_base_framework.framework_output,
+                            "coll:hier:comm_query (%d/%s): intercomm, comm is too small, or all peers local; disqualifying myself",
+                            comm->c_contextid, comm->c_name);
+        return NULL;
+    }
+
+    hier_module = OBJ_NEW(mca_coll_hier_module_t);
+    if (NULL == hier_module) {
+        return NULL;
+    }
+
+    *priority = mca_coll_hier_component.priority;
+
+    hier_module->super.coll_module_enable = mca_coll_hier_module_enable;
+    hier_module->super.ft_event = mca_coll_hier_ft_event;
+
+    hier_module->super.coll_allreduce = mca_coll_hier_allreduce_intra;
+    hier_module->super.coll_barrier   = mca_coll_hier_barrier_intra;
+    hier_module->super.coll_bcast     = mca_coll_hier_bcast_intra;
+
+    return &(hier_module->super);
+}
+
+
+/*
+ * Init module on the communicator
+ */
+int mca_coll_hier_module_enable(mca_coll_base_module_t *module,
+                                struct ompi_communicator_t *comm)
+{
+    mca_coll_hier_module_t *h = (mca_coll_hier_module_t*) module;
+
+    /* Save the prior layer of coll functions */
+    h->c_coll = *comm->c_coll;
+
+    if (NULL == h->c_coll.coll_allreduce_module ||
+        NULL == h->c_coll.coll_barrier_module ||
+        NULL == h->c_coll.coll_bcast_module) {
+        opal_output_verbose(10, ompi_coll_base_framework.framework_output,
+                            "coll:hier:module_enable (%d/%s): no underlying collectives to fall back to",
+                            comm->c_contextid, comm->c_name);
+        memset(&(h->c_coll), 0, sizeof(h->c_coll));
+        return OMPI_ERR_NOT_FOUND;
+    }
+
+    OBJ_RETAIN(h->c_coll.coll_allreduce_module);
+    OBJ_RETAIN(h->c_coll.coll_barrier_module);
+    OBJ_RETAIN(h->c_coll.coll_bcast_module);
+
+    return OMPI_SUCCESS;
+}
+
+
+bool mca_coll_hier_subcomms_setup(struct ompi_communicator_t *comm,
+                                  mca_coll_hier_module_t *module)
+{
+    int size = ompi_comm_size(comm), rank = ompi_comm_rank(comm);
+    int myinfo[2], *info = NULL, rc, err;
+    bool flat = true;
+
+    if (module->subcomms_ready) {
+        return !module->flat;
+    }
+    if (module->in_setup) {
+        /* creating the sub-communicators calls back into our collectives */
+        return false;
+    }
+
+    module->in_setup = true;
+    hier_creating_subcomms = true;
+
+    do {
+        /* allocate up front and agree on the outcome, so that a rank
+         * running out of memory does not leave the others waiting in
+         * the collectives below */
+        info = (int *) malloc(2 * size * sizeof(int));
+        module->node_leader = (int *) malloc(size * sizeof(int));
+        module->node_rank = (int *) malloc(size * sizeof(int));
+        rc = (NULL == info || NULL == module->node_leader || NULL == module->node_rank) ?
+            OMPI_ERR_OUT_OF_RESOURCE : OMPI_SUCCESS;
+        err = comm->c_coll->coll_allreduce(MPI_IN_PLACE, &rc, 1, MPI_INT, MPI_MIN, comm,
+                                           comm->c_coll->coll_allreduce_module);
+        if (OMPI_SUCCESS != err) {
+            rc = err;
+        }
+        if (OMPI_SUCCESS != rc) {
+            break;
+        }
+
+        rc = ompi_comm_split_type(comm, MPI_COMM_TYPE_SHARED, 0, NULL, &module->low_comm);
+        if (OMPI_SUCCESS != rc) {
+            break;
+        }
+
+        rc = ompi_comm_split(comm, (0 == ompi_comm_rank(module->low_comm)) ? 0 : MPI_UNDEFINED,
+                             rank, &module->up_comm, false);
+        if (OMPI_SUCCESS != rc) {
+            break;
+        }
+
+        /* every rank learns the rank of its node leader among the leaders ... */
+        myinfo[0] = (MPI_COMM_NULL != module->up_comm) ? ompi_comm_rank(module->up_comm) : -1;
+        rc = module->low_comm->c_coll->coll_bcast(myinfo, 1, MPI_INT, 0, module->low_comm,
+                                                  module->low_comm->c_coll->coll_bcast_module);
+        if (OMPI_SUCCESS != rc) {
+            break;
+        }
+        myinfo[1] = ompi_comm_rank(module->low_comm);
+
+        /* ... and the node layout of the whole communicator */
+        rc = comm->c_coll->coll_allgather(myinfo, 2, MPI_INT, info, 2, MPI_INT, comm,
+                                          comm->c_coll->coll_allgather_module);
+        if (OMPI_SUCCESS != rc) {
+            break;
+        }
+
+        for (int i = 0 ; i < size ; ++i) {
+            module->node_leader[i] = info[2 * i];
+            module->node_rank[i] = info[2 * i + 1];
+            if (0 != module->node_rank[i]) {
+                flat = false;
+            }
+        }
+
+        /* all the ranks on one node also makes a single level */
+        if (ompi_comm_size(module->low_comm) == size) {
+            flat = true;
+        }
+    } while (0);
+
+    free(info);
+
+    hier_creating_subcomms = false;
+    module->in_setup = false;
+    module->subcomms_ready = true;
+    module->flat = flat || OMPI_SUCCESS != rc;
+
+    if (module->flat) {
+        opal_output_verbose(10, ompi_coll_base_framework.framework_output,
+                            "coll:hier:subcomms_setup (%d/%s): communicator has a single level, falling back",
+                            comm->c_contextid, comm->c_name);
+    }
+
+    return !module->flat;
+}
+
+
+int mca_coll_hier_ft_event(int state)
+{
+    return OMPI_SUCCESS;
+}
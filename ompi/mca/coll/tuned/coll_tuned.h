@@ -42,10 +42,16 @@ extern int   ompi_coll_tuned_alltoall_intermediate_msg;
 extern int   ompi_coll_tuned_alltoall_large_msg;
 extern int   ompi_coll_tuned_alltoall_min_procs;
 extern int   ompi_coll_tuned_alltoall_max_requests;
+extern int   ompi_coll_tuned_alltoallv_sparse_min_procs;
+extern int   ompi_coll_tuned_alltoallv_sparse_density;
+extern int   ompi_coll_tuned_alltoallv_aggregate_max_msg;
 extern int   ompi_coll_tuned_scatter_intermediate_msg;
 extern int   ompi_coll_tuned_scatter_large_msg;
 extern int   ompi_coll_tuned_scatter_min_procs;
 extern int   ompi_coll_tuned_scatter_blocking_send_ratio;
+extern bool  ompi_coll_tuned_autotune;
+extern int   ompi_coll_tuned_autotune_trials;
+extern char* ompi_coll_tuned_autotune_rules_output;
 
 /* forced algorithm choices */
 /* this structure is for storing the indexes to the forced algorithm mca params... */
@@ -184,6 +190,31 @@ int ompi_coll_tuned_scan_intra_check_forced_init (coll_tuned_force_algorithm_mca
 
 int mca_coll_tuned_ft_event(int state);
 
+/* Online autotuning: while a (collective, message size bucket) pair is being
+ * tuned on a communicator every candidate algorithm runs for
+ * ompi_coll_tuned_autotune_trials calls, then all the ranks agree on the
+ * fastest one which is used from then on. The winners can be written as a
+ * dynamic rules file for later jobs. */
+#define COLL_TUNED_AUTOTUNE_MAX_CANDIDATES 16
+#define COLL_TUNED_AUTOTUNE_NUM_BUCKETS    42
+
+typedef struct coll_tuned_autotune_bucket_t {
+    int winner;        /* index of the chosen candidate, -1 while tuning */
+    int calls;         /* number of calls timed so far */
+    double time[COLL_TUNED_AUTOTUNE_MAX_CANDIDATES];
+} coll_tuned_autotune_bucket_t;
+
+typedef struct coll_tuned_autotune_t {
+    coll_tuned_autotune_bucket_t allreduce[COLL_TUNED_AUTOTUNE_NUM_BUCKETS];
+    coll_tuned_autotune_bucket_t bcast[COLL_TUNED_AUTOTUNE_NUM_BUCKETS];
+} coll_tuned_autotune_t;
+
+coll_tuned_autotune_t *ompi_coll_tuned_autotune_create(void);
+int ompi_coll_tuned_autotune_write_rules(const char *fname);
+void ompi_coll_tuned_autotune_finalize(void);
+int ompi_coll_tuned_allreduce_intra_dec_autotune(ALLREDUCE_ARGS);
+int ompi_coll_tuned_bcast_intra_dec_autotune(BCAST_ARGS);
+
 struct mca_coll_tuned_component_t {
 	/** Base coll component */
 	mca_coll_base_component_2_0_0_t super;
@@ -217,6 +248,12 @@ struct mca_coll_tuned_module_t {
 
     /* the communicator rules for each MPI collective for ONLY my comsize */
     ompi_coll_com_rule_t *com_rules[COLLCOUNT];
+
+    /* memo of the rule lookups for each collective that has com rules */
+    ompi_coll_tuned_decision_cache_t *decision_cache[COLLCOUNT];
+
+    /* online autotuning state, NULL unless autotuning is enabled */
+    coll_tuned_autotune_t *autotune;
 };
 typedef struct mca_coll_tuned_module_t mca_coll_tuned_module_t;
 OBJ_CLASS_DECLARATION(mca_coll_tuned_module_t);
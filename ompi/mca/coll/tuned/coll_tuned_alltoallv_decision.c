@@ -33,6 +33,8 @@ static mca_base_var_enum_value_t alltoallv_algorithms[] = {
     {0, "ignore"},
     {1, "basic_linear"},
     {2, "pairwise"},
+    {3, "sparse"},
+    {4, "sparse_node"},
     {0, NULL}
 };
 
@@ -71,7 +73,8 @@ int ompi_coll_tuned_alltoallv_intra_check_forced_init(coll_tuned_force_algorithm
                                         "alltoallv_algorithm",
                                         "Which alltoallv algorithm is used. "
                                         "Can be locked down to choice of: 0 ignore, "
-                                        "1 basic linear, 2 pairwise.",
+                                        "1 basic linear, 2 pairwise, 3 sparse, "
+                                        "4 sparse with small messages aggregated per node.",
                                         MCA_BASE_VAR_TYPE_INT, new_enum, 0, MCA_BASE_VAR_FLAG_SETTABLE,
                                         OPAL_INFO_LVL_5,
                                         MCA_BASE_VAR_SCOPE_ALL,
@@ -82,6 +85,38 @@ int ompi_coll_tuned_alltoallv_intra_check_forced_init(coll_tuned_force_algorithm
         return mca_param_indices->algorithm_param_index;
     }
 
+    ompi_coll_tuned_alltoallv_sparse_min_procs = 0;
+    (void) mca_base_component_var_register(&mca_coll_tuned_component.super.collm_version,
+                                           "alltoallv_sparse_min_procs",
+                                           "Smallest communicator on which alltoallv looks at the density of "
+                                           "the counts to choose a sparse algorithm. Looking costs a scan of "
+                                           "the counts and an allreduce in every alltoallv (default: 0, never)",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                           OPAL_INFO_LVL_6,
+                                           MCA_BASE_VAR_SCOPE_ALL_EQ,
+                                           &ompi_coll_tuned_alltoallv_sparse_min_procs);
+
+    ompi_coll_tuned_alltoallv_sparse_density = 10;
+    (void) mca_base_component_var_register(&mca_coll_tuned_component.super.collm_version,
+                                           "alltoallv_sparse_density",
+                                           "Use a sparse alltoallv algorithm when no process exchanges data "
+                                           "with more than this percentage of the peers",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                           OPAL_INFO_LVL_6,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &ompi_coll_tuned_alltoallv_sparse_density);
+
+    ompi_coll_tuned_alltoallv_aggregate_max_msg = 1024;
+    (void) mca_base_component_var_register(&mca_coll_tuned_component.super.collm_version,
+                                           "alltoallv_aggregate_max_msg",
+                                           "Largest message in bytes a sparse alltoallv routes through the node "
+                                           "leaders, aggregated with the other messages between the two nodes. "
+                                           "The sparse algorithm aggregates when no message is larger (0 never does)",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                           OPAL_INFO_LVL_6,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &ompi_coll_tuned_alltoallv_aggregate_max_msg);
+
     return (MPI_SUCCESS);
 }
 
@@ -112,6 +147,15 @@ int ompi_coll_tuned_alltoallv_intra_do_this(const void *sbuf, const int *scounts
         return ompi_coll_base_alltoallv_intra_pairwise(sbuf, scounts, sdisps, sdtype,
                                                        rbuf, rcounts, rdisps, rdtype,
                                                        comm, module);
+    case (3):
+        return ompi_coll_base_alltoallv_intra_sparse(sbuf, scounts, sdisps, sdtype,
+                                                     rbuf, rcounts, rdisps, rdtype,
+                                                     comm, module);
+    case (4):
+        return ompi_coll_base_alltoallv_intra_sparse_node(sbuf, scounts, sdisps, sdtype,
+                                                          rbuf, rcounts, rdisps, rdtype,
+                                                          comm, module,
+                                                          ompi_coll_tuned_alltoallv_aggregate_max_msg);
     }  /* switch */
     OPAL_OUTPUT((ompi_coll_tuned_stream,
                  "coll:tuned:alltoall_intra_do_this attempt to select "
@@ -0,0 +1,382 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mpi.h"
+#include "opal/mca/timer/base/base.h"
+#include "opal/threads/mutex.h"
+#include "ompi/constants.h"
+#include "ompi/communicator/communicator.h"
+#include "ompi/datatype/ompi_datatype.h"
+#include "ompi/op/op.h"
+#include "ompi/mca/coll/base/coll_base_functions.h"
+#include "ompi/runtime/ompi_rte.h"
+#include "coll_tuned.h"
+
+/*
+ * Online autotuning of the algorithm choice.
+ *
+ * Message sizes are grouped in power of two buckets: bucket 0 holds the
+ * empty messages and bucket b the messages of [2^(b-1), 2^b) bytes. The
+ * first calls of a bucket on a communicator cycle through the candidate
+ * algorithms, each one being timed for ompi_coll_tuned_autotune_trials
+ * calls. The ranks then take the maximum of their timings, so they all
+ * pick the same winner, and use it for the rest of the communicator life.
+ */
+
+typedef struct coll_tuned_autotune_candidate_t {
+    int algorithm;
+    int faninout;
+    int segsize;
+} coll_tuned_autotune_candidate_t;
+
+static const coll_tuned_autotune_candidate_t allreduce_candidates[] = {
+    { 3, 0, 0 },        /* recursive doubling */
+    { 4, 0, 0 },        /* ring */
+    { 5, 0, 32768 },    /* segmented ring */
+    { 5, 0, 131072 },
+    { 6, 0, 0 },        /* reduce-scatter + allgather */
+    { 2, 0, 0 },        /* reduce + bcast */
+};
+#define NUM_ALLREDUCE_CANDIDATES (int) (sizeof(allreduce_candidates) / sizeof(allreduce_candidates[0]))
+
+/* a zero chain fanout stands for ompi_coll_tuned_init_chain_fanout */
+static const coll_tuned_autotune_candidate_t bcast_candidates[] = {
+    { 6, 0, 0 },        /* binomial */
+    { 7, 0, 0 },        /* knomial */
+    { 6, 0, 8192 },     /* segmented binomial */
+    { 5, 0, 8192 },     /* binary tree */
+    { 4, 0, 8192 },     /* split binary tree */
+    { 3, 0, 131072 },   /* pipeline */
+    { 2, 0, 65536 },    /* chain */
+    { 8, 0, 0 },        /* scatter + recursive doubling allgather */
+    { 9, 0, 0 },        /* scatter + ring allgather */
+};
+#define NUM_BCAST_CANDIDATES (int) (sizeof(bcast_candidates) / sizeof(bcast_candidates[0]))
+
+/* The decisions taken during the job, kept for the rules file. A later
+ * decision for the same collective, communicator size and bucket replaces
+ * the earlier one. */
+typedef struct coll_tuned_autotune_result_t {
+    int coll;
+    int comsize;
+    int bucket;
+    coll_tuned_autotune_candidate_t choice;
+} coll_tuned_autotune_result_t;
+
+static opal_mutex_t autotune_lock = OPAL_MUTEX_STATIC_INIT;
+static coll_tuned_autotune_result_t *autotune_results = NULL;
+static int autotune_num_results = 0;
+static int autotune_max_results = 0;
+
+
+coll_tuned_autotune_t *ompi_coll_tuned_autotune_create(void)
+{
+    coll_tuned_autotune_t *at;
+
+    at = (coll_tuned_autotune_t *) calloc(1, sizeof(coll_tuned_autotune_t));
+    if (NULL == at) {
+        return NULL;
+    }
+    for (int b = 0 ; b < COLL_TUNED_AUTOTUNE_NUM_BUCKETS ; ++b) {
+        at->allreduce[b].winner = -1;
+        at->bcast[b].winner = -1;
+    }
+    return at;
+}
+
+static int autotune_bucket(size_t bytes)
+{
+    int b = 0;
+
+    while (0 != bytes && b < COLL_TUNED_AUTOTUNE_NUM_BUCKETS - 1) {
+        bytes >>= 1;
+        ++b;
+    }
+    return b;
+}
+
+static size_t autotune_bucket_start(int bucket)
+{
+    return (0 == bucket) ? 0 : ((size_t) 1) << (bucket - 1);
+}
+
+static void autotune_record(int coll, int comsize, int bucket,
+                            const coll_tuned_autotune_candidate_t *choice)
+{
+    coll_tuned_autotune_result_t *res = NULL;
+
+    OPAL_THREAD_LOCK(&autotune_lock);
+    for (int i = 0 ; i < autotune_num_results ; ++i) {
+        if (autotune_results[i].coll == coll && autotune_results[i].comsize == comsize &&
+            autotune_results[i].bucket == bucket) {
+            res = autotune_results + i;
+            break;
+        }
+    }
+    if (NULL == res) {
+        if (autotune_num_results == autotune_max_results) {
+            int max = (0 == autotune_max_results) ? 32 : 2 * autotune_max_results;
+            void *tmp = realloc(autotune_results, max * sizeof(coll_tuned_autotune_result_t));
+            if (NULL == tmp) {
+                OPAL_THREAD_UNLOCK(&autotune_lock);
+                return;
+            }
+            autotune_results = (coll_tuned_autotune_result_t *) tmp;
+            autotune_max_results = max;
+        }
+        res = autotune_results + autotune_num_results++;
+        res->coll = coll;
+        res->comsize = comsize;
+        res->bucket = bucket;
+    }
+    res->choice = *choice;
+    OPAL_THREAD_UNLOCK(&autotune_lock);
+}
+
+/*
+ * Pick the candidate to run for this call. Once every candidate ran its
+ * trials the ranks agree on the fastest one. The agreement is itself a
+ * collective, but every rank reaches it on the same call as the bucket
+ * only depends on the message signature.
+ */
+static int autotune_select(coll_tuned_autotune_bucket_t *bucket, int num_candidates,
+                           const coll_tuned_autotune_candidate_t *candidates,
+                           int coll, int bucket_index,
+                           struct ompi_communicator_t *comm,
+                           mca_coll_base_module_t *module)
+{
+    int trials = (ompi_coll_tuned_autotune_trials > 0) ? ompi_coll_tuned_autotune_trials : 1;
+    coll_tuned_autotune_candidate_t choice;
+    int err, best = 0;
+
+    if (bucket->calls < num_candidates * trials) {
+        return bucket->calls / trials;
+    }
+
+    err = ompi_coll_base_allreduce_intra_recursivedoubling(MPI_IN_PLACE, bucket->time, num_candidates,
+                                                           MPI_DOUBLE, MPI_MAX, comm, module);
+    if (OMPI_SUCCESS != err) {
+        /* keep the first candidate rather than tuning again */
+        bucket->winner = 0;
+        return 0;
+    }
+
+    for (int i = 1 ; i < num_candidates ; ++i) {
+        if (bucket->time[i] < bucket->time[best]) {
+            best = i;
+        }
+    }
+    bucket->winner = best;
+
+    OPAL_OUTPUT_VERBOSE((10, ompi_coll_tuned_stream,
+                         "coll:tuned:autotune (%d/%s) coll %d bucket %d: algorithm %d segsize %d",
+                         comm->c_contextid, comm->c_name, coll, bucket_index,
+                         candidates[best].algorithm, candidates[best].segsize));
+
+    choice = candidates[best];
+    if (BCAST == coll && 2 == choice.algorithm) {
+        choice.faninout = ompi_coll_tuned_init_chain_fanout;
+    }
+    autotune_record(coll, ompi_comm_size(comm), bucket_index, &choice);
+
+    return best;
+}
+
+int ompi_coll_tuned_allreduce_intra_dec_autotune(const void *sbuf, void *rbuf, int count,
+                                                 struct ompi_datatype_t *dtype,
+                                                 struct ompi_op_t *op,
+                                                 struct ompi_communicator_t *comm,
+                                                 mca_coll_base_module_t *module)
+{
+    mca_coll_tuned_module_t *tuned_module = (mca_coll_tuned_module_t *) module;
+    coll_tuned_autotune_bucket_t *bucket;
+    const coll_tuned_autotune_candidate_t *cand;
+    size_t dsize;
+    opal_timer_t start;
+    int b, c, err;
+
+    /* most candidates need a commutative operation, leave the others to
+     * the fixed rules */
+    if (!ompi_op_is_commute(op)) {
+        return ompi_coll_tuned_allreduce_intra_dec_fixed(sbuf, rbuf, count, dtype, op, comm, module);
+    }
+
+    ompi_datatype_type_size(dtype, &dsize);
+    b = autotune_bucket(dsize * (size_t) count);
+    bucket = &tuned_module->autotune->allreduce[b];
+
+    c = bucket->winner;
+    if (c < 0) {
+        c = autotune_select(bucket, NUM_ALLREDUCE_CANDIDATES, allreduce_candidates,
+                            ALLREDUCE, b, comm, module);
+    }
+    cand = allreduce_candidates + c;
+
+    if (bucket->winner >= 0) {
+        return ompi_coll_tuned_allreduce_intra_do_this(sbuf, rbuf, count, dtype, op, comm, module,
+                                                       cand->algorithm, cand->faninout, cand->segsize);
+    }
+
+    start = opal_timer_base_get_usec();
+    err = ompi_coll_tuned_allreduce_intra_do_this(sbuf, rbuf, count, dtype, op, comm, module,
+                                                  cand->algorithm, cand->faninout, cand->segsize);
+    bucket->time[c] += (double) (opal_timer_base_get_usec() - start);
+    bucket->calls++;
+
+    return err;
+}
+
+int ompi_coll_tuned_bcast_intra_dec_autotune(void *buf, int count,
+                                             struct ompi_datatype_t *dtype, int root,
+                                             struct ompi_communicator_t *comm,
+                                             mca_coll_base_module_t *module)
+{
+    mca_coll_tuned_module_t *tuned_module = (mca_coll_tuned_module_t *) module;
+    coll_tuned_autotune_bucket_t *bucket;
+    const coll_tuned_autotune_candidate_t *cand;
+    size_t dsize;
+    opal_timer_t start;
+    int b, c, err, faninout;
+
+    ompi_datatype_type_size(dtype, &dsize);
+    b = autotune_bucket(dsize * (size_t) count);
+    bucket = &tuned_module->autotune->bcast[b];
+
+    c = bucket->winner;
+    if (c < 0) {
+        c = autotune_select(bucket, NUM_BCAST_CANDIDATES, bcast_candidates,
+                            BCAST, b, comm, module);
+    }
+    cand = bcast_candidates + c;
+    faninout = (2 == cand->algorithm) ? ompi_coll_tuned_init_chain_fanout : cand->faninout;
+
+    if (bucket->winner >= 0) {
+        return ompi_coll_tuned_bcast_intra_do_this(buf, count, dtype, root, comm, module,
+                                                   cand->algorithm, faninout, cand->segsize);
+    }
+
+    start = opal_timer_base_get_usec();
+    err = ompi_coll_tuned_bcast_intra_do_this(buf, count, dtype, root, comm, module,
+                                              cand->algorithm, faninout, cand->segsize);
+    bucket->time[c] += (double) (opal_timer_base_get_usec() - start);
+    bucket->calls++;
+
+    return err;
+}
+
+static int autotune_result_cmp(const void *a, const void *b)
+{
+    const coll_tuned_autotune_result_t *ra = (const coll_tuned_autotune_result_t *) a;
+    const coll_tuned_autotune_result_t *rb = (const coll_tuned_autotune_result_t *) b;
+
+    if (ra->coll != rb->coll) {
+        return ra->coll - rb->coll;
+    }
+    if (ra->comsize != rb->comsize) {
+        return ra->comsize - rb->comsize;
+    }
+    return ra->bucket - rb->bucket;
+}
+
+/*
+ * Write the decisions in the format read by
+ * ompi_coll_tuned_read_rules_config_file(), so that a later job can use
+ * them with coll_tuned_use_dynamic_rules and coll_tuned_dynamic_rules_filename.
+ * Only the decisions taken by this process are written.
+ */
+int ompi_coll_tuned_autotune_write_rules(const char *fname)
+{
+    coll_tuned_autotune_result_t *res;
+    int ncoll = 0, i, j, k, n;
+    FILE *fptr;
+
+    if (NULL == fname || 0 == autotune_num_results) {
+        return OMPI_SUCCESS;
+    }
+
+    fptr = fopen(fname, "w");
+    if (NULL == fptr) {
+        OPAL_OUTPUT((ompi_coll_tuned_stream, "coll:tuned:autotune cannot write rules file [%s]", fname));
+        return OMPI_ERR_FILE_OPEN_FAILURE;
+    }
+
+    res = autotune_results;
+    n = autotune_num_results;
+    qsort(res, n, sizeof(coll_tuned_autotune_result_t), autotune_result_cmp);
+
+    for (i = 0 ; i < n ; ++i) {
+        if (0 == i || res[i].coll != res[i - 1].coll) {
+            ++ncoll;
+        }
+    }
+
+    fprintf(fptr, "# Collective rules written by the coll/tuned autotuner\n");
+    fprintf(fptr, "%d # number of collectives\n", ncoll);
+
+    for (i = 0 ; i < n ; i = j) {
+        int ncs = 0;
+
+        for (j = i ; j < n && res[j].coll == res[i].coll ; ++j) {
+            if (j == i || res[j].comsize != res[j - 1].comsize) {
+                ++ncs;
+            }
+        }
+        fprintf(fptr, "%d # collective id\n", res[i].coll);
+        fprintf(fptr, "%d # number of communicator sizes\n", ncs);
+
+        for (k = i ; k < j ; ) {
+            int l, nms = 0;
+
+            /* adjacent buckets with the same choice make a single rule */
+            for (l = k ; l < j && res[l].comsize == res[k].comsize ; ++l) {
+                if (l == k || 0 != memcmp(&res[l].choice, &res[l - 1].choice, sizeof(res[l].choice))) {
+                    ++nms;
+                }
+            }
+            fprintf(fptr, "%d # communicator size\n", res[k].comsize);
+            fprintf(fptr, "%d # number of message sizes\n", nms);
+
+            for (int m = k ; m < l ; ++m) {
+                if (m != k && 0 == memcmp(&res[m].choice, &res[m - 1].choice, sizeof(res[m].choice))) {
+                    continue;
+                }
+                /* the rules must start at message size zero */
+                fprintf(fptr, "%lu %d %d %d # message size, algorithm, fan in/out, segment size\n",
+                        (m == k) ? 0UL : (unsigned long) autotune_bucket_start(res[m].bucket),
+                        res[m].choice.algorithm, res[m].choice.faninout, res[m].choice.segsize);
+            }
+            k = l;
+        }
+    }
+
+    fclose(fptr);
+
+    OPAL_OUTPUT((ompi_coll_tuned_stream, "coll:tuned:autotune wrote %d decisions to [%s]", n, fname));
+    return OMPI_SUCCESS;
+}
+
+void ompi_coll_tuned_autotune_finalize(void)
+{
+    /* the rules of the communicators it belongs to are written by the
+     * first process of the job */
+    if (NULL != ompi_coll_tuned_autotune_rules_output && 0 == OMPI_PROC_MY_NAME->vpid) {
+        (void) ompi_coll_tuned_autotune_write_rules(ompi_coll_tuned_autotune_rules_output);
+    }
+
+    free(autotune_results);
+    autotune_results = NULL;
+    autotune_num_results = 0;
+    autotune_max_results = 0;
+}
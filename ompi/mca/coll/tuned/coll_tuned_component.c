@@ -65,12 +65,24 @@ int   ompi_coll_tuned_alltoall_large_msg = 3000;
 int   ompi_coll_tuned_alltoall_min_procs = 0; /* disable by default */
 int   ompi_coll_tuned_alltoall_max_requests  = 0; /* no limit for alltoall by default */
 
+/* alltoallv switches to the sparse algorithms on communicators of at least
+ * sparse_min_procs processes where each process exchanges data with at most
+ * sparse_density percent of the peers */
+int   ompi_coll_tuned_alltoallv_sparse_min_procs = 0; /* disable by default */
+int   ompi_coll_tuned_alltoallv_sparse_density = 10;
+int   ompi_coll_tuned_alltoallv_aggregate_max_msg = 1024;
+
 /* Disable by default */
 int   ompi_coll_tuned_scatter_intermediate_msg = 0;
 int   ompi_coll_tuned_scatter_large_msg = 0;
 int   ompi_coll_tuned_scatter_min_procs = 0;
 int   ompi_coll_tuned_scatter_blocking_send_ratio = 0;
 
+/* online autotuning, disabled by default */
+bool  ompi_coll_tuned_autotune = false;
+int   ompi_coll_tuned_autotune_trials = 3;
+char* ompi_coll_tuned_autotune_rules_output = (char*) NULL;
+
 /* forced alogrithm variables */
 /* indices for the MCA parameters */
 coll_tuned_force_algorithm_mca_param_indices_t ompi_coll_tuned_forced_params[COLLCOUNT] = {{0}};
@@ -191,6 +203,33 @@ static int tuned_register(void)
                                            MCA_BASE_VAR_SCOPE_READONLY,
                                            &ompi_coll_tuned_dynamic_rules_filename);
 
+    ompi_coll_tuned_autotune = false;
+    (void) mca_base_component_var_register(&mca_coll_tuned_component.super.collm_version,
+                                           "autotune",
+                                           "Select the allreduce and bcast algorithms at runtime by timing the candidate algorithms on the first calls of each communicator and message size range. Forced algorithms and dynamic rules matching the communicator size take precedence",
+                                           MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0,
+                                           OPAL_INFO_LVL_6,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &ompi_coll_tuned_autotune);
+
+    ompi_coll_tuned_autotune_trials = 3;
+    (void) mca_base_component_var_register(&mca_coll_tuned_component.super.collm_version,
+                                           "autotune_trials",
+                                           "Number of calls each candidate algorithm is timed for when autotuning",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                           OPAL_INFO_LVL_6,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &ompi_coll_tuned_autotune_trials);
+
+    ompi_coll_tuned_autotune_rules_output = NULL;
+    (void) mca_base_component_var_register(&mca_coll_tuned_component.super.collm_version,
+                                           "autotune_rules_output",
+                                           "Filename the first process writes the autotuned decisions to at finalize, in the format of dynamic_rules_filename",
+                                           MCA_BASE_VAR_TYPE_STRING, NULL, 0, 0,
+                                           OPAL_INFO_LVL_6,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &ompi_coll_tuned_autotune_rules_output);
+
     /* register forced params */
     ompi_coll_tuned_allreduce_intra_check_forced_init(&ompi_coll_tuned_forced_params[ALLREDUCE]);
     ompi_coll_tuned_alltoall_intra_check_forced_init(&ompi_coll_tuned_forced_params[ALLTOALL]);
@@ -274,6 +313,10 @@ static int tuned_close(void)
         mca_coll_tuned_component.all_base_rules = NULL;
     }
 
+    if (ompi_coll_tuned_autotune) {
+        ompi_coll_tuned_autotune_finalize();
+    }
+
     return OMPI_SUCCESS;
 }
 
@@ -285,8 +328,21 @@ mca_coll_tuned_module_construct(mca_coll_tuned_module_t *module)
     for( int i = 0; i < COLLCOUNT; i++ ) {
         tuned_module->user_forced[i].algorithm = 0;
         tuned_module->com_rules[i] = NULL;
+        tuned_module->decision_cache[i] = NULL;
+    }
+    tuned_module->autotune = NULL;
+}
+
+static void
+mca_coll_tuned_module_destruct(mca_coll_tuned_module_t *module)
+{
+    for( int i = 0; i < COLLCOUNT; i++ ) {
+        free(module->decision_cache[i]);
+        module->decision_cache[i] = NULL;
     }
+    free(module->autotune);
+    module->autotune = NULL;
 }
 
 OBJ_CLASS_INSTANCE(mca_coll_tuned_module_t, mca_coll_base_module_t,
-                   mca_coll_tuned_module_construct, NULL);
+                   mca_coll_tuned_module_construct, mca_coll_tuned_module_destruct);
@@ -69,7 +69,8 @@ ompi_coll_tuned_allreduce_intra_dec_dynamic (const void *sbuf, void *rbuf, int c
         ompi_datatype_type_size (dtype, &dsize);
         dsize *= count;
 
-        alg = ompi_coll_tuned_get_target_method_params (tuned_module->com_rules[ALLREDUCE],
+        alg = ompi_coll_tuned_get_cached_method_params (tuned_module->com_rules[ALLREDUCE],
+                                                        tuned_module->decision_cache[ALLREDUCE],
                                                         dsize, &faninout, &segsize, &ignoreme);
 
         if (alg) {
@@ -120,7 +121,8 @@ int ompi_coll_tuned_alltoall_intra_dec_dynamic(const void *sbuf, int scount,
         comsize = ompi_comm_size(comm);
         dsize *= (ptrdiff_t)comsize * (ptrdiff_t)scount;
 
-        alg = ompi_coll_tuned_get_target_method_params (tuned_module->com_rules[ALLTOALL],
+        alg = ompi_coll_tuned_get_cached_method_params (tuned_module->com_rules[ALLTOALL],
+                                                        tuned_module->decision_cache[ALLTOALL],
                                                         dsize, &faninout, &segsize, &max_requests);
 
         if (alg) {
@@ -172,7 +174,8 @@ int ompi_coll_tuned_alltoallv_intra_dec_dynamic(const void *sbuf, const int *sco
     if (tuned_module->com_rules[ALLTOALLV]) {
         int alg, faninout, segsize, max_requests;
 
-        alg = ompi_coll_tuned_get_target_method_params (tuned_module->com_rules[ALLTOALLV],
+        alg = ompi_coll_tuned_get_cached_method_params (tuned_module->com_rules[ALLTOALLV],
+                                                        tuned_module->decision_cache[ALLTOALLV],
                                                         0, &faninout, &segsize, &max_requests);
 
         if (alg) {
@@ -214,7 +217,8 @@ int ompi_coll_tuned_barrier_intra_dec_dynamic(struct ompi_communicator_t *comm,
         /* we do, so calc the message size or what ever we need and use this for the evaluation */
         int alg, faninout, segsize, ignoreme;
 
-        alg = ompi_coll_tuned_get_target_method_params (tuned_module->com_rules[BARRIER],
+        alg = ompi_coll_tuned_get_cached_method_params (tuned_module->com_rules[BARRIER],
+                                                        tuned_module->decision_cache[BARRIER],
                                                         0, &faninout, &segsize, &ignoreme);
 
         if (alg) {
@@ -258,7 +262,8 @@ int ompi_coll_tuned_bcast_intra_dec_dynamic(void *buf, int count,
         ompi_datatype_type_size (dtype, &dsize);
         dsize *= count;
 
-        alg = ompi_coll_tuned_get_target_method_params (tuned_module->com_rules[BCAST],
+        alg = ompi_coll_tuned_get_cached_method_params (tuned_module->com_rules[BCAST],
+                                                        tuned_module->decision_cache[BCAST],
                                                         dsize, &faninout, &segsize, &ignoreme);
 
         if (alg) {
@@ -309,7 +314,8 @@ int ompi_coll_tuned_reduce_intra_dec_dynamic( const void *sbuf, void *rbuf,
         ompi_datatype_type_size(dtype, &dsize);
         dsize *= count;
 
-        alg = ompi_coll_tuned_get_target_method_params (tuned_module->com_rules[REDUCE],
+        alg = ompi_coll_tuned_get_cached_method_params (tuned_module->com_rules[REDUCE],
+                                                        tuned_module->decision_cache[REDUCE],
                                                         dsize, &faninout, &segsize, &max_requests);
 
         if (alg) {
@@ -364,7 +370,8 @@ int ompi_coll_tuned_reduce_scatter_intra_dec_dynamic(const void *sbuf, void *rbu
         ompi_datatype_type_size (dtype, &dsize);
         dsize *= count;
 
-        alg = ompi_coll_tuned_get_target_method_params (tuned_module->com_rules[REDUCESCATTER],
+        alg = ompi_coll_tuned_get_cached_method_params (tuned_module->com_rules[REDUCESCATTER],
+                                                        tuned_module->decision_cache[REDUCESCATTER],
                                                         dsize, &faninout,
                                                         &segsize, &ignoreme);
         if (alg) {
@@ -416,7 +423,8 @@ int ompi_coll_tuned_reduce_scatter_block_intra_dec_dynamic(const void *sbuf, voi
         ompi_datatype_type_size (dtype, &dsize);
         dsize *= rcount * size;
 
-        alg = ompi_coll_tuned_get_target_method_params(tuned_module->com_rules[REDUCESCATTERBLOCK],
+        alg = ompi_coll_tuned_get_cached_method_params(tuned_module->com_rules[REDUCESCATTERBLOCK],
+                                                       tuned_module->decision_cache[REDUCESCATTERBLOCK],
                                                        dsize, &faninout,
                                                        &segsize, &ignoreme);
         if (alg) {
@@ -470,7 +478,8 @@ int ompi_coll_tuned_allgather_intra_dec_dynamic(const void *sbuf, int scount,
         comsize = ompi_comm_size(comm);
         dsize *= (ptrdiff_t)comsize * (ptrdiff_t)scount;
 
-        alg = ompi_coll_tuned_get_target_method_params (tuned_module->com_rules[ALLGATHER],
+        alg = ompi_coll_tuned_get_cached_method_params (tuned_module->com_rules[ALLGATHER],
+                                                        tuned_module->decision_cache[ALLGATHER],
                                                         dsize, &faninout, &segsize, &ignoreme);
         if (alg) {
             /* we have found a valid choice from the file based rules for
@@ -533,7 +542,8 @@ int ompi_coll_tuned_allgatherv_intra_dec_dynamic(const void *sbuf, int scount,
         total_size = 0;
         for (i = 0; i < comsize; i++) { total_size += dsize * rcounts[i]; }
 
-        alg = ompi_coll_tuned_get_target_method_params (tuned_module->com_rules[ALLGATHERV],
+        alg = ompi_coll_tuned_get_cached_method_params (tuned_module->com_rules[ALLGATHERV],
+                                                        tuned_module->decision_cache[ALLGATHERV],
                                                         total_size, &faninout, &segsize, &ignoreme);
         if (alg) {
             /* we have found a valid choice from the file based rules for
@@ -588,7 +598,8 @@ int ompi_coll_tuned_gather_intra_dec_dynamic(const void *sbuf, int scount,
         ompi_datatype_type_size (sdtype, &dsize);
         dsize *= comsize;
 
-        alg = ompi_coll_tuned_get_target_method_params (tuned_module->com_rules[GATHER],
+        alg = ompi_coll_tuned_get_cached_method_params (tuned_module->com_rules[GATHER],
+                                                        tuned_module->decision_cache[GATHER],
                                                         dsize, &faninout, &segsize, &max_requests);
 
         if (alg) {
@@ -637,7 +648,8 @@ int ompi_coll_tuned_scatter_intra_dec_dynamic(const void *sbuf, int scount,
         ompi_datatype_type_size (sdtype, &dsize);
         dsize *= comsize;
 
-        alg = ompi_coll_tuned_get_target_method_params (tuned_module->com_rules[SCATTER],
+        alg = ompi_coll_tuned_get_cached_method_params (tuned_module->com_rules[SCATTER],
+                                                        tuned_module->decision_cache[SCATTER],
                                                         dsize, &faninout, &segsize, &max_requests);
 
         if (alg) {
@@ -685,7 +697,8 @@ int ompi_coll_tuned_exscan_intra_dec_dynamic(const void *sbuf, void* rbuf, int c
         ompi_datatype_type_size (dtype, &dsize);
         dsize *= comsize;
 
-        alg = ompi_coll_tuned_get_target_method_params (tuned_module->com_rules[EXSCAN],
+        alg = ompi_coll_tuned_get_cached_method_params (tuned_module->com_rules[EXSCAN],
+                                                        tuned_module->decision_cache[EXSCAN],
                                                         dsize, &faninout, &segsize, &max_requests);
 
         if (alg) {
@@ -728,7 +741,8 @@ int ompi_coll_tuned_scan_intra_dec_dynamic(const void *sbuf, void* rbuf, int cou
         ompi_datatype_type_size (dtype, &dsize);
         dsize *= comsize;
 
-        alg = ompi_coll_tuned_get_target_method_params (tuned_module->com_rules[SCAN],
+        alg = ompi_coll_tuned_get_cached_method_params (tuned_module->com_rules[SCAN],
+                                                        tuned_module->decision_cache[SCAN],
                                                         dsize, &faninout, &segsize, &max_requests);
 
         if (alg) {
@@ -181,10 +181,59 @@ int ompi_coll_tuned_alltoallv_intra_dec_fixed(const void *sbuf, const int *scoun
                                               struct ompi_communicator_t *comm,
                                               mca_coll_base_module_t *module)
 {
-    /* For starters, just keep the original algorithm. */
-    return ompi_coll_base_alltoallv_intra_pairwise(sbuf, scounts, sdisps, sdtype,
-                                                   rbuf, rcounts, rdisps,rdtype,
-                                                   comm, module);
+    int communicator_size = ompi_comm_size(comm), rank = ompi_comm_rank(comm);
+    int local[2] = {0, 0}, global[2], nsend = 0, nrecv = 0, err;
+    size_t sdsize, rdsize, bytes;
+
+    /* The sparse algorithms only post the messages that carry data, so
+     * all the processes have to use them together. Agree on the densest
+     * process and on the largest message before choosing. */
+    if (MPI_IN_PLACE == sbuf || 0 >= ompi_coll_tuned_alltoallv_sparse_min_procs ||
+        communicator_size < ompi_coll_tuned_alltoallv_sparse_min_procs) {
+        return ompi_coll_base_alltoallv_intra_pairwise(sbuf, scounts, sdisps, sdtype,
+                                                       rbuf, rcounts, rdisps,rdtype,
+                                                       comm, module);
+    }
+
+    ompi_datatype_type_size(sdtype, &sdsize);
+    ompi_datatype_type_size(rdtype, &rdsize);
+    for (int i = 0; i < communicator_size; ++i) {
+        if (i == rank) {
+            continue;
+        }
+        bytes = (size_t) scounts[i] * sdsize;
+        if (0 != bytes) {
+            ++nsend;
+            if (bytes > (size_t) local[1]) local[1] = (bytes > INT_MAX) ? INT_MAX : (int) bytes;
+        }
+        bytes = (size_t) rcounts[i] * rdsize;
+        if (0 != bytes) {
+            ++nrecv;
+            if (bytes > (size_t) local[1]) local[1] = (bytes > INT_MAX) ? INT_MAX : (int) bytes;
+        }
+    }
+    local[0] = (nsend > nrecv) ? nsend : nrecv;
+
+    err = comm->c_coll->coll_allreduce(local, global, 2, MPI_INT, MPI_MAX, comm,
+                                       comm->c_coll->coll_allreduce_module);
+    if (MPI_SUCCESS != err) {
+        return err;
+    }
+
+    if ((int64_t) global[0] * 100 > (int64_t) ompi_coll_tuned_alltoallv_sparse_density * communicator_size) {
+        return ompi_coll_base_alltoallv_intra_pairwise(sbuf, scounts, sdisps, sdtype,
+                                                       rbuf, rcounts, rdisps,rdtype,
+                                                       comm, module);
+    }
+    if (0 < global[1] && global[1] <= ompi_coll_tuned_alltoallv_aggregate_max_msg) {
+        return ompi_coll_base_alltoallv_intra_sparse_node(sbuf, scounts, sdisps, sdtype,
+                                                          rbuf, rcounts, rdisps, rdtype,
+                                                          comm, module,
+                                                          ompi_coll_tuned_alltoallv_aggregate_max_msg);
+    }
+    return ompi_coll_base_alltoallv_intra_sparse(sbuf, scounts, sdisps, sdtype,
+                                                 rbuf, rcounts, rdisps, rdtype,
+                                                 comm, module);
 }
 
 
@@ -34,6 +34,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdint.h>
 
 #include "ompi/mca/coll/base/coll_base_util.h"
 
@@ -389,3 +390,59 @@ int ompi_coll_tuned_get_target_method_params (ompi_coll_com_rule_t* base_com_rul
     /* return the algorithm/method to use */
     return (best_msg_p->result_alg);
 }
+
+
+ompi_coll_tuned_decision_cache_t* ompi_coll_tuned_mk_decision_cache (void)
+{
+    ompi_coll_tuned_decision_cache_t* cache;
+    int i;
+
+    cache = (ompi_coll_tuned_decision_cache_t*) malloc (sizeof (ompi_coll_tuned_decision_cache_t));
+    if (!cache) {
+        return cache;
+    }
+    for (i = 0; i < COLL_TUNED_DECISION_CACHE_SIZE; i++) {
+        cache->entries[i].msg_size = SIZE_MAX;
+    }
+    return (cache);
+}
+
+/*
+ * Same as ompi_coll_tuned_get_target_method_params() but remembers the
+ * answer, so that a loop of calls with the same message size walks the
+ * message rules only once.
+ */
+int ompi_coll_tuned_get_cached_method_params (ompi_coll_com_rule_t* base_com_rule,
+                                              ompi_coll_tuned_decision_cache_t* cache,
+                                              size_t mpi_msgsize,
+                                              int* result_topo_faninout, int* result_segsize,
+                                              int* max_requests)
+{
+    ompi_coll_tuned_decision_t* entry;
+    size_t size = mpi_msgsize;
+    int idx = 0;
+
+    if (!cache) {
+        return ompi_coll_tuned_get_target_method_params (base_com_rule, mpi_msgsize,
+                                                         result_topo_faninout, result_segsize,
+                                                         max_requests);
+    }
+
+    while (size) {
+        size >>= 1;
+        idx++;
+    }
+    entry = &(cache->entries[idx % COLL_TUNED_DECISION_CACHE_SIZE]);
+
+    if (entry->msg_size != mpi_msgsize) {
+        entry->alg = ompi_coll_tuned_get_target_method_params (base_com_rule, mpi_msgsize,
+                                                               &entry->faninout, &entry->segsize,
+                                                               &entry->max_requests);
+        entry->msg_size = mpi_msgsize;
+    }
+
+    *result_topo_faninout = entry->faninout;
+    *result_segsize = entry->segsize;
+    *max_requests = entry->max_requests;
+    return (entry->alg);
+}
@@ -71,6 +71,24 @@ typedef struct alg_rule_s {
 
 } ompi_coll_alg_rule_t;
 
+
+/* Per communicator memo of the rule lookups of one collective. The entries
+ * are indexed by the power of two range of the message size and only match
+ * the exact size they were filled for, so the decisions are unchanged. */
+#define COLL_TUNED_DECISION_CACHE_SIZE 16
+
+typedef struct ompi_coll_tuned_decision_t {
+    size_t msg_size;             /* SIZE_MAX for an empty entry */
+    int alg;
+    int faninout;
+    int segsize;
+    int max_requests;
+} ompi_coll_tuned_decision_t;
+
+typedef struct ompi_coll_tuned_decision_cache_t {
+    ompi_coll_tuned_decision_t entries[COLL_TUNED_DECISION_CACHE_SIZE];
+} ompi_coll_tuned_decision_cache_t;
+
 /* function prototypes */
 
 /* these are used to build the rule tables (by the read file routines) */
@@ -98,6 +116,13 @@ int ompi_coll_tuned_get_target_method_params (ompi_coll_com_rule_t* base_com_rul
                                               int* result_topo_faninout, int* result_segsize,
                                               int* max_requests);
 
+ompi_coll_tuned_decision_cache_t* ompi_coll_tuned_mk_decision_cache (void);
+int ompi_coll_tuned_get_cached_method_params (ompi_coll_com_rule_t* base_com_rule,
+                                              ompi_coll_tuned_decision_cache_t* cache,
+                                              size_t mpi_msgsize,
+                                              int* result_topo_faninout, int* result_segsize,
+                                              int* max_requests);
+
 
 END_C_DECLS
 #endif /* MCA_COLL_TUNED_DYNAMIC_RULES_H_HAS_BEEN_INCLUDED */
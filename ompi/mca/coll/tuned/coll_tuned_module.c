@@ -163,6 +163,7 @@ ompi_coll_tuned_forced_getvalues( enum COLLTYPE type,
                                                     (TYPE), size );     \
             if( NULL != (TMOD)->com_rules[(TYPE)] ) {                   \
                 need_dynamic_decision = 1;                              \
+                (TMOD)->decision_cache[(TYPE)] = ompi_coll_tuned_mk_decision_cache(); \
             }                                                           \
         }                                                               \
         if( 1 == need_dynamic_decision ) {                              \
@@ -251,6 +252,28 @@ tuned_module_enable( mca_coll_base_module_t *module,
                                       tuned_module->super.coll_scatterv   = NULL);
     }
 
+    /* autotune the collectives that neither a forced algorithm nor a
+     * dynamic rule for this communicator size already decides */
+    if (ompi_coll_tuned_autotune) {
+        bool tune_allreduce = (0 == tuned_module->user_forced[ALLREDUCE].algorithm &&
+                               NULL == tuned_module->com_rules[ALLREDUCE]);
+        bool tune_bcast = (0 == tuned_module->user_forced[BCAST].algorithm &&
+                           NULL == tuned_module->com_rules[BCAST]);
+
+        if (tune_allreduce || tune_bcast) {
+            tuned_module->autotune = ompi_coll_tuned_autotune_create();
+        }
+        if (NULL != tuned_module->autotune) {
+            OPAL_OUTPUT((ompi_coll_tuned_stream,"coll:tuned:module_init autotuning enabled"));
+            if (tune_allreduce) {
+                tuned_module->super.coll_allreduce = ompi_coll_tuned_allreduce_intra_dec_autotune;
+            }
+            if (tune_bcast) {
+                tuned_module->super.coll_bcast = ompi_coll_tuned_bcast_intra_dec_autotune;
+            }
+        }
+    }
+
     /* general n fan out tree */
     data->cached_ntree = NULL;
     /* binary tree */
@@ -67,6 +67,7 @@
 #define OMPIO_LOCK_NEVER             0x00000100
 #define OMPIO_LOCK_NOT_THIS_OP       0x00000200
 #define OMPIO_DATAREP_NATIVE         0x00000400
+#define OMPIO_DIRECT_IO              0x00000800
 
 #define OMPIO_ROOT                    0
 
@@ -87,6 +88,12 @@
 #define OMPIO_LOCK_SELECTIVE      11
 
 #define OMPIO_FCOLL_WANT_TIME_BREAKDOWN 0
+
+/* Round a size or an offset to the block size of the file, which
+   aggregators use for their cycle buffers and file domains when the
+   file is written with O_DIRECT */
+#define OMPIO_DIRECT_ALIGN_DOWN(fh, x) ((x) - ((x) % (fh)->f_fs_block_size))
+#define OMPIO_DIRECT_ALIGN_UP(fh, x) OMPIO_DIRECT_ALIGN_DOWN(fh, (x) + (fh)->f_fs_block_size - 1)
 #define MCA_IO_DEFAULT_FILE_VIEW_SIZE 4*1024*1024
 
 #define OMPIO_UNIFORM_DIST_THRESHOLD     0.5
@@ -127,6 +134,20 @@ typedef struct mca_common_ompio_access_array_t{
     int count;
 } mca_common_ompio_access_array_t;
 
+/* Decoded file view of the last set_view, reused when the same view is set
+   again. The decoding does not depend on the displacement. */
+typedef struct mca_common_ompio_fview_cache_t {
+    ompi_datatype_t *filetype;   /* retained, NULL if the cache is empty */
+    ompi_datatype_t *etype;      /* retained */
+    bool             native;
+    struct iovec    *decoded_iov;
+    uint32_t         iov_count;
+    /* valid once all processes computed their groups for this view */
+    bool             grouping_valid;
+    int              num_cb_nodes;
+    size_t           cc_size;
+} mca_common_ompio_fview_cache_t;
+
 
 /* forward declaration to keep the compiler happy. */
 struct ompio_file_t;
@@ -141,6 +162,7 @@ typedef int (*mca_common_ompio_get_mca_parameter_value_fn_t) ( char *mca_paramet
 
 
 struct mca_common_ompio_print_queue;
+struct mca_common_ompio_bb_t;
 
 /**
  * Back-end structure for MPI_File
@@ -164,6 +186,9 @@ struct ompio_file_t {
     int32_t                f_flags;
     void                  *f_fs_ptr;
     int                    f_fs_block_size;
+    int                    f_direct_fd; /* O_DIRECT descriptor used by aggregators, or -1 */
+    void                  *f_mmap_addr; /* read-only mapping of the file, or NULL */
+    size_t                 f_mmap_len;
     int                    f_atomicity;
     size_t                 f_stripe_size;
     int                    f_stripe_count;
@@ -191,6 +216,7 @@ struct ompio_file_t {
     ompi_datatype_t  *f_filetype;
     ompi_datatype_t  *f_orig_filetype; /* the fileview passed by the user to us */
     size_t            f_etype_size;
+    mca_common_ompio_fview_cache_t f_fview_cache;
 
     /* contains IO requests that needs to be read/written */
     mca_common_ompio_io_array_t *f_io_array;
@@ -208,6 +234,9 @@ struct ompio_file_t {
     mca_fbtl_base_module_t     *f_fbtl;
     mca_sharedfp_base_module_t *f_sharedfp;
 
+    /* node-local write-behind staging of the file, NULL if not used */
+    struct mca_common_ompio_bb_t *f_bb;
+
     /* Timing information  */
     struct mca_common_ompio_print_queue *f_coll_write_time;
     struct mca_common_ompio_print_queue *f_coll_read_time;
@@ -269,6 +298,14 @@ OMPI_DECLSPEC int mca_common_ompio_file_iwrite_all (ompio_file_t *fp, const void
 OMPI_DECLSPEC int mca_common_ompio_file_iwrite_at_all (ompio_file_t *fp, OMPI_MPI_OFFSET_TYPE offset, const void *buf,
                                                        int count, struct ompi_datatype_t *datatype, ompi_request_t **request);
 
+OMPI_DECLSPEC ssize_t mca_common_ompio_file_write_direct (ompio_file_t *fh);
+
+OMPI_DECLSPEC ssize_t mca_common_ompio_file_read_mmap (ompio_file_t *fh);
+
+OMPI_DECLSPEC int mca_common_ompio_bb_open (ompio_file_t *fh);
+OMPI_DECLSPEC int mca_common_ompio_bb_flush (ompio_file_t *fh);
+OMPI_DECLSPEC int mca_common_ompio_bb_close (ompio_file_t *fh);
+
 OMPI_DECLSPEC int mca_common_ompio_build_io_array ( ompio_file_t *fh, int index, int cycles,
                                                     size_t bytes_per_cycle, size_t max_data, uint32_t iov_count,
                                                     struct iovec *decoded_iov, int *ii, int *jj, size_t *tbw,
@@ -321,6 +358,7 @@ OMPI_DECLSPEC int mca_common_ompio_set_file_defaults (ompio_file_t *fh);
 OMPI_DECLSPEC int mca_common_ompio_set_view (ompio_file_t *fh,  OMPI_MPI_OFFSET_TYPE disp,
                                              ompi_datatype_t *etype,  ompi_datatype_t *filetype, const char *datarep,
                                              opal_info_t *info);
+OMPI_DECLSPEC void mca_common_ompio_fview_cache_release (ompio_file_t *fh);
  
 
 /*
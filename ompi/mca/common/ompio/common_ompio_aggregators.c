@@ -27,6 +27,7 @@
 
 #include "ompi/runtime/params.h"
 #include "ompi/communicator/communicator.h"
+#include "ompi/proc/proc.h"
 #include "ompi/mca/pml/pml.h"
 #include "ompi/mca/topo/topo.h"
 #include "ompi/mca/fcoll/base/fcoll_base_coll_array.h"
@@ -54,6 +55,7 @@
 */
 
 static double cost_calc (int P, int P_agg, size_t Data_proc, size_t coll_buffer, int dim );
+static int place_aggregators (ompio_file_t *fh, int num_groups, mca_common_ompio_contg *contg_groups);
 #define DIM1 1
 #define DIM2 2
 
@@ -181,6 +183,21 @@ int mca_common_ompio_simple_grouping(ompio_file_t *fh,
     if ( 1 >= num_groups ) {
 	num_groups = 1;
     }
+
+    /* On Lustre, use a divisor of the stripe count, at most the stripe count
+    ** itself. Together with stripe aligned file domains, every aggregator then
+    ** accesses its own set of OSTs; more aggregators would have to share them.
+    */
+    if ( LUSTRE == fh->f_fstype && 1 < fh->f_stripe_count ) {
+        if ( num_groups >= fh->f_stripe_count ) {
+            num_groups = fh->f_stripe_count;
+        }
+        else {
+            while ( 0 != fh->f_stripe_count % num_groups ) {
+                num_groups--;
+            }
+        }
+    }
     
     *num_groups_out = num_groups;
 
@@ -456,6 +473,21 @@ int mca_common_ompio_finalize_initial_grouping(ompio_file_t *fh,
 
     int z = 0;
     int y = 0;
+    int ret = OMPI_SUCCESS;
+
+    /* The groups of the simple grouping options are used as they are by the
+    ** fcoll components, the other options refine them based on the order of
+    ** the processes within a group, which has to be preserved.
+    */
+    if ( 1 == OMPIO_MCA_GET(fh, aggregator_placement) &&
+         ( SIMPLE        == OMPIO_MCA_GET(fh, grouping_option) ||
+           NO_REFINEMENT == OMPIO_MCA_GET(fh, grouping_option) ||
+           SIMPLE_PLUS   == OMPIO_MCA_GET(fh, grouping_option) )) {
+        ret = place_aggregators (fh, num_groups, contg_groups);
+        if ( OMPI_SUCCESS != ret ) {
+            return ret;
+        }
+    }
 
     fh->f_init_num_aggrs = num_groups;
     if (NULL != fh->f_init_aggr_list) {
@@ -1457,6 +1489,94 @@ exit:
 ** unexpected jumps in the execution time. Using float leads to 
 ** more consistent predictions for the no. of aggregators.
 */
+/*
+** Choose the aggregator of every group such that the aggregators are spread
+** as evenly as possible across the nodes, and within a node across the NUMA
+** domains. Each process is identified by the lowest rank sharing its node
+** resp. NUMA domain. Groups are handled in order, picking the member whose
+** node and NUMA domain host the fewest aggregators so far, the first
+** member of the group winning ties. The chosen process is moved to the
+** first position of its group, which is where the fcoll components expect
+** the aggregator.
+*/
+static int place_aggregators (ompio_file_t *fh, int num_groups, mca_common_ompio_contg *contg_groups)
+{
+    int i, g, p, best, tmp;
+    int locality[2];
+    int *all_locality=NULL, *node_load=NULL, *numa_load=NULL;
+    int ret = OMPI_SUCCESS;
+    ompi_proc_t *proc;
+
+    locality[0] = fh->f_rank;
+    locality[1] = fh->f_rank;
+    for ( i=0; i<fh->f_rank; i++ ) {
+        /* with mpi_lazy_procs a peer may not exist yet and its locality
+        ** is only known once it is instantiated from the modex */
+        proc = ompi_group_peer_lookup (fh->f_comm->c_local_group, i);
+        if ( NULL == proc ) {
+            continue;
+        }
+        if ( locality[0] == fh->f_rank && OPAL_PROC_ON_LOCAL_NODE(proc->super.proc_flags) ) {
+            locality[0] = i;
+        }
+        if ( OPAL_PROC_ON_LOCAL_NUMA(proc->super.proc_flags) ) {
+            locality[1] = i;
+            break;
+        }
+    }
+
+    all_locality = (int *) malloc ( 2 * fh->f_size * sizeof(int));
+    node_load    = (int *) calloc ( 2 * fh->f_size, sizeof(int));
+    if ( NULL == all_locality || NULL == node_load ) {
+        opal_output (1, "OUT OF MEMORY\n");
+        ret = OMPI_ERR_OUT_OF_RESOURCE;
+        goto exit;
+    }
+    numa_load = node_load + fh->f_size;
+
+    ret = fh->f_comm->c_coll->coll_allgather (locality,
+                                              2,
+                                              MPI_INT,
+                                              all_locality,
+                                              2,
+                                              MPI_INT,
+                                              fh->f_comm,
+                                              fh->f_comm->c_coll->coll_allgather_module);
+    if ( OMPI_SUCCESS != ret ) {
+        goto exit;
+    }
+
+    for ( g=0; g<num_groups; g++ ) {
+        best = 0;
+        for ( i=1; i<contg_groups[g].procs_per_contg_group; i++ ) {
+            p   = contg_groups[g].procs_in_contg_group[i];
+            tmp = contg_groups[g].procs_in_contg_group[best];
+            if ( node_load[all_locality[2*p]] < node_load[all_locality[2*tmp]] ||
+                 ( node_load[all_locality[2*p]] == node_load[all_locality[2*tmp]] &&
+                   numa_load[all_locality[2*p+1]] < numa_load[all_locality[2*tmp+1]] )) {
+                best = i;
+            }
+        }
+
+        p = contg_groups[g].procs_in_contg_group[best];
+        node_load[all_locality[2*p]]++;
+        numa_load[all_locality[2*p+1]]++;
+
+        contg_groups[g].procs_in_contg_group[best] = contg_groups[g].procs_in_contg_group[0];
+        contg_groups[g].procs_in_contg_group[0]    = p;
+    }
+
+exit:
+    if ( NULL != all_locality ) {
+        free ( all_locality );
+    }
+    if ( NULL != node_load ) {
+        free ( node_load );
+    }
+
+    return ret;
+}
+
 static double cost_calc (int P, int P_a, size_t d_p, size_t b_c, int dim )
 {
     float  n_as=1.0, m_s=1.0, n_s=1.0;
@@ -0,0 +1,484 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+
+#include "ompi/communicator/communicator.h"
+#include "ompi/info/info.h"
+#include "ompi/mca/fbtl/fbtl.h"
+#include "ompi/mca/fbtl/base/base.h"
+#include "opal/threads/threads.h"
+#include "opal/util/opal_environ.h"
+#include "opal/util/printf.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "common_ompio.h"
+#include "common_ompio_request.h"
+
+/*
+** Node-local write-behind staging ("burst buffer").
+**
+** When enabled, the fbtl module of the file is wrapped: writes are appended
+** to a staging file in a node-local directory (local NVMe or tmpfs) and return
+** as soon as the data is there. A drain thread copies the staged extents to
+** the target file in the order they were written. Reads, sync, set_view,
+** set_size and close wait until everything staged has been drained, such that
+** the MPI consistency semantics are the same as without staging. The drain
+** takes the same range locks as the fbtl components would have taken for the
+** write.
+*/
+
+#define OMPIO_BB_DRAIN_CHUNK  (4*1024*1024)
+
+typedef struct mca_common_ompio_bb_extent_t {
+    struct mca_common_ompio_bb_extent_t *next;
+    OMPI_MPI_OFFSET_TYPE offset;      /* offset in the target file */
+    OMPI_MPI_OFFSET_TYPE log_offset;  /* offset in the staging file */
+    size_t               len;
+} mca_common_ompio_bb_extent_t;
+
+struct mca_common_ompio_bb_t {
+    mca_fbtl_base_module_t  module;  /* what fh->f_fbtl points to */
+    mca_fbtl_base_module_t *fbtl;    /* the selected fbtl module */
+    ompio_file_t           *fh;
+    int                     fd;      /* staging file */
+    int                     target_fd;
+    OMPI_MPI_OFFSET_TYPE    capacity;
+    OMPI_MPI_OFFSET_TYPE    log_tail;
+    size_t                  pending; /* bytes staged but not drained yet */
+    int                     error;   /* first drain error since the last flush */
+    bool                    stop;
+    mca_common_ompio_bb_extent_t *head;
+    mca_common_ompio_bb_extent_t *tail;
+    opal_thread_t           thread;
+    pthread_mutex_t         lock;
+    pthread_cond_t          work;
+    pthread_cond_t          drained;
+};
+typedef struct mca_common_ompio_bb_t mca_common_ompio_bb_t;
+
+static ssize_t mca_common_ompio_bb_preadv (ompio_file_t *fh);
+static ssize_t mca_common_ompio_bb_ipreadv (ompio_file_t *fh, ompi_request_t *request);
+static ssize_t mca_common_ompio_bb_pwritev (ompio_file_t *fh);
+static ssize_t mca_common_ompio_bb_ipwritev (ompio_file_t *fh, ompi_request_t *request);
+static void *mca_common_ompio_bb_drain (opal_object_t *obj);
+
+
+int mca_common_ompio_bb_open (ompio_file_t *fh)
+{
+    mca_common_ompio_bb_t *bb;
+    char value[MPI_MAX_INFO_VAL];
+    char *path = NULL;
+    const char *dir;
+    int flag, enable, rc;
+
+    enable = OMPIO_MCA_GET(fh, burst_buffer);
+    opal_info_get (fh->f_info, "ompio_burst_buffer", MPI_MAX_INFO_VAL, value, &flag);
+    if ( flag ) {
+        /* Info object trumps mca parameter value */
+        if ( !strncmp ( value, "true", sizeof("true") )) {
+            enable = 1;
+        }
+        else if ( !strncmp ( value, "false", sizeof("false") )) {
+            enable = 0;
+        }
+        OMPIO_MCA_PRINT_INFO(fh, "ompio_burst_buffer", value, "");
+    }
+
+    /* the drain thread writes through the descriptor of the file, and
+       aggregators writing with O_DIRECT do not go through the fbtl */
+    if ( !enable || (fh->f_amode & MPI_MODE_RDONLY) || 0 > fh->fd ||
+         (fh->f_flags & OMPIO_DIRECT_IO) ) {
+        return OMPI_SUCCESS;
+    }
+
+    /* with pwrite and fcntl locks, which needs fh->fd to be a kernel file
+       descriptor. That is only known for the fbtl components writing with
+       POSIX calls, others (e.g. ime) have their own kind of descriptor */
+    if ( NULL == fh->f_fbtl_component ||
+         ( strcmp (fh->f_fbtl_component->mca_component_name, "posix") &&
+           strcmp (fh->f_fbtl_component->mca_component_name, "io_uring") ) ) {
+        return OMPI_SUCCESS;
+    }
+
+    dir = opal_tmp_directory();
+    opal_info_get (fh->f_info, "ompio_burst_buffer_dir", MPI_MAX_INFO_VAL, value, &flag);
+    if ( flag ) {
+        dir = value;
+    }
+
+    bb = (mca_common_ompio_bb_t *) calloc (1, sizeof(mca_common_ompio_bb_t));
+    if ( NULL == bb ) {
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+    bb->capacity = (OMPI_MPI_OFFSET_TYPE) OMPIO_MCA_GET(fh, burst_buffer_size) * 1024 * 1024;
+    bb->fh = fh;
+    bb->target_fd = fh->fd;
+    bb->error = OMPI_SUCCESS;
+
+    if ( 0 > opal_asprintf (&path, "%s/ompio_bb.%d.XXXXXX", dir, (int) getpid()) ) {
+        free (bb);
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+    bb->fd = mkstemp (path);
+    if ( 0 > bb->fd ) {
+        /* not fatal, the file is simply written without staging */
+        opal_output (1, "mca_common_ompio_bb_open: could not create staging file %s: %s",
+                     path, strerror(errno));
+        free (path);
+        free (bb);
+        return OMPI_SUCCESS;
+    }
+    /* nobody but this process ever looks at the staging file */
+    unlink (path);
+    free (path);
+
+    pthread_mutex_init (&bb->lock, NULL);
+    pthread_cond_init (&bb->work, NULL);
+    pthread_cond_init (&bb->drained, NULL);
+
+    OBJ_CONSTRUCT(&bb->thread, opal_thread_t);
+    bb->thread.t_run = mca_common_ompio_bb_drain;
+    bb->thread.t_arg = bb;
+    rc = opal_thread_start (&bb->thread);
+    if ( OPAL_SUCCESS != rc ) {
+        opal_output (1, "mca_common_ompio_bb_open: could not start drain thread: %d", rc);
+        OBJ_DESTRUCT(&bb->thread);
+        pthread_cond_destroy (&bb->drained);
+        pthread_cond_destroy (&bb->work);
+        pthread_mutex_destroy (&bb->lock);
+        close (bb->fd);
+        free (bb);
+        return OMPI_SUCCESS;
+    }
+
+    bb->fbtl = fh->f_fbtl;
+    bb->module = *fh->f_fbtl;
+    bb->module.fbtl_preadv  = mca_common_ompio_bb_preadv;
+    bb->module.fbtl_pwritev = mca_common_ompio_bb_pwritev;
+    bb->module.fbtl_ipwritev = mca_common_ompio_bb_ipwritev;
+    if ( NULL != bb->fbtl->fbtl_ipreadv ) {
+        bb->module.fbtl_ipreadv = mca_common_ompio_bb_ipreadv;
+    }
+
+    fh->f_bb   = bb;
+    fh->f_fbtl = &bb->module;
+
+    return OMPI_SUCCESS;
+}
+
+int mca_common_ompio_bb_flush (ompio_file_t *fh)
+{
+    mca_common_ompio_bb_t *bb = fh->f_bb;
+    int ret;
+
+    if ( NULL == bb ) {
+        return OMPI_SUCCESS;
+    }
+
+    pthread_mutex_lock (&bb->lock);
+    while ( 0 < bb->pending ) {
+        pthread_cond_wait (&bb->drained, &bb->lock);
+    }
+    ret = bb->error;
+    bb->error = OMPI_SUCCESS;
+    pthread_mutex_unlock (&bb->lock);
+
+    return ret;
+}
+
+int mca_common_ompio_bb_close (ompio_file_t *fh)
+{
+    mca_common_ompio_bb_t *bb = fh->f_bb;
+    int ret;
+
+    if ( NULL == bb ) {
+        return OMPI_SUCCESS;
+    }
+
+    ret = mca_common_ompio_bb_flush (fh);
+
+    pthread_mutex_lock (&bb->lock);
+    bb->stop = true;
+    pthread_cond_signal (&bb->work);
+    pthread_mutex_unlock (&bb->lock);
+    opal_thread_join (&bb->thread, NULL);
+    OBJ_DESTRUCT(&bb->thread);
+
+    pthread_cond_destroy (&bb->drained);
+    pthread_cond_destroy (&bb->work);
+    pthread_mutex_destroy (&bb->lock);
+    close (bb->fd);
+
+    fh->f_fbtl = bb->fbtl;
+    fh->f_bb   = NULL;
+    free (bb);
+
+    return ret;
+}
+
+static ssize_t mca_common_ompio_bb_preadv (ompio_file_t *fh)
+{
+    int ret = mca_common_ompio_bb_flush (fh);
+    if ( OMPI_SUCCESS != ret ) {
+        return ret;
+    }
+    return fh->f_bb->fbtl->fbtl_preadv (fh);
+}
+
+static ssize_t mca_common_ompio_bb_ipreadv (ompio_file_t *fh, ompi_request_t *request)
+{
+    int ret = mca_common_ompio_bb_flush (fh);
+    if ( OMPI_SUCCESS != ret ) {
+        return ret;
+    }
+    return fh->f_bb->fbtl->fbtl_ipreadv (fh, request);
+}
+
+static ssize_t mca_common_ompio_bb_pwritev (ompio_file_t *fh)
+{
+    mca_common_ompio_bb_t *bb = fh->f_bb;
+    mca_common_ompio_bb_extent_t *first=NULL, *last=NULL, *ext;
+    OMPI_MPI_OFFSET_TYPE log_start, log_offset, offset;
+    size_t total=0, len, done;
+    ssize_t ret_code;
+    int i, ret;
+
+    for ( i=0; i<fh->f_num_of_io_entries; i++ ) {
+        total += fh->f_io_array[i].length;
+    }
+    if ( 0 == total ) {
+        return 0;
+    }
+
+    if ( fh->f_atomicity || (0 < bb->capacity && (OMPI_MPI_OFFSET_TYPE) total > bb->capacity) ) {
+        /* write through, after whatever is still staged */
+        ret = mca_common_ompio_bb_flush (fh);
+        if ( OMPI_SUCCESS != ret ) {
+            return ret;
+        }
+        return bb->fbtl->fbtl_pwritev (fh);
+    }
+
+    /* reserve space in the staging file. It is reused from the start once
+       everything has been drained, which is the only time the drain thread
+       does not look at any part of it */
+    pthread_mutex_lock (&bb->lock);
+    while ( 0 < bb->pending && 0 < bb->capacity &&
+            bb->log_tail + (OMPI_MPI_OFFSET_TYPE) total > bb->capacity ) {
+        pthread_cond_wait (&bb->drained, &bb->lock);
+    }
+    if ( 0 == bb->pending ) {
+        bb->log_tail = 0;
+    }
+    log_start = log_offset = bb->log_tail;
+    bb->log_tail += total;
+    pthread_mutex_unlock (&bb->lock);
+
+    for ( i=0; i<fh->f_num_of_io_entries; i++ ) {
+        len    = fh->f_io_array[i].length;
+        offset = (OMPI_MPI_OFFSET_TYPE)(intptr_t) fh->f_io_array[i].offset;
+
+        for ( done=0; done < len; done += ret_code ) {
+            ret_code = pwrite (bb->fd, (char *) fh->f_io_array[i].memory_address + done,
+                               len - done, log_offset + done);
+            if ( 0 > ret_code ) {
+                if ( EINTR == errno ) {
+                    ret_code = 0;
+                    continue;
+                }
+                opal_output (1, "mca_common_ompio_bb_pwritev: error staging data: %s", strerror(errno));
+                goto err;
+            }
+        }
+
+        /* extents contiguous in the target file are drained with one write */
+        if ( NULL != last && last->offset + (OMPI_MPI_OFFSET_TYPE) last->len == offset ) {
+            last->len += len;
+        }
+        else {
+            ext = (mca_common_ompio_bb_extent_t *) malloc (sizeof(mca_common_ompio_bb_extent_t));
+            if ( NULL == ext ) {
+                opal_output (1, "OUT OF MEMORY\n");
+                goto err;
+            }
+            ext->next       = NULL;
+            ext->offset     = offset;
+            ext->log_offset = log_offset;
+            ext->len        = len;
+            if ( NULL == last ) {
+                first = ext;
+            }
+            else {
+                last->next = ext;
+            }
+            last = ext;
+        }
+        log_offset += len;
+    }
+
+    pthread_mutex_lock (&bb->lock);
+    if ( NULL == bb->tail ) {
+        bb->head = first;
+    }
+    else {
+        bb->tail->next = first;
+    }
+    bb->tail = last;
+    bb->pending += total;
+    pthread_cond_signal (&bb->work);
+    pthread_mutex_unlock (&bb->lock);
+
+    return (ssize_t) total;
+
+ err:
+    /* staging failed (e.g. the local device is full): give the space back
+       unless somebody reserved behind us, and write through instead */
+    pthread_mutex_lock (&bb->lock);
+    if ( bb->log_tail == log_start + (OMPI_MPI_OFFSET_TYPE) total ) {
+        bb->log_tail = log_start;
+    }
+    pthread_mutex_unlock (&bb->lock);
+
+    while ( NULL != first ) {
+        ext = first->next;
+        free (first);
+        first = ext;
+    }
+
+    ret = mca_common_ompio_bb_flush (fh);
+    if ( OMPI_SUCCESS != ret ) {
+        return ret;
+    }
+    return bb->fbtl->fbtl_pwritev (fh);
+}
+
+static ssize_t mca_common_ompio_bb_ipwritev (ompio_file_t *fh, ompi_request_t *request)
+{
+    mca_ompio_request_t *req = (mca_ompio_request_t *) request;
+    ssize_t ret_code;
+
+    /* staging is fast enough to be done right away */
+    ret_code = mca_common_ompio_bb_pwritev (fh);
+    req->req_ompi.req_status.MPI_ERROR = (0 > ret_code) ? (int) ret_code : OMPI_SUCCESS;
+    req->req_ompi.req_status._ucount = (0 > ret_code) ? 0 : ret_code;
+    ompi_request_complete (&req->req_ompi, false);
+
+    return OMPI_SUCCESS;
+}
+
+static int mca_common_ompio_bb_copy (mca_common_ompio_bb_t *bb, char *buf,
+                                     mca_common_ompio_bb_extent_t *ext)
+{
+    struct flock lock;
+    size_t done=0, chunk, pos;
+    ssize_t ret_code;
+    int ret;
+
+    while ( done < ext->len ) {
+        chunk = ext->len - done;
+        if ( chunk > OMPIO_BB_DRAIN_CHUNK ) {
+            chunk = OMPIO_BB_DRAIN_CHUNK;
+        }
+        for ( pos=0; pos < chunk; pos += ret_code ) {
+            ret_code = pread (bb->fd, buf + pos, chunk - pos, ext->log_offset + done + pos);
+            if ( 0 > ret_code && EINTR == errno ) {
+                ret_code = 0;
+                continue;
+            }
+            if ( 0 >= ret_code ) {
+                opal_output (1, "mca_common_ompio_bb_drain: error reading staged data: %s",
+                             strerror(errno));
+                return OMPI_ERROR;
+            }
+        }
+        /* fcntl locks belong to the process, so taking them from this
+           thread protects the blocks against writers on other nodes */
+        ret = mca_fbtl_base_file_lock (&lock, bb->fh, F_WRLCK, ext->offset + done,
+                                       chunk, OMPIO_LOCK_SELECTIVE);
+        if ( 0 < ret ) {
+            opal_output (1, "mca_common_ompio_bb_drain: error in mca_fbtl_base_file_lock() ret=%d: %s",
+                         ret, strerror(errno));
+            mca_fbtl_base_file_unlock (&lock, bb->fh);
+            return OMPI_ERROR;
+        }
+        for ( pos=0; pos < chunk; pos += ret_code ) {
+            ret_code = pwrite (bb->target_fd, buf + pos, chunk - pos, ext->offset + done + pos);
+            if ( 0 > ret_code ) {
+                if ( EINTR == errno ) {
+                    ret_code = 0;
+                    continue;
+                }
+                opal_output (1, "mca_common_ompio_bb_drain: error writing to file: %s",
+                             strerror(errno));
+                mca_fbtl_base_file_unlock (&lock, bb->fh);
+                return OMPI_ERROR;
+            }
+        }
+        mca_fbtl_base_file_unlock (&lock, bb->fh);
+        done += chunk;
+    }
+
+    return OMPI_SUCCESS;
+}
+
+static void *mca_common_ompio_bb_drain (opal_object_t *obj)
+{
+    mca_common_ompio_bb_t *bb = (mca_common_ompio_bb_t *) ((opal_thread_t *) obj)->t_arg;
+    mca_common_ompio_bb_extent_t *ext;
+    char *buf;
+    int ret;
+
+    buf = (char *) malloc (OMPIO_BB_DRAIN_CHUNK);
+
+    pthread_mutex_lock (&bb->lock);
+    while ( 1 ) {
+        while ( NULL == bb->head && !bb->stop ) {
+            pthread_cond_wait (&bb->work, &bb->lock);
+        }
+        ext = bb->head;
+        if ( NULL == ext ) {
+            break;
+        }
+        bb->head = ext->next;
+        if ( NULL == bb->head ) {
+            bb->tail = NULL;
+        }
+        pthread_mutex_unlock (&bb->lock);
+
+        if ( NULL == buf ) {
+            opal_output (1, "OUT OF MEMORY\n");
+            ret = OMPI_ERR_OUT_OF_RESOURCE;
+        }
+        else {
+            ret = mca_common_ompio_bb_copy (bb, buf, ext);
+        }
+
+        pthread_mutex_lock (&bb->lock);
+        if ( OMPI_SUCCESS != ret && OMPI_SUCCESS == bb->error ) {
+            bb->error = ret;
+        }
+        bb->pending -= ext->len;
+        free (ext);
+        if ( 0 == bb->pending ) {
+            pthread_cond_broadcast (&bb->drained);
+        }
+    }
+    pthread_mutex_unlock (&bb->lock);
+
+    free (buf);
+    return NULL;
+}
@@ -165,6 +165,21 @@ int mca_common_ompio_file_open (ompi_communicator_t *comm,
         goto fn_fail;
     }
 
+    /* only the fs components supporting direct I/O open the O_DIRECT
+       descriptor, and they do so on all the ranks or none */
+    if ( 0 > ompio_fh->f_direct_fd ) {
+        ompio_fh->f_flags &= ~OMPIO_DIRECT_IO;
+    }
+
+    if ( true == use_sharedfp ) {
+        /* stage writes in a node-local directory if requested. Files opened
+           internally by the sharedfp components are written directly */
+        ret = mca_common_ompio_bb_open (ompio_fh);
+        if ( OMPI_SUCCESS != ret ) {
+            goto fn_fail;
+        }
+    }
+
     if ( true == use_sharedfp ) {
 	/* open the file once more for the shared file pointer if required.           
         ** Can be disabled by the user if no shared file pointer operations
@@ -232,9 +247,17 @@ int mca_common_ompio_file_open (ompi_communicator_t *comm,
 int mca_common_ompio_file_close (ompio_file_t *ompio_fh)
 {
     int ret = OMPI_SUCCESS;
+    int bb_ret = OMPI_SUCCESS;
     int delete_flag = 0;
     char name[256];
 
+    /* everything written has to be in the file once it is closed. A
+    ** drain error is reported once the file is closed on all processes */
+    bb_ret = mca_common_ompio_bb_close (ompio_fh);
+    if ( OMPI_SUCCESS != bb_ret ) {
+        opal_output (1,"mca_common_ompio_file_close: error draining staged data \n");
+    }
+
     ret = ompio_fh->f_comm->c_coll->coll_barrier ( ompio_fh->f_comm, ompio_fh->f_comm->c_coll->coll_barrier_module);
     if ( OMPI_SUCCESS != ret ) {
         /* Not sure what to do */
@@ -323,6 +346,7 @@ int mca_common_ompio_file_close (ompio_file_t *ompio_fh)
         free (ompio_fh->f_decoded_iov);
         ompio_fh->f_decoded_iov = NULL;
     }
+    mca_common_ompio_fview_cache_release (ompio_fh);
 
     if (NULL != ompio_fh->f_mem_convertor) {
         opal_convertor_cleanup (ompio_fh->f_mem_convertor);
@@ -372,6 +396,9 @@ int mca_common_ompio_file_close (ompio_file_t *ompio_fh)
         ompi_comm_free (&ompio_fh->f_comm);
     }
 
+    if ( OMPI_SUCCESS != bb_ret ) {
+        ret = bb_ret;
+    }
     return ret;
 }
 
@@ -380,6 +407,10 @@ int mca_common_ompio_file_get_size (ompio_file_t *ompio_fh,
 {
     int ret = OMPI_SUCCESS;
 
+    ret = mca_common_ompio_bb_flush (ompio_fh);
+    if ( OMPI_SUCCESS != ret ) {
+        return ret;
+    }
     ret = ompio_fh->f_fs->fs_file_get_size (ompio_fh, size);
 
     return ret;
@@ -435,6 +466,26 @@ int mca_common_ompio_set_file_defaults (ompio_file_t *fh)
 
        fh->f_atomicity = 0;
        fh->f_fs_block_size = 4096;
+       fh->f_direct_fd = -1;
+       fh->f_bb = NULL;
+       fh->f_mmap_addr = NULL;
+       fh->f_mmap_len = 0;
+
+       /* the fs component opens the O_DIRECT descriptor if it can */
+       if ( 1 == OMPIO_MCA_GET(fh, direct_io) ) {
+           fh->f_flags |= OMPIO_DIRECT_IO;
+       }
+       opal_info_get (fh->f_info, "ompio_direct_io", MPI_MAX_INFO_VAL, char_stripe, &flag);
+       if ( flag && 0 != OMPIO_MCA_GET(fh, direct_io) ) {
+           /* Info object trumps mca parameter value */
+           if ( !strncmp ( char_stripe, "true", sizeof("true") )) {
+               fh->f_flags |= OMPIO_DIRECT_IO;
+           }
+           else if ( !strncmp ( char_stripe, "false", sizeof("false") )) {
+               fh->f_flags &= ~OMPIO_DIRECT_IO;
+           }
+           OMPIO_MCA_PRINT_INFO(fh, "ompio_direct_io", char_stripe, "");
+       }
        
        fh->f_offset = 0;
        fh->f_disp = 0;
@@ -463,6 +514,7 @@ int mca_common_ompio_set_file_defaults (ompio_file_t *fh)
        fh->f_filetype = MPI_DATATYPE_NULL;
        fh->f_orig_filetype = MPI_DATATYPE_NULL;
        fh->f_datarep = NULL;
+       memset (&fh->f_fview_cache, 0, sizeof(fh->f_fview_cache));
        
        /*Create a derived datatype for the created iovec */
        types[0] = &ompi_mpi_long.dt;
@@ -34,6 +34,7 @@
 #include "common_ompio.h"
 #include "common_ompio_request.h"
 #include "common_ompio_buffer.h"
+#include <string.h>
 #include <unistd.h>
 #include <math.h>
 
@@ -168,7 +169,12 @@ int mca_common_ompio_file_read (ompio_file_t *fh,
                                           &fh->f_num_of_io_entries);
 
         if (fh->f_num_of_io_entries) {
-            ret_code = fh->f_fbtl->fbtl_preadv (fh);
+            if ( NULL != fh->f_mmap_addr ) {
+                ret_code = mca_common_ompio_file_read_mmap (fh);
+            }
+            else {
+                ret_code = fh->f_fbtl->fbtl_preadv (fh);
+            }
             if ( 0<= ret_code ) {
                 real_bytes_read+=(size_t)ret_code;
             }
@@ -256,7 +262,8 @@ int mca_common_ompio_file_iread (ompio_file_t *fh,
         return OMPI_SUCCESS;
     }
 
-    if ( NULL != fh->f_fbtl->fbtl_ipreadv ) {
+    /* reads from a mapped file are copies, which are done right away */
+    if ( NULL != fh->f_fbtl->fbtl_ipreadv && NULL == fh->f_mmap_addr ) {
         // This fbtl has support for non-blocking operations
 
         size_t total_bytes_read = 0;       /* total bytes that have been read*/
@@ -564,3 +571,34 @@ int mca_common_ompio_set_explicit_offset (ompio_file_t *fh,
 
     return OMPI_SUCCESS;
 }
+
+/*
+ * Serve the io array from the read-only mapping of the file set up by the
+ * fs component. The mapping covers the file as it was when it was opened,
+ * an array reaching past it is read with the fbtl, in case the file has
+ * grown since. Unlike preadv, a copy from a page beyond the current end of
+ * the file raises SIGBUS, so the file must not be truncated while it is
+ * open with the mapping (see the fs_ufs_mmap parameter).
+ */
+ssize_t mca_common_ompio_file_read_mmap (ompio_file_t *fh)
+{
+    mca_common_ompio_io_array_t *io_array = fh->f_io_array;
+    OMPI_MPI_OFFSET_TYPE off;
+    ssize_t total = 0;
+    int i;
+
+    for ( i=0; i<fh->f_num_of_io_entries; i++ ) {
+        off = (OMPI_MPI_OFFSET_TYPE)(intptr_t) io_array[i].offset;
+        if ( off + (OMPI_MPI_OFFSET_TYPE) io_array[i].length > (OMPI_MPI_OFFSET_TYPE) fh->f_mmap_len ) {
+            return fh->f_fbtl->fbtl_preadv (fh);
+        }
+    }
+
+    for ( i=0; i<fh->f_num_of_io_entries; i++ ) {
+        off = (OMPI_MPI_OFFSET_TYPE)(intptr_t) io_array[i].offset;
+        memcpy (io_array[i].memory_address, (char *) fh->f_mmap_addr + off, io_array[i].length);
+        total += io_array[i].length;
+    }
+
+    return total;
+}
@@ -25,6 +25,7 @@
 #include "ompi/datatype/ompi_datatype.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "common_ompio.h"
 #include "common_ompio_aggregators.h"
@@ -32,6 +33,7 @@
 #include "ompi/mca/topo/topo.h"
 
 static OMPI_MPI_OFFSET_TYPE get_contiguous_chunk_size (ompio_file_t *, int flag);
+static int fview_cache_store (ompio_file_t *fh, ompi_datatype_t *etype, ompi_datatype_t *filetype);
 static int datatype_duplicate (ompi_datatype_t *oldtype, ompi_datatype_t **newtype );
 static int datatype_duplicate  (ompi_datatype_t *oldtype, ompi_datatype_t **newtype )
 {
@@ -61,17 +63,24 @@ int mca_common_ompio_set_view (ompio_file_t *fh,
                                const char *datarep,
                                opal_info_t *info)
 {
-    int ret=OMPI_SUCCESS;
+    int ret=OMPI_SUCCESS, bb_ret;
     size_t max_data = 0;
     int i, flag;
     int num_groups = 0;
     int num_cb_nodes=-1;
+    int reuse_grouping=0;
+    bool cache_hit;
     mca_common_ompio_contg *contg_groups=NULL;
+    mca_common_ompio_fview_cache_t *cache = &fh->f_fview_cache;
 
     size_t ftype_size;
     ptrdiff_t ftype_extent, lb, ub;
     ompi_datatype_t *newfiletype;
 
+    /* set_view is a synchronization point, staged data has to be in the file.
+       A drain error is local, it is reported after the collective part */
+    bb_ret = mca_common_ompio_bb_flush (fh);
+
     if ( NULL != fh->f_etype ) {
         ompi_datatype_destroy (&fh->f_etype);
     }
@@ -145,14 +154,37 @@ int mca_common_ompio_set_view (ompio_file_t *fh,
     fh->f_index_in_file_view=0;
     fh->f_position_in_file_view=0;
 
-    mca_common_ompio_decode_datatype (fh,
-                                      newfiletype,
-                                      1,
-                                      NULL,
-                                      &max_data,
-                                      fh->f_file_convertor,
-                                      &fh->f_decoded_iov,
-                                      &fh->f_iov_count);
+    cache_hit = ( cache->filetype == filetype && cache->etype == etype &&
+                  cache->native == !!(fh->f_flags & OMPIO_DATAREP_NATIVE) );
+    if ( cache_hit ) {
+        /* same view as before, only the displacement may have changed */
+        if ( 0 < cache->iov_count ) {
+            fh->f_decoded_iov = (struct iovec *) malloc (cache->iov_count * sizeof(struct iovec));
+            if ( NULL == fh->f_decoded_iov ) {
+                opal_output (1, "OUT OF MEMORY\n");
+                return OMPI_ERR_OUT_OF_RESOURCE;
+            }
+            memcpy (fh->f_decoded_iov, cache->decoded_iov, cache->iov_count * sizeof(struct iovec));
+        }
+        fh->f_iov_count = cache->iov_count;
+    }
+    else {
+        ret = mca_common_ompio_decode_datatype (fh,
+                                                newfiletype,
+                                                1,
+                                                NULL,
+                                                &max_data,
+                                                fh->f_file_convertor,
+                                                &fh->f_decoded_iov,
+                                                &fh->f_iov_count);
+        if ( OMPI_SUCCESS == ret ) {
+            /* failing to cache the view only costs a decode next time */
+            (void) fview_cache_store (fh, etype, filetype);
+        }
+        else {
+            mca_common_ompio_fview_cache_release (fh);
+        }
+    }
 
     opal_datatype_get_extent(&newfiletype->super, &lb, &fh->f_view_extent);
     opal_datatype_type_ub   (&newfiletype->super, &ub);
@@ -168,7 +200,41 @@ int mca_common_ompio_set_view (ompio_file_t *fh,
         return MPI_ERR_ARG;
     }
 
-    if( SIMPLE_PLUS == OMPIO_MCA_GET(fh, grouping_option) ) {
+    char char_stripe[MPI_MAX_INFO_VAL];
+    /* Check the info object set during File_open */
+    opal_info_get (fh->f_info, "cb_nodes", MPI_MAX_INFO_VAL, char_stripe, &flag);
+    if ( flag ) {
+        sscanf ( char_stripe, "%d", &num_cb_nodes );
+        OMPIO_MCA_PRINT_INFO(fh, "cb_nodes", char_stripe, "");
+    }
+    else {
+        /* Check the info object set during file_set_view */
+        opal_info_get (info, "cb_nodes", MPI_MAX_INFO_VAL, char_stripe, &flag);
+        if ( flag ) {
+            sscanf ( char_stripe, "%d", &num_cb_nodes );
+            OMPIO_MCA_PRINT_INFO(fh, "cb_nodes", char_stripe, "");
+        }
+    }
+        
+    /* The contiguous chunk size and the initial groups only depend on the
+       decoded views of all processes. If everybody sets the view it had
+       before, the results of the last set_view are still valid. */
+    reuse_grouping = ( cache_hit && cache->grouping_valid && cache->num_cb_nodes == num_cb_nodes );
+    ret = fh->f_comm->c_coll->coll_allreduce (MPI_IN_PLACE,
+                                              &reuse_grouping,
+                                              1,
+                                              MPI_INT,
+                                              MPI_MIN,
+                                              fh->f_comm,
+                                              fh->f_comm->c_coll->coll_allreduce_module);
+    if ( OMPI_SUCCESS != ret ) {
+        return ret;
+    }
+
+    if ( reuse_grouping ) {
+        fh->f_cc_size = cache->cc_size;
+    }
+    else if( SIMPLE_PLUS == OMPIO_MCA_GET(fh, grouping_option) ) {
         fh->f_cc_size = get_contiguous_chunk_size (fh, 1);
     }
     else {
@@ -182,6 +248,10 @@ int mca_common_ompio_set_view (ompio_file_t *fh,
         }
     }
 
+    if ( reuse_grouping ) {
+        goto select;
+    }
+
     contg_groups = (mca_common_ompio_contg*) calloc ( 1, fh->f_size * sizeof(mca_common_ompio_contg));
     if (NULL == contg_groups) {
         opal_output (1, "OUT OF MEMORY\n");
@@ -200,22 +270,6 @@ int mca_common_ompio_set_view (ompio_file_t *fh,
        }
     }
 
-    char char_stripe[MPI_MAX_INFO_VAL];
-    /* Check the info object set during File_open */
-    opal_info_get (fh->f_info, "cb_nodes", MPI_MAX_INFO_VAL, char_stripe, &flag);
-    if ( flag ) {
-        sscanf ( char_stripe, "%d", &num_cb_nodes );
-        OMPIO_MCA_PRINT_INFO(fh, "cb_nodes", char_stripe, "");
-    }
-    else {
-        /* Check the info object set during file_set_view */
-        opal_info_get (info, "cb_nodes", MPI_MAX_INFO_VAL, char_stripe, &flag);
-        if ( flag ) {
-            sscanf ( char_stripe, "%d", &num_cb_nodes );
-            OMPIO_MCA_PRINT_INFO(fh, "cb_nodes", char_stripe, "");
-        }
-    }
-        
 
     if ( -1 != OMPIO_MCA_GET(fh, num_aggregators) || -1 != num_cb_nodes) {
         /* The user requested a particular number of aggregators */
@@ -295,7 +349,13 @@ int mca_common_ompio_set_view (ompio_file_t *fh,
         opal_output(1, "mca_common_ompio_set_view: mca_io_ompio_finalize_initial_grouping failed\n");
         goto exit;
     }
+    if ( NULL != cache->filetype ) {
+        cache->grouping_valid = true;
+        cache->num_cb_nodes   = num_cb_nodes;
+        cache->cc_size        = fh->f_cc_size;
+    }
 
+select:
     if ( etype == filetype                              &&
 	 ompi_datatype_is_predefined (filetype )        &&
 	 ftype_extent == (ptrdiff_t)ftype_size ){
@@ -340,14 +400,58 @@ int mca_common_ompio_set_view (ompio_file_t *fh,
     }
 
 exit:
-    for( i = 0; i < fh->f_size; i++){
-       free(contg_groups[i].procs_in_contg_group);
+    if ( NULL != contg_groups ) {
+        for( i = 0; i < fh->f_size; i++){
+            free(contg_groups[i].procs_in_contg_group);
+        }
+        free(contg_groups);
     }
-    free(contg_groups);
 
+    if ( OMPI_SUCCESS == ret && OMPI_SUCCESS != bb_ret ) {
+        ret = bb_ret;
+    }
     return ret;
 }
 
+static int fview_cache_store (ompio_file_t *fh, ompi_datatype_t *etype, ompi_datatype_t *filetype)
+{
+    mca_common_ompio_fview_cache_t *cache = &fh->f_fview_cache;
+
+    mca_common_ompio_fview_cache_release (fh);
+
+    if ( 0 < fh->f_iov_count ) {
+        cache->decoded_iov = (struct iovec *) malloc (fh->f_iov_count * sizeof(struct iovec));
+        if ( NULL == cache->decoded_iov ) {
+            return OMPI_ERR_OUT_OF_RESOURCE;
+        }
+        memcpy (cache->decoded_iov, fh->f_decoded_iov, fh->f_iov_count * sizeof(struct iovec));
+    }
+    cache->iov_count = fh->f_iov_count;
+
+    /* keep the datatypes alive, so that their addresses cannot be reused
+       by a different datatype while they identify the cached view */
+    OBJ_RETAIN(filetype);
+    OBJ_RETAIN(etype);
+    cache->filetype = filetype;
+    cache->etype    = etype;
+    cache->native   = !!(fh->f_flags & OMPIO_DATAREP_NATIVE);
+    cache->grouping_valid = false;
+
+    return OMPI_SUCCESS;
+}
+
+void mca_common_ompio_fview_cache_release (ompio_file_t *fh)
+{
+    mca_common_ompio_fview_cache_t *cache = &fh->f_fview_cache;
+
+    if ( NULL != cache->filetype ) {
+        OBJ_RELEASE(cache->filetype);
+        OBJ_RELEASE(cache->etype);
+    }
+    free (cache->decoded_iov);
+    memset (cache, 0, sizeof(*cache));
+}
+
 OMPI_MPI_OFFSET_TYPE get_contiguous_chunk_size (ompio_file_t *fh, int flag)
 {
     int uniform = 0;
@@ -34,6 +34,9 @@
 #include "common_ompio_buffer.h"
 #include <unistd.h>
 #include <math.h>
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
 
 int mca_common_ompio_file_write (ompio_file_t *fh,
 			       const void *buf,
@@ -641,3 +644,199 @@ int mca_common_ompio_build_io_array ( ompio_file_t *fh, int index, int cycles,
     return OMPI_SUCCESS;
 }
 
+
+/* Helper functions for writing with O_DIRECT                 */
+/**************************************************************/
+
+typedef struct {
+    mca_common_ompio_io_array_t *entries;
+    int count;
+    int size;
+} direct_io_array_t;
+
+/* append a piece, extending the last entry if the piece continues it */
+static int direct_io_array_add (direct_io_array_t *a, char *mem, OMPI_MPI_OFFSET_TYPE off, size_t len)
+{
+    mca_common_ompio_io_array_t *last;
+
+    if (0 < a->count) {
+        last = &a->entries[a->count - 1];
+        if (0 < last->length && (char *) last->memory_address + last->length == mem &&
+            (OMPI_MPI_OFFSET_TYPE)(intptr_t) last->offset + (OMPI_MPI_OFFSET_TYPE) last->length == off) {
+            last->length += len;
+            return OMPI_SUCCESS;
+        }
+    }
+
+    if (a->count == a->size) {
+        mca_common_ompio_io_array_t *tmp;
+        a->size += OMPIO_IOVEC_INITIAL_SIZE;
+        tmp = (mca_common_ompio_io_array_t *) realloc (a->entries, a->size * sizeof (mca_common_ompio_io_array_t));
+        if (NULL == tmp) {
+            return OMPI_ERR_OUT_OF_RESOURCE;
+        }
+        a->entries = tmp;
+    }
+
+    a->entries[a->count].memory_address = mem;
+    a->entries[a->count].offset = (IOVBASE_TYPE *)(intptr_t) off;
+    a->entries[a->count].length = len;
+    a->count++;
+
+    return OMPI_SUCCESS;
+}
+
+/* read a block for read-modify-write, returns the number of bytes that
+   exist in the file */
+static ssize_t direct_read_block (int fd, char *buf, size_t len, OMPI_MPI_OFFSET_TYPE off)
+{
+    ssize_t ret;
+    size_t got = 0;
+
+    while (got < len) {
+        ret = pread (fd, buf + got, len - got, off + got);
+        if (0 > ret) {
+            if (EINTR == errno) {
+                continue;
+            }
+            return -1;
+        }
+        if (0 == ret) {
+            break;
+        }
+        got += ret;
+    }
+    memset (buf + got, 0, len - got);
+
+    return (ssize_t) got;
+}
+
+/*
+ * Write fh->f_io_array with O_DIRECT. Pieces covering whole blocks from
+ * aligned memory are written in place. Partial blocks and pieces from
+ * misaligned memory are assembled in aligned bounce blocks, after
+ * reading the partial blocks from the file (read-modify-write). A
+ * partial block reaching past the end of the file is written through
+ * the page cache up to the end of the data, so that the file does not
+ * grow to a block boundary. The entries have to be sorted by offset and
+ * not overlap, as built by the aggregators of the fcoll components,
+ * otherwise the array is written through the page cache.
+ */
+ssize_t mca_common_ompio_file_write_direct (ompio_file_t *fh)
+{
+    mca_common_ompio_io_array_t *io_array = fh->f_io_array;
+    int num_entries = fh->f_num_of_io_entries;
+    direct_io_array_t direct = {NULL, 0, 0}, cached = {NULL, 0, 0};
+    char **blocks = NULL, *block = NULL, *mem;
+    int i, nblocks = 0, orig_fd, cached_index = -1;
+    size_t bs = (size_t) fh->f_fs_block_size, len, n;
+    OMPI_MPI_OFFSET_TYPE off, blk, cur_blk = -1, prev_end = 0;
+    ssize_t ret = 0, total = 0, got;
+
+    if (!(fh->f_flags & OMPIO_DIRECT_IO) || 0 > fh->f_direct_fd || 0 == num_entries) {
+        return fh->f_fbtl->fbtl_pwritev (fh);
+    }
+
+    for (i = 0 ; i < num_entries ; i++) {
+        off = (OMPI_MPI_OFFSET_TYPE)(intptr_t) io_array[i].offset;
+        if (off < prev_end) {
+            return fh->f_fbtl->fbtl_pwritev (fh);
+        }
+        prev_end = off + io_array[i].length;
+    }
+
+    for (i = 0 ; i < num_entries ; i++) {
+        off = (OMPI_MPI_OFFSET_TYPE)(intptr_t) io_array[i].offset;
+        mem = (char *) io_array[i].memory_address;
+        len = io_array[i].length;
+        total += len;
+
+        while (0 < len) {
+            blk = OMPIO_DIRECT_ALIGN_DOWN(fh, off);
+            if (off == blk && len >= bs && 0 == ((uintptr_t) mem % bs)) {
+                n = len - (len % bs);
+                ret = direct_io_array_add (&direct, mem, off, n);
+                if (OMPI_SUCCESS != ret) {
+                    goto exit;
+                }
+            }
+            else {
+                n = OMPIO_MIN(len, (size_t)(blk + bs - off));
+                if (blk != cur_blk) {
+                    char **tmp = (char **) realloc (blocks, (nblocks + 1) * sizeof (char *));
+                    if (NULL == tmp) {
+                        ret = OMPI_ERR_OUT_OF_RESOURCE;
+                        goto exit;
+                    }
+                    blocks = tmp;
+                    if (0 != posix_memalign ((void **) &block, bs, bs)) {
+                        ret = OMPI_ERR_OUT_OF_RESOURCE;
+                        goto exit;
+                    }
+                    blocks[nblocks++] = block;
+                    cur_blk = blk;
+
+                    got = bs;
+                    if (n < bs) {
+                        got = direct_read_block (fh->f_direct_fd, block, bs, blk);
+                        if (0 > got) {
+                            opal_output (1, "mca_common_ompio_file_write_direct: reading block at %lld failed: %s",
+                                         (long long) blk, strerror(errno));
+                            ret = OMPI_ERROR;
+                            goto exit;
+                        }
+                    }
+                    if ((size_t) got < bs) {
+                        /* length grows with the pieces added to the block */
+                        ret = direct_io_array_add (&cached, block, blk, 0);
+                        cached_index = cached.count - 1;
+                    }
+                    else {
+                        ret = direct_io_array_add (&direct, block, blk, bs);
+                        cached_index = -1;
+                    }
+                    if (OMPI_SUCCESS != ret) {
+                        goto exit;
+                    }
+                }
+                memcpy (block + (off - blk), mem, n);
+                if (0 <= cached_index && cached.entries[cached_index].length < (size_t)(off + n - blk)) {
+                    cached.entries[cached_index].length = off + n - blk;
+                }
+            }
+            off += n;
+            mem += n;
+            len -= n;
+        }
+    }
+
+    orig_fd = fh->fd;
+    if (0 < direct.count) {
+        fh->f_io_array = direct.entries;
+        fh->f_num_of_io_entries = direct.count;
+        fh->fd = fh->f_direct_fd;
+        ret = fh->f_fbtl->fbtl_pwritev (fh);
+        fh->fd = orig_fd;
+    }
+    if (0 <= ret && 0 < cached.count) {
+        fh->f_io_array = cached.entries;
+        fh->f_num_of_io_entries = cached.count;
+        ret = fh->f_fbtl->fbtl_pwritev (fh);
+    }
+    fh->f_io_array = io_array;
+    fh->f_num_of_io_entries = num_entries;
+
+    if (0 <= ret) {
+        ret = total;
+    }
+
+exit:
+    for (i = 0 ; i < nblocks ; i++) {
+        free (blocks[i]);
+    }
+    free (blocks);
+    free (direct.entries);
+    free (cached.entries);
+
+    return ret;
+}
@@ -31,6 +31,8 @@
 
 #include "ompi_config.h"
 
+#include <fcntl.h>
+
 #include "mpi.h"
 #include "opal/mca/base/base.h"
 #include "ompi/mca/common/ompio/common_ompio.h"
@@ -50,6 +52,15 @@ OMPI_DECLSPEC int mca_fbtl_base_find_available(bool enable_progress_threads,
 OMPI_DECLSPEC int mca_fbtl_base_init_file (struct ompio_file_t *file);
 
 OMPI_DECLSPEC int mca_fbtl_base_get_param (struct ompio_file_t *file, int keyval);
+
+/*
+ * Range locking shared by the fbtl components (and by anything else
+ * writing to fh->fd behind the fbtl's back). The fs component decides
+ * through fh->f_flags whether and how much has to be locked.
+ */
+OMPI_DECLSPEC int mca_fbtl_base_file_lock (struct flock *lock, struct ompio_file_t *fh, int op,
+                                           OMPI_MPI_OFFSET_TYPE offset, off_t len, int flags);
+OMPI_DECLSPEC void mca_fbtl_base_file_unlock (struct flock *lock, struct ompio_file_t *fh);
 /*
  * Globals
  */
@@ -20,15 +20,16 @@
  */
 
 #include "ompi_config.h"
-#include "fbtl_posix.h"
 
 #include "mpi.h"
+#include <fcntl.h>
 #include <unistd.h>
 #include <sys/uio.h>
 #include <errno.h>
 #include <limits.h>
 #include "ompi/constants.h"
 #include "ompi/mca/fbtl/fbtl.h"
+#include "ompi/mca/fbtl/base/base.h"
 
 #define MAX_ERRCOUNT 100
 
@@ -43,8 +44,8 @@
   Support for MPI atomicity operations are envisioned, but not yet tested.
 */
 
-int mca_fbtl_posix_lock ( struct flock *lock, ompio_file_t *fh, int op, 
-                          OMPI_MPI_OFFSET_TYPE offset, off_t len, int flags)
+int mca_fbtl_base_file_lock ( struct flock *lock, ompio_file_t *fh, int op,
+                              OMPI_MPI_OFFSET_TYPE offset, off_t len, int flags)
 {
     off_t lmod, bmod;
     int ret, err_count;
@@ -133,7 +134,7 @@ int mca_fbtl_posix_lock ( struct flock *lock, ompio_file_t *fh, int op,
     return ret;
 }
 
-void  mca_fbtl_posix_unlock ( struct flock *lock, ompio_file_t *fh )
+void mca_fbtl_base_file_unlock ( struct flock *lock, ompio_file_t *fh )
 {
     if ( -1 == lock->l_start && -1 == lock->l_len ) {
         return;
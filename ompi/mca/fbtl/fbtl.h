@@ -135,6 +135,13 @@ typedef bool (*mca_fbtl_base_module_progress_fn_t)
 
 typedef void (*mca_fbtl_base_module_request_free_fn_t)
     ( struct mca_ompio_request_t *request);
+
+/* optional: pin a buffer used by many operations of the file, such as
+ * the aggregation buffers of the fcoll components */
+typedef int (*mca_fbtl_base_module_register_buffer_fn_t)
+    ( struct ompio_file_t *file, void *buf, size_t len);
+typedef int (*mca_fbtl_base_module_unregister_buffer_fn_t)
+    ( struct ompio_file_t *file, void *buf);
 /*
  * ***********************************************************************
  * ***************************  module structure *************************
@@ -156,6 +163,8 @@ struct mca_fbtl_base_module_1_0_0_t {
     mca_fbtl_base_module_ipwritev_fn_t      fbtl_ipwritev;
     mca_fbtl_base_module_progress_fn_t      fbtl_progress;
     mca_fbtl_base_module_request_free_fn_t  fbtl_request_free;
+    mca_fbtl_base_module_register_buffer_fn_t   fbtl_register_buffer;
+    mca_fbtl_base_module_unregister_buffer_fn_t fbtl_unregister_buffer;
 };
 typedef struct mca_fbtl_base_module_1_0_0_t mca_fbtl_base_module_1_0_0_t;
 typedef mca_fbtl_base_module_1_0_0_t mca_fbtl_base_module_t;
@@ -0,0 +1,49 @@
+# -*- shell-script -*-
+#
+# $COPYRIGHT$
+#
+# Additional copyrights may follow
+#
+# $HEADER$
+#
+
+# MCA_fbtl_io_uring_CONFIG(action-if-can-compile,
+#                        [action-if-cant-compile])
+# ------------------------------------------------
+AC_DEFUN([MCA_ompi_fbtl_io_uring_CONFIG],[
+    AC_CONFIG_FILES([ompi/mca/fbtl/io_uring/Makefile])
+
+    AC_ARG_WITH([io-uring],
+        [AC_HELP_STRING([--with-io-uring(=DIR)],
+             [Build io_uring support in the fbtl framework, optionally adding DIR/include, DIR/lib, and DIR/lib64 to the search path for headers and libraries])])
+    OPAL_CHECK_WITHDIR([io-uring], [$with_io_uring], [include/liburing.h])
+
+    fbtl_io_uring_happy="no"
+    fbtl_io_uring_dir=
+    fbtl_io_uring_libdir=
+
+    AS_IF([test "$with_io_uring" != "no"],
+          [AS_IF([test -n "$with_io_uring" && test "$with_io_uring" != "yes"],
+                 [fbtl_io_uring_dir="$with_io_uring"
+                  AS_IF([test -d "$with_io_uring/lib64"],
+                        [fbtl_io_uring_libdir="$with_io_uring/lib64"],
+                        [fbtl_io_uring_libdir="$with_io_uring/lib"])])
+
+           OPAL_CHECK_PACKAGE([fbtl_io_uring], [liburing.h], [uring], [io_uring_register_buffers_sparse], [],
+                              [$fbtl_io_uring_dir], [$fbtl_io_uring_libdir],
+                              [fbtl_io_uring_happy="yes"],
+                              [fbtl_io_uring_happy="no"])])
+
+    AS_IF([test "$fbtl_io_uring_happy" = "no" && test -n "$with_io_uring" && test "$with_io_uring" != "no"],
+          [AC_MSG_WARN([io_uring support requested but not found])
+           AC_MSG_ERROR([Cannot continue])])
+
+    AS_IF([test "$fbtl_io_uring_happy" = "yes"],
+          [$1],
+          [$2])
+
+    # substitute in the things needed to build io_uring
+    AC_SUBST([fbtl_io_uring_CPPFLAGS])
+    AC_SUBST([fbtl_io_uring_LDFLAGS])
+    AC_SUBST([fbtl_io_uring_LIBS])
+])dnl
@@ -0,0 +1,474 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * These symbols are in a file by themselves to provide nice linker
+ * semantics. Since linkers generally pull in symbols by object fules,
+ * keeping these symbols as the only symbols in this file prevents
+ * utility programs such as "ompi_info" from having to import entire
+ * modules just to query their version and parameters
+ */
+
+#include "ompi_config.h"
+#include "mpi.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+#include "ompi/mca/fbtl/fbtl.h"
+#include "ompi/mca/fbtl/io_uring/fbtl_io_uring.h"
+
+/*
+ * *******************************************************************
+ * ************************ actions structure ************************
+ * *******************************************************************
+ */
+static mca_fbtl_base_module_1_0_0_t io_uring =  {
+    mca_fbtl_io_uring_module_init,       /* initalise after being selected */
+    mca_fbtl_io_uring_module_finalize,   /* close a module on a communicator */
+    mca_fbtl_io_uring_preadv,            /* blocking read */
+    mca_fbtl_io_uring_ipreadv,           /* non-blocking read*/
+    mca_fbtl_io_uring_pwritev,           /* blocking write */
+    mca_fbtl_io_uring_ipwritev,          /* non-blocking write */
+    mca_fbtl_io_uring_progress,          /* module specific progress */
+    mca_fbtl_io_uring_request_free,      /* free module specific data items on the request */
+    mca_fbtl_io_uring_register_buffer,   /* pin a buffer used for many operations */
+    mca_fbtl_io_uring_unregister_buffer  /* release a pinned buffer */
+};
+/*
+ * *******************************************************************
+ * ************************* structure ends **************************
+ * *******************************************************************
+ */
+
+opal_mutex_t mca_fbtl_io_uring_ring_lock = OPAL_MUTEX_STATIC_INIT;
+
+/* the ring shared by all files of the process, protected by the ring lock */
+static struct io_uring fbtl_io_uring_ring;
+static int fbtl_io_uring_refcount = 0;
+static int fbtl_io_uring_depth = 0;
+static int fbtl_io_uring_inflight = 0;
+
+/* buffers registered with the ring. The ring gets a sparse table of
+ * FBTL_IO_URING_MAX_BUFS slots when it is created, and a buffer is pinned
+ * or released by updating its slot alone; a free slot has a NULL base */
+static struct iovec fbtl_io_uring_bufs[FBTL_IO_URING_MAX_BUFS];
+static bool fbtl_io_uring_bufs_registered = false;
+
+int mca_fbtl_io_uring_component_init_query(bool enable_progress_threads,
+                                           bool enable_mpi_threads)
+{
+    struct io_uring ring;
+
+    /* liburing might be present while the running kernel does not
+     * support io_uring, or forbids it */
+    if (0 != io_uring_queue_init (1, &ring, 0)) {
+        return OMPI_ERR_NOT_AVAILABLE;
+    }
+    io_uring_queue_exit (&ring);
+
+    return OMPI_SUCCESS;
+}
+
+struct mca_fbtl_base_module_1_0_0_t *
+mca_fbtl_io_uring_component_file_query (ompio_file_t *fh, int *priority)
+{
+    *priority = mca_fbtl_io_uring_priority;
+
+    /* io_uring works on file descriptors, like the posix component */
+    if (UFS != fh->f_fstype && LUSTRE != fh->f_fstype) {
+        return NULL;
+    }
+
+    return &io_uring;
+}
+
+int mca_fbtl_io_uring_component_file_unquery (ompio_file_t *file)
+{
+   /* This function might be needed for some purposes later. for now it
+    * does not have anything to do since there are no steps which need
+    * to be undone if this module is not selected */
+
+   return OMPI_SUCCESS;
+}
+
+int mca_fbtl_io_uring_module_init (ompio_file_t *file)
+{
+    int ret = OMPI_SUCCESS;
+
+    OPAL_THREAD_LOCK(&mca_fbtl_io_uring_ring_lock);
+    if (0 == fbtl_io_uring_refcount) {
+        fbtl_io_uring_depth = (0 < mca_fbtl_io_uring_queue_depth) ? mca_fbtl_io_uring_queue_depth : 1;
+        ret = io_uring_queue_init (fbtl_io_uring_depth, &fbtl_io_uring_ring, 0);
+        if (0 != ret) {
+            opal_output (1, "mca_fbtl_io_uring_module_init: io_uring_queue_init failed: %s",
+                         strerror(-ret));
+            ret = OMPI_ERROR;
+        }
+        fbtl_io_uring_inflight = 0;
+
+        memset (fbtl_io_uring_bufs, 0, sizeof (fbtl_io_uring_bufs));
+        fbtl_io_uring_bufs_registered = false;
+        if (OMPI_SUCCESS == ret && mca_fbtl_io_uring_register_buffers) {
+            /* kernels older than 5.19 do not know sparse tables, the
+             * buffers are then used with regular operations */
+            fbtl_io_uring_bufs_registered =
+                (0 == io_uring_register_buffers_sparse (&fbtl_io_uring_ring, FBTL_IO_URING_MAX_BUFS));
+        }
+    }
+    if (OMPI_SUCCESS == ret) {
+        fbtl_io_uring_refcount++;
+    }
+    OPAL_THREAD_UNLOCK(&mca_fbtl_io_uring_ring_lock);
+
+    return ret;
+}
+
+int mca_fbtl_io_uring_module_finalize (ompio_file_t *file)
+{
+    OPAL_THREAD_LOCK(&mca_fbtl_io_uring_ring_lock);
+    if (0 == --fbtl_io_uring_refcount) {
+        /* the ring drops the registered buffers with it */
+        io_uring_queue_exit (&fbtl_io_uring_ring);
+        fbtl_io_uring_bufs_registered = false;
+    }
+    OPAL_THREAD_UNLOCK(&mca_fbtl_io_uring_ring_lock);
+
+    return OMPI_SUCCESS;
+}
+
+mca_fbtl_io_uring_request_data_t *
+mca_fbtl_io_uring_data_create (ompio_file_t *fh, int type)
+{
+    mca_fbtl_io_uring_request_data_t *data;
+    int i;
+
+    data = (mca_fbtl_io_uring_request_data_t *) malloc (sizeof (mca_fbtl_io_uring_request_data_t));
+    if (NULL == data) {
+        return NULL;
+    }
+
+    /* the caller is free to release f_io_array once the operation is
+     * posted, keep a copy of it */
+    data->ur_entries = (mca_fbtl_io_uring_entry_t *) malloc (sizeof (mca_fbtl_io_uring_entry_t) *
+                                                              (fh->f_num_of_io_entries + 1));
+    if (NULL == data->ur_entries) {
+        free (data);
+        return NULL;
+    }
+
+    for (i = 0 ; i < fh->f_num_of_io_entries ; i++) {
+        data->ur_entries[i].ue_data   = data;
+        data->ur_entries[i].ue_buf    = (char *) fh->f_io_array[i].memory_address;
+        data->ur_entries[i].ue_offset = (off_t)(intptr_t) fh->f_io_array[i].offset;
+        data->ur_entries[i].ue_len    = fh->f_io_array[i].length;
+        data->ur_entries[i].ue_done   = 0;
+    }
+
+    data->ur_req_type  = type;
+    data->ur_count     = fh->f_num_of_io_entries;
+    data->ur_next      = 0;
+    data->ur_open      = 0;
+    data->ur_error     = 0;
+    data->ur_total_len = 0;
+    data->ur_lock.l_start = -1;
+    data->ur_lock.l_len   = -1;
+    data->ur_fh        = fh;
+
+    return data;
+}
+
+void mca_fbtl_io_uring_data_free (mca_fbtl_io_uring_request_data_t *data)
+{
+    free (data->ur_entries);
+    free (data);
+}
+
+static int fbtl_io_uring_find_buffer (char *buf, size_t len)
+{
+    if (!fbtl_io_uring_bufs_registered) {
+        return -1;
+    }
+
+    for (int i = 0 ; i < FBTL_IO_URING_MAX_BUFS ; i++) {
+        char *base = (char *) fbtl_io_uring_bufs[i].iov_base;
+        if (NULL != base && buf >= base && buf + len <= base + fbtl_io_uring_bufs[i].iov_len) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/*
+ * Queue the not yet transferred part of an entry. The caller made sure
+ * that a submission slot is available.
+ */
+static int fbtl_io_uring_prep (mca_fbtl_io_uring_entry_t *entry)
+{
+    struct io_uring_sqe *sqe;
+    size_t len;
+    char *buf;
+    off_t offset;
+    int index;
+
+    sqe = io_uring_get_sqe (&fbtl_io_uring_ring);
+    if (NULL == sqe) {
+        return OMPI_ERR_TEMP_OUT_OF_RESOURCE;
+    }
+
+    buf    = entry->ue_buf + entry->ue_done;
+    offset = entry->ue_offset + (off_t) entry->ue_done;
+    len    = entry->ue_len - entry->ue_done;
+    if (len > FBTL_IO_URING_MAX_CHUNK) {
+        len = FBTL_IO_URING_MAX_CHUNK;
+    }
+
+    index = fbtl_io_uring_find_buffer (buf, len);
+    if (FBTL_IO_URING_READ == entry->ue_data->ur_req_type) {
+        if (0 <= index) {
+            io_uring_prep_read_fixed (sqe, entry->ue_data->ur_fh->fd, buf, (unsigned) len, offset, index);
+        } else {
+            entry->ue_iov.iov_base = buf;
+            entry->ue_iov.iov_len  = len;
+            io_uring_prep_readv (sqe, entry->ue_data->ur_fh->fd, &entry->ue_iov, 1, offset);
+        }
+    } else {
+        if (0 <= index) {
+            io_uring_prep_write_fixed (sqe, entry->ue_data->ur_fh->fd, buf, (unsigned) len, offset, index);
+        } else {
+            entry->ue_iov.iov_base = buf;
+            entry->ue_iov.iov_len  = len;
+            io_uring_prep_writev (sqe, entry->ue_data->ur_fh->fd, &entry->ue_iov, 1, offset);
+        }
+    }
+    io_uring_sqe_set_data (sqe, entry);
+
+    fbtl_io_uring_inflight++;
+    entry->ue_data->ur_open++;
+
+    return OMPI_SUCCESS;
+}
+
+static int fbtl_io_uring_flush (void)
+{
+    int ret = io_uring_submit (&fbtl_io_uring_ring);
+
+    /* entries not taken by the kernel stay in the submission queue
+     * and go with the next submission */
+    if (0 > ret && -EINTR != ret && -EAGAIN != ret && -EBUSY != ret) {
+        opal_output (1, "mca_fbtl_io_uring: io_uring_submit failed: %s", strerror(-ret));
+        return OMPI_ERROR;
+    }
+
+    return OMPI_SUCCESS;
+}
+
+/*
+ * Queue as many entries of the request as the ring allows and hand them
+ * to the kernel with a single system call, together with whatever an
+ * earlier submission left in the submission queue.
+ */
+int mca_fbtl_io_uring_submit (mca_fbtl_io_uring_request_data_t *data)
+{
+    int ret;
+
+    while (data->ur_next < data->ur_count && fbtl_io_uring_inflight < fbtl_io_uring_depth) {
+        if (0 < data->ur_entries[data->ur_next].ue_len) {
+            ret = fbtl_io_uring_prep (&data->ur_entries[data->ur_next]);
+            if (OMPI_SUCCESS != ret) {
+                break;
+            }
+        }
+        data->ur_next++;
+    }
+
+    return (0 < io_uring_sq_ready (&fbtl_io_uring_ring)) ? fbtl_io_uring_flush () : OMPI_SUCCESS;
+}
+
+/*
+ * Account all available completions to the requests owning them. If
+ * wait is set and operations are in flight, block until at least one
+ * of them completes. Returns the number of completions or an error.
+ */
+int mca_fbtl_io_uring_reap (bool wait)
+{
+    mca_fbtl_io_uring_request_data_t *data;
+    mca_fbtl_io_uring_entry_t *entry;
+    struct io_uring_cqe *cqe;
+    int ret, res, count = 0, requeued = 0;
+
+    if (wait && 0 < fbtl_io_uring_inflight) {
+        ret = io_uring_submit_and_wait (&fbtl_io_uring_ring, 1);
+        if (0 > ret && -EINTR != ret && -EAGAIN != ret && -EBUSY != ret) {
+            opal_output (1, "mca_fbtl_io_uring_reap: io_uring_submit_and_wait failed: %s",
+                         strerror(-ret));
+            return OMPI_ERROR;
+        }
+    }
+
+    while (0 == io_uring_peek_cqe (&fbtl_io_uring_ring, &cqe)) {
+        entry = (mca_fbtl_io_uring_entry_t *) io_uring_cqe_get_data (cqe);
+        res = cqe->res;
+        io_uring_cqe_seen (&fbtl_io_uring_ring, cqe);
+        fbtl_io_uring_inflight--;
+        count++;
+
+        data = entry->ue_data;
+        data->ur_open--;
+
+        if (-EINTR == res || -EAGAIN == res) {
+            res = 0;
+        } else if (0 > res) {
+            if (0 == data->ur_error) {
+                data->ur_error = -res;
+            }
+            continue;
+        } else if (0 == res && FBTL_IO_URING_READ == data->ur_req_type) {
+            /* end of file, the rest of the entry is not read */
+            continue;
+        }
+
+        entry->ue_done     += (size_t) res;
+        data->ur_total_len += res;
+        if (entry->ue_done < entry->ue_len && 0 == data->ur_error) {
+            /* short transfer or chunked entry, the slot freed by this
+             * completion is reused for the remainder */
+            if (OMPI_SUCCESS != fbtl_io_uring_prep (entry)) {
+                data->ur_error = EIO;
+                continue;
+            }
+            requeued++;
+        }
+    }
+
+    if (0 < requeued && OMPI_SUCCESS != fbtl_io_uring_flush ()) {
+        return OMPI_ERROR;
+    }
+
+    return count;
+}
+
+bool mca_fbtl_io_uring_progress ( mca_ompio_request_t *req)
+{
+    mca_fbtl_io_uring_request_data_t *data = (mca_fbtl_io_uring_request_data_t *) req->req_data;
+    bool done;
+
+    OPAL_THREAD_LOCK(&mca_fbtl_io_uring_ring_lock);
+    if (0 > mca_fbtl_io_uring_reap (false) && 0 == data->ur_error) {
+        data->ur_error = EIO;
+    }
+    if (0 == data->ur_error) {
+        if (OMPI_SUCCESS != mca_fbtl_io_uring_submit (data)) {
+            data->ur_error = EIO;
+        }
+    } else if (0 < io_uring_sq_ready (&fbtl_io_uring_ring)) {
+        /* entries of this or other requests the kernel did not take
+         * (EAGAIN/EBUSY) would otherwise never complete */
+        (void) fbtl_io_uring_flush ();
+    }
+    done = (0 == data->ur_open) && (0 != data->ur_error || data->ur_next == data->ur_count);
+    OPAL_THREAD_UNLOCK(&mca_fbtl_io_uring_ring_lock);
+
+    if (!done) {
+        return false;
+    }
+
+    mca_fbtl_base_file_unlock (&data->ur_lock, data->ur_fh);
+    req->req_ompi.req_status.MPI_ERROR = (0 == data->ur_error) ? OMPI_SUCCESS : OMPI_ERROR;
+    req->req_ompi.req_status._ucount = data->ur_total_len;
+
+    return true;
+}
+
+void mca_fbtl_io_uring_request_free ( mca_ompio_request_t *req)
+{
+    /* Free the fbtl specific data structures */
+    mca_fbtl_io_uring_request_data_t *data = (mca_fbtl_io_uring_request_data_t *) req->req_data;
+
+    if (NULL != data) {
+        /* the kernel still references the entries of a request freed
+         * before its completion */
+        OPAL_THREAD_LOCK(&mca_fbtl_io_uring_ring_lock);
+        while (0 < data->ur_open) {
+            if (0 > mca_fbtl_io_uring_reap (true)) {
+                break;
+            }
+        }
+        OPAL_THREAD_UNLOCK(&mca_fbtl_io_uring_ring_lock);
+
+        mca_fbtl_base_file_unlock (&data->ur_lock, data->ur_fh);
+        mca_fbtl_io_uring_data_free (data);
+        req->req_data = NULL;
+    }
+
+    return;
+}
+
+/*
+ * Pin a buffer into a free slot of the sparse table of the ring, or
+ * release a slot when buf is NULL. Only that slot is changed, the other
+ * registered buffers stay pinned.
+ */
+static int fbtl_io_uring_update_buffer (int slot, void *buf, size_t len)
+{
+    struct iovec iov = {.iov_base = buf, .iov_len = len};
+
+    if (1 != io_uring_register_buffers_update_tag (&fbtl_io_uring_ring, (unsigned) slot,
+                                                   &iov, NULL, 1)) {
+        return OMPI_ERROR;
+    }
+    fbtl_io_uring_bufs[slot] = iov;
+
+    return OMPI_SUCCESS;
+}
+
+int mca_fbtl_io_uring_register_buffer (ompio_file_t *file, void *buf, size_t len)
+{
+    int i, ret = OMPI_ERR_OUT_OF_RESOURCE;
+
+    if (NULL == buf || 0 == len) {
+        return OMPI_ERR_NOT_SUPPORTED;
+    }
+
+    OPAL_THREAD_LOCK(&mca_fbtl_io_uring_ring_lock);
+    if (!fbtl_io_uring_bufs_registered) {
+        OPAL_THREAD_UNLOCK(&mca_fbtl_io_uring_ring_lock);
+        return OMPI_ERR_NOT_SUPPORTED;
+    }
+    for (i = 0 ; i < FBTL_IO_URING_MAX_BUFS ; i++) {
+        if (NULL == fbtl_io_uring_bufs[i].iov_base) {
+            /* typically fails on the locked memory limit, the buffer is
+             * then used with regular operations */
+            ret = fbtl_io_uring_update_buffer (i, buf, len);
+            break;
+        }
+    }
+    OPAL_THREAD_UNLOCK(&mca_fbtl_io_uring_ring_lock);
+
+    return ret;
+}
+
+int mca_fbtl_io_uring_unregister_buffer (ompio_file_t *file, void *buf)
+{
+    int ret = OMPI_SUCCESS;
+
+    OPAL_THREAD_LOCK(&mca_fbtl_io_uring_ring_lock);
+    for (int i = 0 ; fbtl_io_uring_bufs_registered && i < FBTL_IO_URING_MAX_BUFS ; i++) {
+        if (fbtl_io_uring_bufs[i].iov_base == buf) {
+            /* operations still in flight keep their own reference */
+            ret = fbtl_io_uring_update_buffer (i, NULL, 0);
+            break;
+        }
+    }
+    OPAL_THREAD_UNLOCK(&mca_fbtl_io_uring_ring_lock);
+
+    return ret;
+}
@@ -0,0 +1,132 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#ifndef MCA_FBTL_IO_URING_H
+#define MCA_FBTL_IO_URING_H
+
+#include "ompi_config.h"
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <liburing.h>
+
+#include "opal/threads/mutex.h"
+#include "ompi/mca/mca.h"
+#include "ompi/mca/fbtl/fbtl.h"
+#include "ompi/mca/fbtl/base/base.h"
+#include "ompi/mca/common/ompio/common_ompio.h"
+#include "ompi/mca/common/ompio/common_ompio_request.h"
+
+BEGIN_C_DECLS
+
+/*
+ * The io_uring component posts all entries of fh->f_io_array to the
+ * kernel with a single system call and reaps their completions from
+ * the ompio progress function, instead of one aio_read/aio_write per
+ * entry polled with aio_error as done by the posix component.
+ *
+ * A single ring is shared by all files of the process. Requests of
+ * different files may complete out of order: every submission carries
+ * a pointer to its entry, and whoever reaps a completion accounts it
+ * to the request owning the entry. Buffers registered by the fcoll
+ * components (the aggregation buffers) are pinned in the kernel for as
+ * long as they are registered, each in its own slot of a sparse table,
+ * and accessed with the fixed-buffer read and write operations.
+ */
+
+extern int mca_fbtl_io_uring_priority;
+extern int mca_fbtl_io_uring_queue_depth;
+extern bool mca_fbtl_io_uring_register_buffers;
+
+int mca_fbtl_io_uring_component_init_query(bool enable_progress_threads,
+                                           bool enable_mpi_threads);
+struct mca_fbtl_base_module_1_0_0_t *
+mca_fbtl_io_uring_component_file_query (ompio_file_t *file, int *priority);
+int mca_fbtl_io_uring_component_file_unquery (ompio_file_t *file);
+
+int mca_fbtl_io_uring_module_init (ompio_file_t *file);
+int mca_fbtl_io_uring_module_finalize (ompio_file_t *file);
+
+OMPI_MODULE_DECLSPEC extern mca_fbtl_base_component_2_0_0_t mca_fbtl_io_uring_component;
+/*
+ * ******************************************************************
+ * ********* functions which are implemented in this module *********
+ * ******************************************************************
+ */
+
+ssize_t mca_fbtl_io_uring_preadv (ompio_file_t *file );
+ssize_t mca_fbtl_io_uring_pwritev (ompio_file_t *file );
+ssize_t mca_fbtl_io_uring_ipreadv (ompio_file_t *file,
+                                   ompi_request_t *request);
+ssize_t mca_fbtl_io_uring_ipwritev (ompio_file_t *file,
+                                    ompi_request_t *request);
+
+bool mca_fbtl_io_uring_progress     ( mca_ompio_request_t *req);
+void mca_fbtl_io_uring_request_free ( mca_ompio_request_t *req);
+
+int mca_fbtl_io_uring_register_buffer (ompio_file_t *file, void *buf, size_t len);
+int mca_fbtl_io_uring_unregister_buffer (ompio_file_t *file, void *buf);
+
+/* define constants for io_uring requests */
+#define FBTL_IO_URING_READ 1
+#define FBTL_IO_URING_WRITE 2
+
+/* slots of the registered buffer table, enough for the aggregation
+ * buffers of a few files open at the same time */
+#define FBTL_IO_URING_MAX_BUFS 64
+
+/* largest length handed to a single submission, longer entries are
+ * completed in several submissions */
+#define FBTL_IO_URING_MAX_CHUNK (1 << 30)
+
+struct mca_fbtl_io_uring_request_data_t;
+
+/* one entry of the io array of a request */
+struct mca_fbtl_io_uring_entry_t {
+    struct mca_fbtl_io_uring_request_data_t *ue_data; /* request owning the entry */
+    char          *ue_buf;              /* memory address */
+    off_t          ue_offset;           /* file offset */
+    size_t         ue_len;              /* total length */
+    size_t         ue_done;             /* bytes transferred so far */
+    struct iovec   ue_iov;              /* vector of the submission in flight */
+};
+typedef struct mca_fbtl_io_uring_entry_t mca_fbtl_io_uring_entry_t;
+
+struct mca_fbtl_io_uring_request_data_t {
+    int            ur_req_type;         /* read or write */
+    int            ur_count;            /* number of entries */
+    int            ur_next;             /* first entry not yet submitted */
+    int            ur_open;             /* submitted and not yet completed */
+    int            ur_error;            /* first error encountered, 0 if none */
+    ssize_t        ur_total_len;        /* total amount of data transferred */
+    struct flock   ur_lock;             /* lock used for certain file systems */
+    ompio_file_t  *ur_fh;               /* pointer back to the file handle */
+    mca_fbtl_io_uring_entry_t *ur_entries; /* private copy of the io array */
+};
+typedef struct mca_fbtl_io_uring_request_data_t mca_fbtl_io_uring_request_data_t;
+
+/* internal functions shared by the blocking and non-blocking operations,
+ * to be called with the ring lock held */
+extern opal_mutex_t mca_fbtl_io_uring_ring_lock;
+
+mca_fbtl_io_uring_request_data_t *
+mca_fbtl_io_uring_data_create (ompio_file_t *fh, int type);
+void mca_fbtl_io_uring_data_free (mca_fbtl_io_uring_request_data_t *data);
+int mca_fbtl_io_uring_submit (mca_fbtl_io_uring_request_data_t *data);
+int mca_fbtl_io_uring_reap (bool wait);
+
+/*
+ * ******************************************************************
+ * ************ functions implemented in this module end ************
+ * ******************************************************************
+ */
+
+END_C_DECLS
+
+#endif /* MCA_FBTL_IO_URING_H */
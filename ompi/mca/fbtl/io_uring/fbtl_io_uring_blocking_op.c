@@ -0,0 +1,112 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+#include "fbtl_io_uring.h"
+
+#include <string.h>
+#include <errno.h>
+
+#include "mpi.h"
+#include "ompi/constants.h"
+#include "ompi/mca/fbtl/fbtl.h"
+
+static ssize_t mca_fbtl_io_uring_blocking_op (ompio_file_t *fh, int type);
+
+ssize_t mca_fbtl_io_uring_preadv (ompio_file_t *fh)
+{
+    return mca_fbtl_io_uring_blocking_op (fh, FBTL_IO_URING_READ);
+}
+
+ssize_t mca_fbtl_io_uring_pwritev (ompio_file_t *fh)
+{
+    return mca_fbtl_io_uring_blocking_op (fh, FBTL_IO_URING_WRITE);
+}
+
+/*
+ * All entries of the io array are handed to the kernel at once, as far
+ * as the ring allows, and the remaining ones are submitted as
+ * completions free up room.
+ */
+static ssize_t mca_fbtl_io_uring_blocking_op (ompio_file_t *fh, int type)
+{
+    mca_fbtl_io_uring_request_data_t *data;
+    OMPI_MPI_OFFSET_TYPE start_offset, end_offset, offset;
+    ssize_t total_length;
+    int i, ret = OMPI_SUCCESS;
+
+    if (NULL == fh->f_io_array || 0 == fh->f_num_of_io_entries) {
+        return 0;
+    }
+
+    data = mca_fbtl_io_uring_data_create (fh, type);
+    if (NULL == data) {
+        opal_output (1, "mca_fbtl_io_uring_blocking_op: could not allocate memory");
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+
+    start_offset = (OMPI_MPI_OFFSET_TYPE)(intptr_t) fh->f_io_array[0].offset;
+    end_offset   = start_offset + fh->f_io_array[0].length;
+    for (i = 1 ; i < fh->f_num_of_io_entries ; i++) {
+        offset = (OMPI_MPI_OFFSET_TYPE)(intptr_t) fh->f_io_array[i].offset;
+        if (offset < start_offset) {
+            start_offset = offset;
+        }
+        if (offset + (OMPI_MPI_OFFSET_TYPE) fh->f_io_array[i].length > end_offset) {
+            end_offset = offset + fh->f_io_array[i].length;
+        }
+    }
+
+    ret = mca_fbtl_base_file_lock (&data->ur_lock, fh,
+                                  (FBTL_IO_URING_READ == type) ? F_RDLCK : F_WRLCK,
+                                  start_offset, (off_t)(end_offset - start_offset),
+                                  OMPIO_LOCK_ENTIRE_REGION);
+    if (0 < ret) {
+        opal_output (1, "mca_fbtl_io_uring_blocking_op: error in mca_fbtl_base_file_lock():%s",
+                     strerror(errno));
+        mca_fbtl_base_file_unlock (&data->ur_lock, fh);
+        mca_fbtl_io_uring_data_free (data);
+        return OMPI_ERROR;
+    }
+
+    OPAL_THREAD_LOCK(&mca_fbtl_io_uring_ring_lock);
+    ret = mca_fbtl_io_uring_submit (data);
+    while (0 < data->ur_open ||
+           (OMPI_SUCCESS == ret && 0 == data->ur_error && data->ur_next < data->ur_count)) {
+        /* waits for operations of other requests as well if the ring
+         * is full with them */
+        if (0 > mca_fbtl_io_uring_reap (true)) {
+            ret = OMPI_ERROR;
+            break;
+        }
+        if (OMPI_SUCCESS == ret && 0 == data->ur_error) {
+            ret = mca_fbtl_io_uring_submit (data);
+        }
+    }
+    OPAL_THREAD_UNLOCK(&mca_fbtl_io_uring_ring_lock);
+
+    mca_fbtl_base_file_unlock (&data->ur_lock, fh);
+
+    if (OMPI_SUCCESS != ret || 0 != data->ur_error) {
+        opal_output (1, "mca_fbtl_io_uring_blocking_op: error in %s: %s",
+                     (FBTL_IO_URING_READ == type) ? "read" : "write",
+                     strerror((0 != data->ur_error) ? data->ur_error : EIO));
+        if (0 < data->ur_open) {
+            /* the kernel still references the entries, do not free them */
+            return OMPI_ERROR;
+        }
+        mca_fbtl_io_uring_data_free (data);
+        return OMPI_ERROR;
+    }
+
+    total_length = data->ur_total_len;
+    mca_fbtl_io_uring_data_free (data);
+
+    return total_length;
+}
@@ -0,0 +1,95 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ *
+ * These symbols are in a file by themselves to provide nice linker
+ * semantics.  Since linkers generally pull in symbols by object
+ * files, keeping these symbols as the only symbols in this file
+ * prevents utility programs such as "ompi_info" from having to import
+ * entire components just to query their version and parameters.
+ */
+
+#include "ompi_config.h"
+#include "fbtl_io_uring.h"
+#include "mpi.h"
+
+/*
+ * Private functions
+ */
+static int register_component(void);
+
+/*
+ * Public string showing the fbtl io_uring component version number
+ */
+const char *mca_fbtl_io_uring_component_version_string =
+  "OMPI/MPI io_uring FBTL MCA component version " OMPI_VERSION;
+
+int mca_fbtl_io_uring_priority = 10;
+int mca_fbtl_io_uring_queue_depth = 256;
+bool mca_fbtl_io_uring_register_buffers = true;
+
+/*
+ * Instantiate the public struct with all of our public information
+ * and pointers to our public functions in it
+ */
+mca_fbtl_base_component_2_0_0_t mca_fbtl_io_uring_component = {
+
+    /* First, the mca_component_t struct containing meta information
+       about the component itself */
+
+    .fbtlm_version = {
+        MCA_FBTL_BASE_VERSION_2_0_0,
+
+        /* Component name and version */
+        .mca_component_name = "io_uring",
+        MCA_BASE_MAKE_VERSION(component, OMPI_MAJOR_VERSION, OMPI_MINOR_VERSION,
+                              OMPI_RELEASE_VERSION),
+        .mca_register_component_params = register_component,
+    },
+    .fbtlm_data = {
+        /* This component is checkpointable */
+      MCA_BASE_METADATA_PARAM_CHECKPOINT
+    },
+    .fbtlm_init_query = mca_fbtl_io_uring_component_init_query,      /* get thread level */
+    .fbtlm_file_query = mca_fbtl_io_uring_component_file_query,      /* get priority and actions */
+    .fbtlm_file_unquery = mca_fbtl_io_uring_component_file_unquery,  /* undo what was done by previous function */
+};
+
+static int register_component(void)
+{
+    mca_fbtl_io_uring_priority = 10;
+    (void) mca_base_component_var_register(&mca_fbtl_io_uring_component.fbtlm_version,
+                                           "priority", "Priority of the io_uring fbtl component. "
+                                           "The posix component uses 50 on UFS file systems, set a "
+                                           "higher value to use io_uring there",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                           OPAL_INFO_LVL_9,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &mca_fbtl_io_uring_priority);
+
+    mca_fbtl_io_uring_queue_depth = 256;
+    (void) mca_base_component_var_register(&mca_fbtl_io_uring_component.fbtlm_version,
+                                           "queue_depth", "Number of entries of the submission queue, "
+                                           "which is also the maximum number of operations in flight "
+                                           "for all files of a process",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                           OPAL_INFO_LVL_9,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &mca_fbtl_io_uring_queue_depth);
+
+    mca_fbtl_io_uring_register_buffers = true;
+    (void) mca_base_component_var_register(&mca_fbtl_io_uring_component.fbtlm_version,
+                                           "register_buffers", "Pin the aggregation buffers of the "
+                                           "collective I/O components in the kernel and use fixed-buffer "
+                                           "operations for them",
+                                           MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0,
+                                           OPAL_INFO_LVL_9,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &mca_fbtl_io_uring_register_buffers);
+
+    return OMPI_SUCCESS;
+}
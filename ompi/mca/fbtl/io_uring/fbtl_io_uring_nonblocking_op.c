@@ -0,0 +1,100 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+#include "fbtl_io_uring.h"
+
+#include <string.h>
+#include <errno.h>
+
+#include "mpi.h"
+#include "ompi/constants.h"
+#include "ompi/mca/fbtl/fbtl.h"
+
+static ssize_t mca_fbtl_io_uring_nonblocking_op (ompio_file_t *fh,
+                                                 ompi_request_t *request, int type);
+
+ssize_t mca_fbtl_io_uring_ipreadv (ompio_file_t *fh, ompi_request_t *request)
+{
+    return mca_fbtl_io_uring_nonblocking_op (fh, request, FBTL_IO_URING_READ);
+}
+
+ssize_t mca_fbtl_io_uring_ipwritev (ompio_file_t *fh, ompi_request_t *request)
+{
+    return mca_fbtl_io_uring_nonblocking_op (fh, request, FBTL_IO_URING_WRITE);
+}
+
+/*
+ * Submit the entries and leave the rest to the progress function, which
+ * reaps completions and submits the entries that did not fit in the
+ * ring.
+ */
+static ssize_t mca_fbtl_io_uring_nonblocking_op (ompio_file_t *fh,
+                                                 ompi_request_t *request, int type)
+{
+    mca_ompio_request_t *req = (mca_ompio_request_t *) request;
+    mca_fbtl_io_uring_request_data_t *data;
+    OMPI_MPI_OFFSET_TYPE start_offset, end_offset, offset;
+    int i, ret;
+
+    data = mca_fbtl_io_uring_data_create (fh, type);
+    if (NULL == data) {
+        opal_output (1, "mca_fbtl_io_uring_nonblocking_op: could not allocate memory");
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+
+    if (0 < fh->f_num_of_io_entries) {
+        start_offset = (OMPI_MPI_OFFSET_TYPE)(intptr_t) fh->f_io_array[0].offset;
+        end_offset   = start_offset + fh->f_io_array[0].length;
+        for (i = 1 ; i < fh->f_num_of_io_entries ; i++) {
+            offset = (OMPI_MPI_OFFSET_TYPE)(intptr_t) fh->f_io_array[i].offset;
+            if (offset < start_offset) {
+                start_offset = offset;
+            }
+            if (offset + (OMPI_MPI_OFFSET_TYPE) fh->f_io_array[i].length > end_offset) {
+                end_offset = offset + fh->f_io_array[i].length;
+            }
+        }
+
+        ret = mca_fbtl_base_file_lock (&data->ur_lock, fh,
+                                      (FBTL_IO_URING_READ == type) ? F_RDLCK : F_WRLCK,
+                                      start_offset, (off_t)(end_offset - start_offset),
+                                      OMPIO_LOCK_ENTIRE_REGION);
+        if (0 < ret) {
+            opal_output (1, "mca_fbtl_io_uring_nonblocking_op: error in mca_fbtl_base_file_lock() error ret=%d %s",
+                         ret, strerror(errno));
+            mca_fbtl_base_file_unlock (&data->ur_lock, fh);
+            mca_fbtl_io_uring_data_free (data);
+            return OMPI_ERROR;
+        }
+    }
+
+    OPAL_THREAD_LOCK(&mca_fbtl_io_uring_ring_lock);
+    ret = mca_fbtl_io_uring_submit (data);
+    if (OMPI_SUCCESS != ret && 0 < data->ur_open) {
+        /* some entries are in the kernel already, the request completes
+         * with an error once they are done */
+        data->ur_error = EIO;
+        ret = OMPI_SUCCESS;
+    }
+    OPAL_THREAD_UNLOCK(&mca_fbtl_io_uring_ring_lock);
+
+    if (OMPI_SUCCESS != ret) {
+        opal_output (1, "mca_fbtl_io_uring_nonblocking_op: could not submit the operations");
+        mca_fbtl_base_file_unlock (&data->ur_lock, fh);
+        mca_fbtl_io_uring_data_free (data);
+        return OMPI_ERROR;
+    }
+
+    req->req_data = data;
+    req->req_progress_fn = mca_fbtl_io_uring_progress;
+    req->req_free_fn     = mca_fbtl_io_uring_request_free;
+
+    return OMPI_SUCCESS;
+}
@@ -159,7 +159,7 @@ bool mca_fbtl_posix_progress ( mca_ompio_request_t *req)
 
     if ( (lcount == data->aio_req_chunks) && (0 != data->aio_open_reqs )) {
         /* release the lock of the previous operations */
-        mca_fbtl_posix_unlock ( &data->aio_lock, data->aio_fh );
+        mca_fbtl_base_file_unlock ( &data->aio_lock, data->aio_fh );
         
 	/* post the next batch of operations */
 	data->aio_first_active_req = data->aio_last_active_req;
@@ -175,15 +175,15 @@ bool mca_fbtl_posix_progress ( mca_ompio_request_t *req)
         total_length = (end_offset - start_offset);
 
         if ( FBTL_POSIX_READ == data->aio_req_type ) {
-            ret_code = mca_fbtl_posix_lock( &data->aio_lock, data->aio_fh, F_RDLCK, start_offset, total_length, OMPIO_LOCK_ENTIRE_REGION );
+            ret_code = mca_fbtl_base_file_lock( &data->aio_lock, data->aio_fh, F_RDLCK, start_offset, total_length, OMPIO_LOCK_ENTIRE_REGION );
         }
         else if ( FBTL_POSIX_WRITE == data->aio_req_type ) {
-            ret_code = mca_fbtl_posix_lock( &data->aio_lock, data->aio_fh, F_WRLCK, start_offset, total_length, OMPIO_LOCK_ENTIRE_REGION );
+            ret_code = mca_fbtl_base_file_lock( &data->aio_lock, data->aio_fh, F_WRLCK, start_offset, total_length, OMPIO_LOCK_ENTIRE_REGION );
         }
         if ( 0 < ret_code ) {
-            opal_output(1, "mca_fbtl_posix_progress: error in mca_fbtl_posix_lock() %d", ret_code);
+            opal_output(1, "mca_fbtl_posix_progress: error in mca_fbtl_base_file_lock() %d", ret_code);
             /* Just in case some part of the lock actually succeeded. */
-            mca_fbtl_posix_unlock ( &data->aio_lock, data->aio_fh );
+            mca_fbtl_base_file_unlock ( &data->aio_lock, data->aio_fh );
             return OMPI_ERROR;
         }
         
@@ -191,14 +191,14 @@ bool mca_fbtl_posix_progress ( mca_ompio_request_t *req)
 	    if ( FBTL_POSIX_READ == data->aio_req_type ) {
 		if (-1 == aio_read(&data->aio_reqs[i])) {
 		    opal_output(1, "mca_fbtl_posix_progress: error in aio_read()");
-                    mca_fbtl_posix_unlock ( &data->aio_lock, data->aio_fh );
+                    mca_fbtl_base_file_unlock ( &data->aio_lock, data->aio_fh );
 		    return OMPI_ERROR;
 		}
 	    }
 	    else if ( FBTL_POSIX_WRITE == data->aio_req_type ) {
 		if (-1 == aio_write(&data->aio_reqs[i])) {
 		    opal_output(1, "mca_fbtl_posix_progress: error in aio_write()");
-                    mca_fbtl_posix_unlock ( &data->aio_lock, data->aio_fh );
+                    mca_fbtl_base_file_unlock ( &data->aio_lock, data->aio_fh );
 		    return OMPI_ERROR;
 		}
 	    }
@@ -212,7 +212,7 @@ bool mca_fbtl_posix_progress ( mca_ompio_request_t *req)
 	/* all pending operations are finished for this request */
 	req->req_ompi.req_status.MPI_ERROR = OMPI_SUCCESS;
 	req->req_ompi.req_status._ucount = data->aio_total_len;
-        mca_fbtl_posix_unlock ( &data->aio_lock, data->aio_fh );
+        mca_fbtl_base_file_unlock ( &data->aio_lock, data->aio_fh );
 	ret = true;
     }
 #endif
@@ -225,7 +225,7 @@ void mca_fbtl_posix_request_free ( mca_ompio_request_t *req)
     /* Free the fbtl specific data structures */
     mca_fbtl_posix_request_data_t *data=(mca_fbtl_posix_request_data_t *)req->req_data;
     if (NULL != data ) {
-        mca_fbtl_posix_unlock ( &data->aio_lock, data->aio_fh );
+        mca_fbtl_base_file_unlock ( &data->aio_lock, data->aio_fh );
 	if ( NULL != data->aio_reqs ) {
 	    free ( data->aio_reqs);
 	}
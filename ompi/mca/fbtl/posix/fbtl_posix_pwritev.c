@@ -98,12 +98,12 @@ ssize_t  mca_fbtl_posix_pwritev(ompio_file_t *fh )
 	*/
 
         total_length = (end_offset - (off_t)iov_offset);
-        ret = mca_fbtl_posix_lock ( &lock, fh, F_WRLCK, iov_offset, total_length, OMPIO_LOCK_SELECTIVE ); 
+        ret = mca_fbtl_base_file_lock ( &lock, fh, F_WRLCK, iov_offset, total_length, OMPIO_LOCK_SELECTIVE ); 
         if ( 0 < ret ) {
-            opal_output(1, "mca_fbtl_posix_pwritev: error in mca_fbtl_posix_lock() error ret=%d %s", ret, strerror(errno));
+            opal_output(1, "mca_fbtl_posix_pwritev: error in mca_fbtl_base_file_lock() error ret=%d %s", ret, strerror(errno));
             free (iov); 
             /* just in case some part of the lock worked */
-            mca_fbtl_posix_unlock ( &lock, fh );
+            mca_fbtl_base_file_unlock ( &lock, fh );
             return OMPI_ERROR;
         }
 #if defined (HAVE_PWRITEV) 
@@ -112,12 +112,12 @@ ssize_t  mca_fbtl_posix_pwritev(ompio_file_t *fh )
 	if (-1 == lseek (fh->fd, iov_offset, SEEK_SET)) {
 	    opal_output(1, "mca_fbtl_posix_pwritev: error in lseek:%s", strerror(errno));
             free(iov);
-            mca_fbtl_posix_unlock ( &lock, fh );
+            mca_fbtl_base_file_unlock ( &lock, fh );
 	    return OMPI_ERROR;
 	}
 	ret_code = writev (fh->fd, iov, iov_count);
 #endif
-        mca_fbtl_posix_unlock ( &lock, fh );
+        mca_fbtl_base_file_unlock ( &lock, fh );
 	if ( 0 < ret_code ) {
 	    bytes_written += ret_code;
 	}
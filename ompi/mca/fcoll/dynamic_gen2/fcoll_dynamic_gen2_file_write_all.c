@@ -164,6 +164,10 @@ int mca_fcoll_dynamic_gen2_file_write_all (ompio_file_t *fh,
     /* since we want to overlap 2 iterations, define the bytes_per_cycle to be half of what
        the user requested */
     bytes_per_cycle =bytes_per_cycle/2;
+    if ( fh->f_flags & OMPIO_DIRECT_IO ) {
+        /* with O_DIRECT every cycle has to start on a block boundary */
+        bytes_per_cycle = OMPIO_MAX(OMPIO_DIRECT_ALIGN_DOWN(fh, bytes_per_cycle), fh->f_fs_block_size);
+    }
         
     ret =   mca_common_ompio_decode_datatype ((struct ompio_file_t *) fh,
                                               datatype,
@@ -207,6 +211,12 @@ int mca_fcoll_dynamic_gen2_file_write_all (ompio_file_t *fh,
     else {
         write_chunksize = mca_fcoll_dynamic_gen2_write_chunksize;
     }
+    if ( fh->f_flags & OMPIO_DIRECT_IO ) {
+        /* the stripes are the file domains of the aggregators, which may
+           not share a block of the file */
+        fh->f_stripe_size = OMPIO_DIRECT_ALIGN_UP(fh, fh->f_stripe_size);
+        write_chunksize = OMPIO_MAX(OMPIO_DIRECT_ALIGN_DOWN(fh, write_chunksize), fh->f_fs_block_size);
+    }
 
 
     ret = mca_fcoll_dynamic_gen2_get_configuration (fh, &dynamic_gen2_num_io_procs, &aggregators);
@@ -524,8 +534,19 @@ int mca_fcoll_dynamic_gen2_file_write_all (ompio_file_t *fh,
             }
         
             
-            aggr_data[i]->global_buf       = (char *) malloc (bytes_per_cycle);
-            aggr_data[i]->prev_global_buf  = (char *) malloc (bytes_per_cycle);
+            if ( fh->f_flags & OMPIO_DIRECT_IO ) {
+                /* O_DIRECT needs block aligned memory as well */
+                if ( 0 != posix_memalign ((void **) &aggr_data[i]->global_buf, fh->f_fs_block_size, bytes_per_cycle) ) {
+                    aggr_data[i]->global_buf = NULL;
+                }
+                if ( 0 != posix_memalign ((void **) &aggr_data[i]->prev_global_buf, fh->f_fs_block_size, bytes_per_cycle) ) {
+                    aggr_data[i]->prev_global_buf = NULL;
+                }
+            }
+            else {
+                aggr_data[i]->global_buf       = (char *) malloc (bytes_per_cycle);
+                aggr_data[i]->prev_global_buf  = (char *) malloc (bytes_per_cycle);
+            }
             if (NULL == aggr_data[i]->global_buf || NULL == aggr_data[i]->prev_global_buf){
                 opal_output(1, "OUT OF MEMORY");
                 ret = OMPI_ERR_OUT_OF_RESOURCE;
@@ -740,6 +761,7 @@ static int write_init (ompio_file_t *fh, int aggregator, mca_io_ompio_aggregator
     int ret=OMPI_SUCCESS;
     int last_array_pos=0;
     int last_pos=0;
+    ssize_t ret_temp=0;
         
 
     if ( aggregator == fh->f_rank && aggr_data->prev_num_io_entries) {
@@ -748,7 +770,13 @@ static int write_init (ompio_file_t *fh, int aggregator, mca_io_ompio_aggregator
                                                                                       aggr_data->prev_num_io_entries, 
                                                                                       &last_array_pos, &last_pos,
                                                                                       write_chunksize );
-            if ( 0 >  fh->f_fbtl->fbtl_pwritev (fh)) {
+            if ( fh->f_flags & OMPIO_DIRECT_IO ) {
+                ret_temp = mca_common_ompio_file_write_direct (fh);
+            }
+            else {
+                ret_temp = fh->f_fbtl->fbtl_pwritev (fh);
+            }
+            if ( 0 > ret_temp ) {
                 free ( aggr_data->prev_io_array);
                 opal_output (1, "dynamic_gen2_write_all: fbtl_pwritev failed\n");
                 ret = OMPI_ERROR;
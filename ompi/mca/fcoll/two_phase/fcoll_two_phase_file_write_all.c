@@ -35,6 +35,7 @@
 #include "math.h"
 #include "ompi/mca/pml/pml.h"
 #include <unistd.h>
+#include <stdlib.h>
 
 #define DEBUG_ON 0
 
@@ -456,6 +457,13 @@ mca_fcoll_two_phase_file_write_all (ompio_file_t *fh,
 #endif
 
 
+    if ( fh->f_flags & OMPIO_DIRECT_IO ) {
+        /* align the boundaries of the file domains to blocks, so that no
+           two aggregators write to the same block with O_DIRECT */
+        striping_unit = fh->f_fs_block_size;
+        domain_size = OMPIO_MAX(domain_size, fh->f_fs_block_size);
+    }
+
     ret = mca_fcoll_two_phase_domain_partition(fh,
 					       start_offsets,
 					       end_offsets,
@@ -619,6 +627,7 @@ static int two_phase_exch_and_write(ompio_file_t *fh,
     MPI_Aint buftype_extent;
     int  hole;
     int two_phase_cycle_buffer_size;
+    ssize_t ret_temp=0;
     size_t byte_size;
     MPI_Datatype byte = MPI_BYTE;
 #if DEBUG_ON
@@ -648,6 +657,10 @@ static int two_phase_exch_and_write(ompio_file_t *fh,
     }
 
     two_phase_cycle_buffer_size = fh->f_bytes_per_agg;
+    if ( fh->f_flags & OMPIO_DIRECT_IO ) {
+        two_phase_cycle_buffer_size = OMPIO_MAX(OMPIO_DIRECT_ALIGN_DOWN(fh, two_phase_cycle_buffer_size),
+                                                fh->f_fs_block_size);
+    }
     ntimes = (int) ((end_loc - st_loc + two_phase_cycle_buffer_size)/two_phase_cycle_buffer_size);
 
     if ((st_loc == -1) && (end_loc == -1)) {
@@ -663,7 +676,15 @@ static int two_phase_exch_and_write(ompio_file_t *fh,
 				       fh->f_comm->c_coll->coll_allreduce_module);
 
     if (ntimes){
-	write_buf = (char *) malloc (two_phase_cycle_buffer_size);
+	if ( fh->f_flags & OMPIO_DIRECT_IO ) {
+	    /* O_DIRECT needs block aligned memory as well */
+	    if ( 0 != posix_memalign ((void **) &write_buf, fh->f_fs_block_size, two_phase_cycle_buffer_size) ) {
+		write_buf = NULL;
+	    }
+	}
+	else {
+	    write_buf = (char *) malloc (two_phase_cycle_buffer_size);
+	}
 	if ( NULL == write_buf ){
 	    return OMPI_ERR_OUT_OF_RESOURCE;
 	}
@@ -863,7 +884,13 @@ static int two_phase_exch_and_write(ompio_file_t *fh,
 #endif
 
 	    if (fh->f_num_of_io_entries){
-		if ( 0 > fh->f_fbtl->fbtl_pwritev (fh)) {
+		if ( fh->f_flags & OMPIO_DIRECT_IO ) {
+		    ret_temp = mca_common_ompio_file_write_direct (fh);
+		}
+		else {
+		    ret_temp = fh->f_fbtl->fbtl_pwritev (fh);
+		}
+		if ( 0 > ret_temp ) {
 		    opal_output(1, "WRITE FAILED\n");
                     ret = OMPI_ERROR;
                     goto exit;
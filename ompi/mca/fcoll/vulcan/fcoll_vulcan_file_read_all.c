@@ -84,7 +84,7 @@ mca_fcoll_vulcan_file_read_all (ompio_file_t *fh,
     int current_index=0, temp_index=0;
     int **blocklen_per_process=NULL;
     MPI_Aint **displs_per_process=NULL;
-    char *global_buf = NULL;
+    char *global_buf = NULL, **global_bufs = NULL;
     MPI_Aint global_count = 0;
     mca_io_ompio_local_io_array *file_offsets_for_agg=NULL;
 
@@ -94,8 +94,9 @@ mca_fcoll_vulcan_file_read_all (ompio_file_t *fh,
     int vulcan_num_io_procs;
     size_t max_data = 0;
     MPI_Aint *total_bytes_per_process = NULL;
-    ompi_datatype_t **sendtype = NULL;
-    MPI_Request *send_req=NULL, recv_req=NULL;
+    ompi_datatype_t **sendtype = NULL, **sendtypes = NULL;
+    MPI_Request *send_req=NULL, *send_reqs=NULL, recv_req=NULL;
+    int pipeline_depth = 2, slot;
     int my_aggregator =-1;
     bool recvbuf_is_contiguous=false;
     size_t ftype_size;
@@ -338,6 +339,12 @@ mca_fcoll_vulcan_file_read_all (ompio_file_t *fh,
      *** 6. Determine the number of cycles required to execute this
      ***    operation
      *************************************************************/
+    /* the aggregator reads the next cycle into a different buffer while the
+       data of the previous pipeline_depth-1 cycles is still being sent. Each
+       cycle reads the full f_bytes_per_agg as without pipelining, such that
+       the file system sees requests of the same size; the price is
+       pipeline_depth buffers of that size on the aggregator */
+    pipeline_depth = OMPIO_MAX(2, mca_fcoll_vulcan_pipeline_depth);
     bytes_per_cycle = fh->f_bytes_per_agg;
     cycles = ceil((double)total_bytes/bytes_per_cycle);
 
@@ -368,29 +375,41 @@ mca_fcoll_vulcan_file_read_all (ompio_file_t *fh,
             displs_per_process[i] = NULL;
         }
 
-	send_req = (MPI_Request *) malloc (fh->f_procs_per_group * sizeof(MPI_Request));
-	if (NULL == send_req){
+	send_reqs = (MPI_Request *) malloc (pipeline_depth * fh->f_procs_per_group * sizeof(MPI_Request));
+	if (NULL == send_reqs){
 	    opal_output ( 1, "OUT OF MEMORY\n");
 	    ret = OMPI_ERR_OUT_OF_RESOURCE;
 	    goto exit;
 	}
 
-	global_buf = (char *) malloc (bytes_per_cycle);
-	if (NULL == global_buf){
+	global_bufs = (char **) calloc (pipeline_depth, sizeof(char *));
+	if (NULL == global_bufs){
 	    opal_output(1, "OUT OF MEMORY\n");
 	    ret = OMPI_ERR_OUT_OF_RESOURCE;
 	    goto exit;
 	}
+	for(l=0;l<pipeline_depth;l++){
+	    global_bufs[l] = (char *) malloc (bytes_per_cycle);
+	    if (NULL == global_bufs[l]){
+		opal_output(1, "OUT OF MEMORY\n");
+		ret = OMPI_ERR_OUT_OF_RESOURCE;
+		goto exit;
+	    }
+	    if (NULL != fh->f_fbtl->fbtl_register_buffer) {
+		(void) fh->f_fbtl->fbtl_register_buffer (fh, global_bufs[l], bytes_per_cycle);
+	    }
+	}
 
-	sendtype = (ompi_datatype_t **) malloc (fh->f_procs_per_group * sizeof(ompi_datatype_t *));
-	if (NULL == sendtype) {
+	sendtypes = (ompi_datatype_t **) malloc (pipeline_depth * fh->f_procs_per_group * sizeof(ompi_datatype_t *));
+	if (NULL == sendtypes) {
             opal_output (1, "OUT OF MEMORY\n");
 	    ret = OMPI_ERR_OUT_OF_RESOURCE;
 	    goto exit;
 	}
 
-	for(l=0;l<fh->f_procs_per_group;l++){
-            sendtype[l] = MPI_DATATYPE_NULL;
+	for(l=0;l<pipeline_depth * fh->f_procs_per_group;l++){
+            sendtypes[l] = MPI_DATATYPE_NULL;
+            send_reqs[l] = MPI_REQUEST_NULL;
 	}
     }
 
@@ -415,13 +434,24 @@ mca_fcoll_vulcan_file_read_all (ompio_file_t *fh,
             }
             fh->f_num_of_io_entries = 0;
 
-            if (NULL != sendtype){
-                for (i =0; i< fh->f_procs_per_group; i++) {
-		    if ( MPI_DATATYPE_NULL != sendtype[i] ) {
-                        ompi_datatype_destroy(&sendtype[i]);
-                        sendtype[i] = MPI_DATATYPE_NULL;
-                    }
-		}
+            /* the buffer of this slot can be reused once the sends of
+               cycle index-pipeline_depth are done */
+            slot = index % pipeline_depth;
+            global_buf = global_bufs[slot];
+            send_req = &send_reqs[slot * fh->f_procs_per_group];
+            sendtype = &sendtypes[slot * fh->f_procs_per_group];
+            ret = ompi_request_wait_all (fh->f_procs_per_group,
+                                         send_req,
+                                         MPI_STATUS_IGNORE);
+            if (OMPI_SUCCESS != ret){
+                goto exit;
+            }
+
+            for (i =0; i< fh->f_procs_per_group; i++) {
+                if ( MPI_DATATYPE_NULL != sendtype[i] ) {
+                    ompi_datatype_destroy(&sendtype[i]);
+                    sendtype[i] = MPI_DATATYPE_NULL;
+                }
             }
 
             for(l=0;l<fh->f_procs_per_group;l++){
@@ -802,16 +832,6 @@ mca_fcoll_vulcan_file_read_all (ompio_file_t *fh,
             goto exit;
         }
 
-
-        if (my_aggregator == fh->f_rank){
-            ret = ompi_request_wait_all (fh->f_procs_per_group,
-                                         send_req,
-                                         MPI_STATUS_IGNORE);
-            if (OMPI_SUCCESS != ret){
-                goto exit;
-            }
-        }
-
         ret = ompi_request_wait (&recv_req, MPI_STATUS_IGNORE);
         if (OMPI_SUCCESS != ret){
             goto exit;
@@ -863,6 +883,15 @@ mca_fcoll_vulcan_file_read_all (ompio_file_t *fh,
 #endif
     } /* end for (index=0; index < cycles; index ++) */
 
+    if (my_aggregator == fh->f_rank){
+        ret = ompi_request_wait_all (pipeline_depth * fh->f_procs_per_group,
+                                     send_reqs,
+                                     MPI_STATUS_IGNORE);
+        if (OMPI_SUCCESS != ret){
+            goto exit;
+        }
+    }
+
 #if OMPIO_FCOLL_WANT_TIME_BREAKDOWN
     end_rexch = MPI_Wtime();
     read_exch += end_rexch - start_rexch;
@@ -887,8 +916,15 @@ exit:
             receive_buf = NULL;
         }
     }
-    if (NULL != global_buf) {
-        free (global_buf);
+    if (NULL != global_bufs) {
+        for (l=0; l<pipeline_depth; l++) {
+            if (NULL != global_bufs[l] && NULL != fh->f_fbtl->fbtl_unregister_buffer) {
+                (void) fh->f_fbtl->fbtl_unregister_buffer (fh, global_bufs[l]);
+            }
+            free (global_bufs[l]);
+        }
+        free (global_bufs);
+        global_bufs = NULL;
         global_buf = NULL;
     }
     if (NULL != sorted) {
@@ -930,14 +966,14 @@ exit:
             free(memory_displacements);
             memory_displacements= NULL;
         }
-        if (NULL != sendtype){
-            for (i = 0; i < fh->f_procs_per_group; i++) {
-                if ( MPI_DATATYPE_NULL != sendtype[i] ) {
-                    ompi_datatype_destroy(&sendtype[i]);
+        if (NULL != sendtypes){
+            for (i = 0; i < pipeline_depth * fh->f_procs_per_group; i++) {
+                if ( MPI_DATATYPE_NULL != sendtypes[i] ) {
+                    ompi_datatype_destroy(&sendtypes[i]);
                 }
             }
-            free(sendtype);
-            sendtype=NULL;
+            free(sendtypes);
+            sendtypes=NULL;
         }
 
         if (NULL != disp_index){
@@ -967,9 +1003,9 @@ exit:
             free(displs_per_process);
             displs_per_process = NULL;
         }
-        if ( NULL != send_req ) {
-            free ( send_req );
-            send_req = NULL;
+        if ( NULL != send_reqs ) {
+            free ( send_reqs );
+            send_reqs = NULL;
         }
     }
     return ret;
@@ -51,17 +51,17 @@ typedef struct mca_io_ompio_aggregator_data {
     int **blocklen_per_process;
     MPI_Aint **displs_per_process, total_bytes, bytes_per_cycle, total_bytes_written;
     MPI_Comm comm;
-    char *buf, *global_buf, *prev_global_buf;
-    ompi_datatype_t **recvtype, **prev_recvtype;
+    char *buf, *global_buf, **global_bufs;
+    ompi_datatype_t **recvtype;
     struct iovec *global_iov_array;
     int current_index, current_position;
     int bytes_to_write_in_cycle, bytes_remaining, procs_per_group;    
     int *procs_in_group, iov_index;
-    int bytes_sent, prev_bytes_sent;
+    int bytes_sent;
     struct iovec *decoded_iov;
-    int bytes_to_write, prev_bytes_to_write;
-    mca_common_ompio_io_array_t *io_array, *prev_io_array;
-    int num_io_entries, prev_num_io_entries;
+    int bytes_to_write;
+    mca_common_ompio_io_array_t *io_array;
+    int num_io_entries;
 } mca_io_ompio_aggregator_data;
 
 
@@ -70,20 +70,14 @@ typedef struct mca_io_ompio_aggregator_data {
     _r1=_r2;                     \
     _r2=_t;}
 
-#define SWAP_AGGR_POINTERS(_aggr,_num) {                        \
+/* Select the ring buffer used by the aggregators for the next cycle */
+#define SET_AGGR_BUFFER(_aggr,_num,_slot) {                     \
     int _i;                                                     \
-    char *_t;                                                   \
     for (_i=0; _i<_num; _i++ ) {                                \
-        _aggr[_i]->prev_io_array=_aggr[_i]->io_array;             \
-        _aggr[_i]->prev_num_io_entries=_aggr[_i]->num_io_entries; \
-        _aggr[_i]->prev_bytes_sent=_aggr[_i]->bytes_sent;         \
-        _aggr[_i]->prev_bytes_to_write=_aggr[_i]->bytes_to_write; \
-        _t=_aggr[_i]->prev_global_buf;                            \
-        _aggr[_i]->prev_global_buf=_aggr[_i]->global_buf;         \
-        _aggr[_i]->global_buf=_t;                                 \
-        _t=(char *)_aggr[_i]->recvtype;                           \
-        _aggr[_i]->recvtype=_aggr[_i]->prev_recvtype;             \
-        _aggr[_i]->prev_recvtype=(ompi_datatype_t **)_t;          }                                                             \
+        if ( NULL != _aggr[_i]->global_bufs ) {                 \
+            _aggr[_i]->global_buf=_aggr[_i]->global_bufs[_slot]; \
+        }                                                       \
+    }                                                           \
 }
 
 
@@ -133,7 +127,8 @@ int mca_fcoll_vulcan_file_write_all (ompio_file_t *fh,
     uint32_t total_fview_count = 0;
     int local_count = 0;
     ompi_request_t **reqs = NULL;
-    ompi_request_t *req_iwrite = MPI_REQUEST_NULL;
+    ompi_request_t **write_reqs = NULL;
+    int pipeline_depth = 2, slot;
     mca_io_ompio_aggregator_data **aggr_data=NULL;
     
     int *displs = NULL;
@@ -175,9 +170,14 @@ int mca_fcoll_vulcan_file_write_all (ompio_file_t *fh,
         goto exit;
     }
 
-    /* since we want to overlap 2 iterations, define the bytes_per_cycle to be half of what
-       the user requested */
-    bytes_per_cycle =bytes_per_cycle/2;
+    /* since we want to overlap pipeline_depth iterations, split what the user
+       requested among the cycle buffers of the ring */
+    pipeline_depth = OMPIO_MAX(2, mca_fcoll_vulcan_pipeline_depth);
+    bytes_per_cycle = bytes_per_cycle/pipeline_depth;
+    if ( fh->f_flags & OMPIO_DIRECT_IO ) {
+        /* with O_DIRECT every cycle has to start on a block boundary */
+        bytes_per_cycle = OMPIO_MAX(OMPIO_DIRECT_ALIGN_DOWN(fh, bytes_per_cycle), fh->f_fs_block_size);
+    }
     write_chunksize = bytes_per_cycle;
     
     ret =   mca_common_ompio_decode_datatype ((struct ompio_file_t *) fh,
@@ -239,6 +239,23 @@ int mca_fcoll_vulcan_file_write_all (ompio_file_t *fh,
     // Modifications for the even distribution:
     long domain_size;
     ret = mca_fcoll_vulcan_minmax ( fh, local_iov_array, local_count,  fh->f_num_aggrs, &domain_size);
+    if ( 0 < fh->f_stripe_size ) {
+        if ( LUSTRE == fh->f_fstype && 1 < fh->f_stripe_count &&
+             0 == fh->f_stripe_count % fh->f_num_aggrs ) {
+            /* stripes are assigned round-robin to the aggregators, so that each
+               aggregator always accesses the same OSTs and no OST is shared.
+               This only holds if the no. of aggregators divides the stripe count */
+            domain_size = (long) fh->f_stripe_size;
+        }
+        else {
+            /* no two aggregators share a stripe */
+            domain_size = ((domain_size + fh->f_stripe_size - 1) / fh->f_stripe_size) * fh->f_stripe_size;
+        }
+    }
+    if ( fh->f_flags & OMPIO_DIRECT_IO ) {
+        /* no two aggregators may share a block of the file */
+        domain_size = OMPIO_DIRECT_ALIGN_UP(fh, domain_size);
+    }
     
     // broken_iov_arrays[0] contains broken_counts[0] entries to aggregator 0,
     // broken_iov_arrays[1] contains broken_counts[1] entries to aggregator 1, etc.
@@ -523,26 +540,43 @@ int mca_fcoll_vulcan_file_write_all (ompio_file_t *fh,
             }
         
             
-            aggr_data[i]->global_buf       = (char *) malloc (bytes_per_cycle);
-            aggr_data[i]->prev_global_buf  = (char *) malloc (bytes_per_cycle);
-            if (NULL == aggr_data[i]->global_buf || NULL == aggr_data[i]->prev_global_buf){
-                opal_output(1, "OUT OF MEMORY");
+            aggr_data[i]->global_bufs = (char **) calloc (pipeline_depth, sizeof(char *));
+            if (NULL == aggr_data[i]->global_bufs) {
+                opal_output (1, "OUT OF MEMORY\n");
                 ret = OMPI_ERR_OUT_OF_RESOURCE;
                 goto exit;
             }
+            for ( l=0; l<pipeline_depth; l++ ) {
+                if ( fh->f_flags & OMPIO_DIRECT_IO ) {
+                    /* O_DIRECT needs block aligned memory as well */
+                    if ( 0 != posix_memalign ((void **) &aggr_data[i]->global_bufs[l], fh->f_fs_block_size, bytes_per_cycle) ) {
+                        aggr_data[i]->global_bufs[l] = NULL;
+                    }
+                }
+                else {
+                    aggr_data[i]->global_bufs[l] = (char *) malloc (bytes_per_cycle);
+                }
+                if (NULL == aggr_data[i]->global_bufs[l]){
+                    opal_output(1, "OUT OF MEMORY");
+                    ret = OMPI_ERR_OUT_OF_RESOURCE;
+                    goto exit;
+                }
+                if (NULL != fh->f_fbtl->fbtl_register_buffer) {
+                    /* the buffers are written in every cycle, let the fbtl pin
+                     * them once. Failing to do so only disables the fast path */
+                    (void) fh->f_fbtl->fbtl_register_buffer (fh, aggr_data[i]->global_bufs[l], bytes_per_cycle);
+                }
+            }
         
             aggr_data[i]->recvtype = (ompi_datatype_t **) malloc (fh->f_procs_per_group  * 
                                                                   sizeof(ompi_datatype_t *));
-            aggr_data[i]->prev_recvtype = (ompi_datatype_t **) malloc (fh->f_procs_per_group  * 
-                                                                       sizeof(ompi_datatype_t *));
-            if (NULL == aggr_data[i]->recvtype || NULL == aggr_data[i]->prev_recvtype) {
+            if (NULL == aggr_data[i]->recvtype) {
                 opal_output (1, "OUT OF MEMORY\n");
                 ret = OMPI_ERR_OUT_OF_RESOURCE;
                 goto exit;
             }
             for(l=0;l<fh->f_procs_per_group;l++){
                 aggr_data[i]->recvtype[l]      = MPI_DATATYPE_NULL;
-                aggr_data[i]->prev_recvtype[l] = MPI_DATATYPE_NULL;
             }
         }
     
@@ -572,41 +606,40 @@ int mca_fcoll_vulcan_file_write_all (ompio_file_t *fh,
         ( (0 == mca_fcoll_vulcan_async_io) && (NULL != fh->f_fbtl->fbtl_ipwritev) && (2 < cycles) ) ) {
         write_synch_type = 1;
     }
+    if ( fh->f_flags & OMPIO_DIRECT_IO ) {
+        /* read-modify-write of partial blocks is done synchronously */
+        write_synch_type = 0;
+    }
 
-    if ( cycles > 0 ) {
-        for ( i=0; i<fh->f_num_aggrs; i++ ) {
-            ret = shuffle_init ( 0, cycles, fh->f_aggr_list[i], fh->f_rank, aggr_data[i],
-                                 &reqs[i*(fh->f_procs_per_group + 1)] );
-            if ( OMPI_SUCCESS != ret ) {
-                goto exit;
-            }
-        }
-        // Register progress function that should be used by ompi_request_wait
-        if (NOT_AGGR_INDEX != aggr_index)  {
-            mca_common_ompio_register_progress ();
-        }
+    write_reqs = (ompi_request_t **) malloc (pipeline_depth * sizeof(ompi_request_t *));
+    if ( NULL == write_reqs ) {
+        opal_output (1, "OUT OF MEMORY\n");
+        ret = OMPI_ERR_OUT_OF_RESOURCE;
+        goto exit;
+    }
+    for ( l=0; l<pipeline_depth; l++ ) {
+        write_reqs[l] = MPI_REQUEST_NULL;
     }
 
-    ret = ompi_request_wait_all ( (fh->f_procs_per_group + 1 )*fh->f_num_aggrs,
-                                  reqs, MPI_STATUS_IGNORE);
+    // Register progress function that should be used by ompi_request_wait
+    if ( (cycles > 0) && (NOT_AGGR_INDEX != aggr_index) ) {
+        mca_common_ompio_register_progress ();
+    }
 
-    for (index = 1; index < cycles; index++) {
-        SWAP_AGGR_POINTERS(aggr_data, fh->f_num_aggrs);
+    /* The cycles go round-robin through the ring of buffers: the shuffle of
+       cycle index can proceed while the writes of the previous
+       pipeline_depth-1 cycles are still in flight. */
+    for (index = 0; index < cycles; index++) {
+        slot = index % pipeline_depth;
 
         if(NOT_AGGR_INDEX != aggr_index) {
-#if OMPIO_FCOLL_WANT_TIME_BREAKDOWN
-            start_write_time = MPI_Wtime();
-#endif
-            ret = write_init (fh, fh->f_aggr_list[aggr_index], aggr_data[aggr_index],
-                              write_chunksize, write_synch_type, &req_iwrite);
+            /* wait for the buffer of this slot to be written out */
+            ret = ompi_request_wait(&write_reqs[slot], MPI_STATUS_IGNORE);
             if (OMPI_SUCCESS != ret){
                 goto exit;
             }
-#if OMPIO_FCOLL_WANT_TIME_BREAKDOWN
-            end_write_time = MPI_Wtime();
-            write_time += end_write_time - start_write_time;
-#endif
         }
+        SET_AGGR_BUFFER(aggr_data, fh->f_num_aggrs, slot);
 
         for ( i=0; i<fh->f_num_aggrs; i++ ) {
             ret = shuffle_init ( index, cycles, fh->f_aggr_list[i], fh->f_rank, aggr_data[i],
@@ -622,23 +655,12 @@ int mca_fcoll_vulcan_file_write_all (ompio_file_t *fh,
             goto exit;
         }
 
-        if(NOT_AGGR_INDEX != aggr_index) {
-            ret = ompi_request_wait(&req_iwrite, MPI_STATUS_IGNORE);
-            if (OMPI_SUCCESS != ret){
-                goto exit;
-            }
-        }
-    } /* end  for (index = 0; index < cycles; index++) */
-
-    if ( cycles > 0 ) {
-        SWAP_AGGR_POINTERS(aggr_data,fh->f_num_aggrs);
-
         if(NOT_AGGR_INDEX != aggr_index) {
 #if OMPIO_FCOLL_WANT_TIME_BREAKDOWN
             start_write_time = MPI_Wtime();
 #endif
             ret = write_init (fh, fh->f_aggr_list[aggr_index], aggr_data[aggr_index],
-                              write_chunksize, write_synch_type, &req_iwrite);
+                              write_chunksize, write_synch_type, &write_reqs[slot]);
             if (OMPI_SUCCESS != ret){
                 goto exit;
             }
@@ -647,12 +669,12 @@ int mca_fcoll_vulcan_file_write_all (ompio_file_t *fh,
             write_time += end_write_time - start_write_time;
 #endif
         }
+    } /* end  for (index = 0; index < cycles; index++) */
 
-        if(NOT_AGGR_INDEX != aggr_index) {
-            ret = ompi_request_wait(&req_iwrite, MPI_STATUS_IGNORE);
-            if (OMPI_SUCCESS != ret){
-                goto exit;
-            }
+    if(NOT_AGGR_INDEX != aggr_index) {
+        ret = ompi_request_wait_all (pipeline_depth, write_reqs, MPI_STATUSES_IGNORE);
+        if (OMPI_SUCCESS != ret){
+            goto exit;
         }
     }
         
@@ -686,19 +708,22 @@ exit :
                         if ( MPI_DATATYPE_NULL != aggr_data[i]->recvtype[j] ) {
                             ompi_datatype_destroy(&aggr_data[i]->recvtype[j]);
                         }
-                        if ( MPI_DATATYPE_NULL != aggr_data[i]->prev_recvtype[j] ) {
-                            ompi_datatype_destroy(&aggr_data[i]->prev_recvtype[j]);
-                        }
-			
                     }
                     free(aggr_data[i]->recvtype);
-                    free(aggr_data[i]->prev_recvtype);
                 }
                 
                 free (aggr_data[i]->disp_index);
                 free (aggr_data[i]->max_disp_index);
-                free (aggr_data[i]->global_buf);
-                free (aggr_data[i]->prev_global_buf);
+                if (NULL != aggr_data[i]->global_bufs) {
+                    for (l=0; l<pipeline_depth; l++) {
+                        if (NULL != aggr_data[i]->global_bufs[l] &&
+                            NULL != fh->f_fbtl->fbtl_unregister_buffer) {
+                            (void) fh->f_fbtl->fbtl_unregister_buffer (fh, aggr_data[i]->global_bufs[l]);
+                        }
+                        free (aggr_data[i]->global_bufs[l]);
+                    }
+                    free (aggr_data[i]->global_bufs);
+                }
                 for(l=0;l<aggr_data[i]->procs_per_group;l++){
                     free (aggr_data[i]->blocklen_per_process[l]);
                     free (aggr_data[i]->displs_per_process[l]);
@@ -733,6 +758,7 @@ exit :
     fh->f_procs_per_group=0;
     free(result_counts);
     free(reqs);
+    free(write_reqs);
      
     return OMPI_SUCCESS;
 }
@@ -752,13 +778,13 @@ static int write_init (ompio_file_t *fh,
 
     mca_common_ompio_request_alloc ( &ompio_req, MCA_OMPIO_REQUEST_WRITE );
 
-    if (aggr_data->prev_num_io_entries) {
-        /*  In this case, aggr_data->prev_num_io_entries is always == 1.
-            Therefore we can write the data of size aggr_data->prev_bytes_to_write in one iteration.
-            In fact, aggr_data->prev_bytes_to_write <= write_chunksize.
+    if (aggr_data->num_io_entries) {
+        /*  In this case, aggr_data->num_io_entries is always == 1.
+            Therefore we can write the data of size aggr_data->bytes_to_write in one iteration.
+            In fact, aggr_data->bytes_to_write <= write_chunksize.
         */
-        mca_fcoll_vulcan_split_iov_array (fh, aggr_data->prev_io_array,
-                                          aggr_data->prev_num_io_entries,
+        mca_fcoll_vulcan_split_iov_array (fh, aggr_data->io_array,
+                                          aggr_data->num_io_entries,
                                           &last_array_pos, &last_pos,
                                           write_chunksize);
 
@@ -771,7 +797,12 @@ static int write_init (ompio_file_t *fh,
             }
         }
         else {
-            ret_temp = fh->f_fbtl->fbtl_pwritev(fh);
+            if ( fh->f_flags & OMPIO_DIRECT_IO ) {
+                ret_temp = mca_common_ompio_file_write_direct (fh);
+            }
+            else {
+                ret_temp = fh->f_fbtl->fbtl_pwritev(fh);
+            }
             if(0 > ret_temp) {
                 opal_output (1, "vulcan_write_all: fbtl_pwritev failed\n");
                 ret = ret_temp;
@@ -784,7 +815,8 @@ static int write_init (ompio_file_t *fh,
         }
 
         free(fh->f_io_array);
-        free(aggr_data->prev_io_array);
+        free(aggr_data->io_array);
+        aggr_data->io_array = NULL;
     }
     else {
         ompio_req->req_ompi.req_status.MPI_ERROR = OMPI_SUCCESS;
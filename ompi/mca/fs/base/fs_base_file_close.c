@@ -24,6 +24,7 @@
 #include "base.h"
 
 #include <fcntl.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #include "mpi.h"
 #include "ompi/constants.h"
@@ -42,6 +43,15 @@ int mca_fs_base_file_close (ompio_file_t *fh)
                                      fh->f_comm->c_coll->coll_barrier_module);
     /*    close (*(int *)fh->fd);*/
     close (fh->fd);
+    if ( -1 != fh->f_direct_fd ) {
+        close (fh->f_direct_fd);
+        fh->f_direct_fd = -1;
+    }
+    if ( NULL != fh->f_mmap_addr ) {
+        munmap (fh->f_mmap_addr, fh->f_mmap_len);
+        fh->f_mmap_addr = NULL;
+        fh->f_mmap_len  = 0;
+    }
     /*    if (NULL != fh->fd)
     {
         free (fh->fd);
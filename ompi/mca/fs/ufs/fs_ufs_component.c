@@ -32,6 +32,7 @@
 
 int mca_fs_ufs_priority = 10;
 int mca_fs_ufs_lock_algorithm=0; /* auto */
+int mca_fs_ufs_mmap=0;
 /*
  * Private functions
  */
@@ -91,5 +92,17 @@ static int register_component(void)
                                            MCA_BASE_VAR_SCOPE_READONLY,
                                            &mca_fs_ufs_lock_algorithm );
 
+    mca_fs_ufs_mmap = 0;
+    (void) mca_base_component_var_register(&mca_fs_ufs_component.fsm_version,
+                                           "mmap", "Map files opened with MPI_MODE_RDONLY into memory "
+                                           "and serve independent reads from the mapping. Can be set per "
+                                           "file with the ompio_mmap info key. The file must not shrink while "
+                                           "it is open, reading a truncated part of the mapping raises SIGBUS. "
+                                           "0: read with the fbtl (default), 1: read from the mapping",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                           OPAL_INFO_LVL_9,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &mca_fs_ufs_mmap );
+
     return OMPI_SUCCESS;
 }
@@ -25,7 +25,11 @@
 #include "fs_ufs.h"
 
 #include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <unistd.h>
 #include "mpi.h"
 #include "ompi/constants.h"
 #include "ompi/mca/fs/base/base.h"
@@ -34,6 +38,14 @@
 #include "ompi/info/info.h"
 #include "opal/util/path.h"
 
+static void mca_fs_ufs_open_direct (struct ompi_communicator_t *comm,
+                                    const char *filename,
+                                    int access_mode,
+                                    ompio_file_t *fh);
+static void mca_fs_ufs_open_mmap (struct opal_info_t *info,
+                                  int access_mode,
+                                  ompio_file_t *fh);
+
 /*
  *	file_open_ufs
  *
@@ -128,5 +140,114 @@ mca_fs_ufs_file_open (struct ompi_communicator_t *comm,
         opal_output ( 1, "Invalid value for mca_fs_ufs_lock_algorithm %d", mca_fs_ufs_lock_algorithm );
     }
 
+    /* collective, the request for direct I/O may differ between ranks */
+    mca_fs_ufs_open_direct ( comm, filename, access_mode, fh );
+
+    mca_fs_ufs_open_mmap ( info, access_mode, fh );
+
     return OMPI_SUCCESS;
 }
+
+/*
+ * Map a read-only file into memory if requested, such that independent
+ * reads become copies out of the page cache, which is shared by all ranks
+ * on the node, without a system call per read. This is a purely local
+ * decision: a process that cannot map the file reads through the fbtl.
+ * Nobody may truncate the file while it is mapped: touching pages past its
+ * new end raises SIGBUS instead of returning a short read.
+ */
+static void mca_fs_ufs_open_mmap (struct opal_info_t *info,
+                                  int access_mode,
+                                  ompio_file_t *fh)
+{
+    char value[MPI_MAX_INFO_VAL];
+    int flag, enable = mca_fs_ufs_mmap;
+    struct stat st;
+    void *addr;
+
+    opal_info_get (info, "ompio_mmap", MPI_MAX_INFO_VAL, value, &flag);
+    if ( flag ) {
+        /* Info object trumps mca parameter value */
+        if ( !strncmp ( value, "true", sizeof("true") )) {
+            enable = 1;
+        }
+        else if ( !strncmp ( value, "false", sizeof("false") )) {
+            enable = 0;
+        }
+    }
+
+    if ( !enable || !(access_mode & MPI_MODE_RDONLY) ) {
+        return;
+    }
+    if ( 0 != fstat (fh->fd, &st) || 0 >= st.st_size || (uintmax_t) st.st_size > SIZE_MAX ) {
+        return;
+    }
+
+    addr = mmap (NULL, (size_t) st.st_size, PROT_READ, MAP_SHARED, fh->fd, 0);
+    if ( MAP_FAILED == addr ) {
+        opal_output_verbose (1, ompi_fs_base_framework.framework_output,
+                             "fs_ufs: could not map %s: %s, reading with the fbtl",
+                             fh->f_filename, strerror(errno));
+        return;
+    }
+
+    fh->f_mmap_addr = addr;
+    fh->f_mmap_len  = (size_t) st.st_size;
+}
+
+/*
+ * Open the O_DIRECT descriptor used by the aggregators of collective
+ * writes, next to the regular one which all other operations use. It is
+ * opened for reading as well, since pieces of blocks are written by
+ * read-modify-write. The aggregators of all ranks have to agree on the
+ * block size their file domains are aligned to, so direct I/O is used
+ * only if every rank asked for it (the ompio_direct_io info key is not
+ * required to be the same everywhere) and could open the file that way.
+ * Nothing is exchanged unless the io_ompio_direct_io parameter, which is
+ * the same everywhere, allows direct I/O at all.
+ */
+static void mca_fs_ufs_open_direct (struct ompi_communicator_t *comm,
+                                    const char *filename,
+                                    int access_mode,
+                                    ompio_file_t *fh)
+{
+    int vals[2] = {1, 0};  /* failed, block size */
+
+    /* the access mode and the parameter are the same on all the ranks */
+    if ( access_mode & MPI_MODE_RDONLY || 0 == OMPIO_MCA_GET(fh, direct_io) ) {
+        fh->f_flags &= ~OMPIO_DIRECT_IO;
+        return;
+    }
+
+#if defined(O_DIRECT)
+    struct stat st;
+
+    if ( fh->f_flags & OMPIO_DIRECT_IO ) {
+        fh->f_direct_fd = open (filename, O_RDWR | O_DIRECT);
+        if ( 0 <= fh->f_direct_fd && 0 == fstat (fh->f_direct_fd, &st) && 0 < st.st_blksize ) {
+            vals[0] = 0;
+            vals[1] = (int) st.st_blksize;
+        }
+    }
+#endif
+
+    comm->c_coll->coll_allreduce ( MPI_IN_PLACE, vals, 2, MPI_INT, MPI_MAX, comm,
+                                   comm->c_coll->coll_allreduce_module);
+    if ( 0 != vals[0] ) {
+        if ( 0 <= fh->f_direct_fd ) {
+            close (fh->f_direct_fd);
+            fh->f_direct_fd = -1;
+        }
+        if ( fh->f_flags & OMPIO_DIRECT_IO ) {
+            fh->f_flags &= ~OMPIO_DIRECT_IO;
+            opal_output_verbose (1, ompi_fs_base_framework.framework_output,
+                                 "fs_ufs: O_DIRECT not available for %s, writing through the page cache",
+                                 filename);
+        }
+        return;
+    }
+
+    if ( vals[1] > fh->f_fs_block_size ) {
+        fh->f_fs_block_size = vals[1];
+    }
+}
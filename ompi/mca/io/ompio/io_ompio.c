@@ -548,6 +548,18 @@ int mca_io_ompio_get_mca_parameter_value ( char *mca_parameter_name, int name_le
     else if ( !strncmp ( mca_parameter_name, "coll_timing_info", name_length )) {
         return mca_io_ompio_coll_timing_info;
     }
+    else if ( !strncmp ( mca_parameter_name, "direct_io", name_length )) {
+        return mca_io_ompio_direct_io;
+    }
+    else if ( !strncmp ( mca_parameter_name, "aggregator_placement", name_length )) {
+        return mca_io_ompio_aggregator_placement;
+    }
+    else if ( !strncmp ( mca_parameter_name, "burst_buffer", name_length )) {
+        return mca_io_ompio_burst_buffer;
+    }
+    else if ( !strncmp ( mca_parameter_name, "burst_buffer_size", name_length )) {
+        return mca_io_ompio_burst_buffer_size;
+    }
     else {
         opal_output (1, "Error in mca_io_ompio_get_mca_parameter_value: unknown parameter name");
     }
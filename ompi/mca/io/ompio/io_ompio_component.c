@@ -50,6 +50,10 @@ int mca_io_ompio_max_aggregators_ratio=8;
 int mca_io_ompio_aggregators_cutoff_threshold=3;
 int mca_io_ompio_overwrite_amode = 1;
 int mca_io_ompio_verbose_info_parsing = 0;
+int mca_io_ompio_direct_io = 0;
+int mca_io_ompio_aggregator_placement = 1;
+int mca_io_ompio_burst_buffer = 0;
+int mca_io_ompio_burst_buffer_size = 1024;
 
 int mca_io_ompio_grouping_option=5;
 
@@ -260,6 +264,59 @@ static int register_component(void)
                                            MCA_BASE_VAR_SCOPE_READONLY,
                                            &mca_io_ompio_verbose_info_parsing);
 
+    mca_io_ompio_direct_io = 0;
+    (void) mca_base_component_var_register(&mca_io_ompio_component.io_version,
+                                           "direct_io",
+                                           "Collective write aggregators bypass the page cache "
+                                           "using O_DIRECT, on file systems supporting it. Must be "
+                                           "the same on all processes "
+                                           "0: always write through the page cache, the ompio_direct_io "
+                                           "info key is ignored (default) "
+                                           "1: write with O_DIRECT, unless the ompio_direct_io info key "
+                                           "is false "
+                                           "2: write with O_DIRECT if the ompio_direct_io info key is true ",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                           OPAL_INFO_LVL_9,
+                                           MCA_BASE_VAR_SCOPE_ALL_EQ,
+                                           &mca_io_ompio_direct_io);
+
+    mca_io_ompio_aggregator_placement = 1;
+    (void) mca_base_component_var_register(&mca_io_ompio_component.io_version,
+                                           "aggregator_placement",
+                                           "Choose the aggregator of each group such that aggregators "
+                                           "are spread evenly across nodes and NUMA domains. Applies "
+                                           "to the simple grouping options (5, 6 and 7) "
+                                           "0: use the first process of each group "
+                                           "1: spread aggregators across nodes and NUMA domains (default) ",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                           OPAL_INFO_LVL_9,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &mca_io_ompio_aggregator_placement);
+
+    mca_io_ompio_burst_buffer = 0;
+    (void) mca_base_component_var_register(&mca_io_ompio_component.io_version,
+                                           "burst_buffer",
+                                           "Stage writes in a node-local directory and drain them to the "
+                                           "file in the background. The directory is the temporary directory "
+                                           "of the process or the value of the ompio_burst_buffer_dir info key. "
+                                           "Can be set per file with the ompio_burst_buffer info key "
+                                           "0: write directly to the file (default) "
+                                           "1: stage writes in a node-local directory ",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                           OPAL_INFO_LVL_9,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &mca_io_ompio_burst_buffer);
+
+    mca_io_ompio_burst_buffer_size = 1024;
+    (void) mca_base_component_var_register(&mca_io_ompio_component.io_version,
+                                           "burst_buffer_size",
+                                           "Amount of data in MB a process may have staged and not yet "
+                                           "drained before writes wait for the drain. 0 means unlimited",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                           OPAL_INFO_LVL_9,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &mca_io_ompio_burst_buffer_size);
+
     return OMPI_SUCCESS;
 }
 
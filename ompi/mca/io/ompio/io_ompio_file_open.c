@@ -225,7 +225,7 @@ exit:
 int mca_io_ompio_file_set_size (ompi_file_t *fh,
                                 OMPI_MPI_OFFSET_TYPE size)
 {
-    int ret = OMPI_SUCCESS;
+    int ret = OMPI_SUCCESS, bb_ret;
     OMPI_MPI_OFFSET_TYPE tmp;
     mca_common_ompio_data_t *data;
 
@@ -251,6 +251,19 @@ int mca_io_ompio_file_set_size (ompi_file_t *fh,
         return OMPI_ERROR;
     }
 
+    /* staged data must not land behind the new end of file. A drain error
+       is local and must not keep this process out of the barrier */
+    bb_ret = mca_common_ompio_bb_flush (&data->ompio_fh);
+    ret = data->ompio_fh.f_comm->c_coll->coll_barrier (data->ompio_fh.f_comm,
+                                                      data->ompio_fh.f_comm->c_coll->coll_barrier_module);
+    if ( OMPI_SUCCESS == ret ) {
+        ret = bb_ret;
+    }
+    if ( OMPI_SUCCESS != ret ) {
+        OPAL_THREAD_UNLOCK(&fh->f_lock);
+        return ret;
+    }
+
     ret = data->ompio_fh.f_fs->fs_file_set_size (&data->ompio_fh, size);
     if ( OMPI_SUCCESS != ret ) {
         opal_output(1, ",mca_io_ompio_file_set_size: error in fs->set_size\n");
@@ -357,7 +370,7 @@ int mca_io_ompio_file_get_atomicity (ompi_file_t *fh,
 
 int mca_io_ompio_file_sync (ompi_file_t *fh)
 {
-    int ret = OMPI_SUCCESS;
+    int ret = OMPI_SUCCESS, bb_ret;
     mca_common_ompio_data_t *data;
 
     data = (mca_common_ompio_data_t *) fh->f_io_selected_data;
@@ -372,9 +385,15 @@ int mca_io_ompio_file_sync (ompi_file_t *fh)
         OPAL_THREAD_UNLOCK(&fh->f_lock);
         return MPI_ERR_ACCESS;
     }        
+    // Drain what this process staged before the others rely on it. A drain
+    // error is reported after the barrier, which all processes have to enter.
+    bb_ret = mca_common_ompio_bb_flush (&data->ompio_fh);
     // Make sure all processes reach this point before syncing the file.
     ret = data->ompio_fh.f_comm->c_coll->coll_barrier (data->ompio_fh.f_comm,
                                                        data->ompio_fh.f_comm->c_coll->coll_barrier_module);
+    if ( MPI_SUCCESS == ret ) {
+        ret = bb_ret;
+    }
     if ( MPI_SUCCESS != ret ) {
         OPAL_THREAD_UNLOCK(&fh->f_lock);
         return ret;
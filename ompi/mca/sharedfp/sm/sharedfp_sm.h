@@ -28,6 +28,7 @@
 #include "ompi/mca/mca.h"
 #include "ompi/mca/sharedfp/sharedfp.h"
 #include "ompi/mca/common/ompio/common_ompio.h"
+#include "opal/sys/atomic.h"
 #include <semaphore.h>
 
 BEGIN_C_DECLS
@@ -105,8 +106,9 @@ int mca_sharedfp_sm_iwrite (ompio_file_t *fh,
  *Structures and definitions only for this component
  *--------------------------------------------------------------*/
 struct mca_sharedfp_sm_offset{
-    sem_t mutex;      /* the mutex: a POSIX memory-based unnamed semaphore */
-    long long offset;  /* and the shared file pointer offset */
+    sem_t mutex;      /* the mutex: a POSIX memory-based unnamed semaphore, taken by seek */
+    opal_atomic_int64_t offset;  /* the shared file pointer offset, advanced by fetch-and-add */
+    opal_atomic_int64_t ticket;  /* next ticket served by the ordered operations */
 };
 
 /*This structure will hang off of the mca_sharedfp_base_data_t's
@@ -122,6 +124,9 @@ struct mca_sharedfp_sm_data
        semaphore located in sm_offset_ptr->mutex. */
     sem_t *mutex;
     char *sem_name;    /* Name of the semaphore */
+    /* number of ordered operations started by this process, all processes
+       take their tickets in the same sequence */
+    int64_t ordered_calls;
 };
 
 typedef struct mca_sharedfp_sm_data sm_data;
@@ -130,6 +135,9 @@ typedef struct mca_sharedfp_sm_data sm_data;
 int mca_sharedfp_sm_request_position (ompio_file_t *fh,
                                       int bytes_requested,
                                       OMPI_MPI_OFFSET_TYPE * offset);
+int mca_sharedfp_sm_request_ordered_position (ompio_file_t *fh,
+                                              long bytes_requested,
+                                              OMPI_MPI_OFFSET_TYPE * offset);
 /*
  * ******************************************************************
  * ************ functions implemented in this module end ************
@@ -95,6 +95,7 @@ int mca_sharedfp_sm_file_open (struct ompi_communicator_t *comm,
         return OMPI_ERR_OUT_OF_RESOURCE;
     }
     sm_data->sm_filename=NULL;
+    sm_data->ordered_calls=0;
 
 
     /* the shared memory segment is identified opening a file
@@ -205,6 +206,7 @@ int mca_sharedfp_sm_file_open (struct ompi_communicator_t *comm,
 
             sem_wait(sm_data->mutex);
             sm_offset_ptr->offset=position;
+            sm_offset_ptr->ticket=0;
             sem_post(sm_data->mutex);
         }
     }else{
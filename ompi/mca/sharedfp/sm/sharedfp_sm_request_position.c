@@ -26,6 +26,7 @@
 #include "ompi/constants.h"
 #include "ompi/mca/sharedfp/sharedfp.h"
 #include "ompi/mca/sharedfp/base/base.h"
+#include "opal/runtime/opal_progress.h"
 
 /*use a semaphore to lock the shared memory*/
 #include <semaphore.h>
@@ -35,7 +36,6 @@ int mca_sharedfp_sm_request_position(ompio_file_t *fh,
                                      OMPI_MPI_OFFSET_TYPE *offset)
 {
     int ret = OMPI_SUCCESS;
-    OMPI_MPI_OFFSET_TYPE position = 0;
     OMPI_MPI_OFFSET_TYPE old_offset;
     struct mca_sharedfp_sm_data * sm_data = NULL;
     struct mca_sharedfp_sm_offset * sm_offset_ptr = NULL;
@@ -43,50 +43,94 @@ int mca_sharedfp_sm_request_position(ompio_file_t *fh,
 
     sh = fh->f_sharedfp_data;
     sm_data = sh->selected_module_data;
+    sm_offset_ptr = sm_data->sm_offset_ptr;
 
     *offset = 0;
+
+#if OPAL_HAVE_ATOMIC_MATH_64
+    /* the pointer only moves forward between two seeks, no lock needed */
+    old_offset = opal_atomic_fetch_add_64 (&sm_offset_ptr->offset, bytes_requested);
+#else
     if ( mca_sharedfp_sm_verbose ) {
         opal_output(ompi_sharedfp_base_framework.framework_output,
                     "Aquiring lock, rank=%d...",fh->f_rank);
     }
 
-    sm_offset_ptr = sm_data->sm_offset_ptr;
-
     /* Aquire an exclusive lock */
-
     sem_wait(sm_data->mutex);
 
-    if ( mca_sharedfp_sm_verbose ) {
-        opal_output(ompi_sharedfp_base_framework.framework_output,
-                    "Succeeded! Acquired sm lock.for rank=%d\n",fh->f_rank);
-    }
-
     old_offset=sm_offset_ptr->offset;
+    sm_offset_ptr->offset=old_offset + bytes_requested;
+
+    sem_post(sm_data->mutex);
     if ( mca_sharedfp_sm_verbose ) {
         opal_output(ompi_sharedfp_base_framework.framework_output,
-                    "Read last_offset=%lld!\n",old_offset);
+                    "Released lock! released lock.for rank=%d\n",fh->f_rank);
     }
+#endif
 
-    position = old_offset + bytes_requested;
     if ( mca_sharedfp_sm_verbose ) {
         opal_output(ompi_sharedfp_base_framework.framework_output,
-                    "old_offset=%lld, bytes_requested=%d, new offset=%lld!\n",old_offset,bytes_requested,position);
+                    "old_offset=%lld, bytes_requested=%d, new offset=%lld!\n",
+                    old_offset,bytes_requested,old_offset + bytes_requested);
     }
-    sm_offset_ptr->offset=position;
 
+    *offset = old_offset;
 
-    if ( mca_sharedfp_sm_verbose ) {
-        opal_output(ompi_sharedfp_base_framework.framework_output,
-                    "Releasing sm lock...rank=%d",fh->f_rank);
+    return ret;
+}
+
+/*
+ * Ordered operations hand out tickets in rank order: in its n-th ordered
+ * operation, process r holds ticket n*size+r. A process advances the shared
+ * file pointer only when its ticket is served, which gives every process
+ * the offset right after the data of the lower ranks, without gathering
+ * the requests at a root.
+ */
+int mca_sharedfp_sm_request_ordered_position(ompio_file_t *fh,
+                                             long bytes_requested,
+                                             OMPI_MPI_OFFSET_TYPE *offset)
+{
+    struct mca_sharedfp_sm_data * sm_data = NULL;
+    struct mca_sharedfp_sm_offset * sm_offset_ptr = NULL;
+    struct mca_sharedfp_base_data_t *sh = NULL;
+    int64_t my_ticket;
+
+    sh = fh->f_sharedfp_data;
+    sm_data = sh->selected_module_data;
+    sm_offset_ptr = sm_data->sm_offset_ptr;
+
+    my_ticket = sm_data->ordered_calls * fh->f_size + fh->f_rank;
+    sm_data->ordered_calls++;
+
+#if OPAL_HAVE_ATOMIC_MATH_64
+    while ( my_ticket != sm_offset_ptr->ticket ) {
+        opal_progress ();
     }
+    opal_atomic_rmb ();
+
+    *offset = opal_atomic_fetch_add_64 (&sm_offset_ptr->offset, bytes_requested);
+    (void) opal_atomic_fetch_add_64 (&sm_offset_ptr->ticket, 1);
+#else
+    while ( 1 ) {
+        sem_wait(sm_data->mutex);
+        if ( my_ticket == sm_offset_ptr->ticket ) {
+            *offset = sm_offset_ptr->offset;
+            sm_offset_ptr->offset += bytes_requested;
+            sm_offset_ptr->ticket++;
+            sem_post(sm_data->mutex);
+            break;
+        }
+        sem_post(sm_data->mutex);
+        opal_progress ();
+    }
+#endif
 
-    sem_post(sm_data->mutex);
     if ( mca_sharedfp_sm_verbose ) {
         opal_output(ompi_sharedfp_base_framework.framework_output,
-                    "Released lock! released lock.for rank=%d\n",fh->f_rank);
+                    "sharedfp_sm_request_ordered_position: ticket %lld, offset %lld, bytes_requested=%ld\n",
+                    (long long) my_ticket, *offset, bytes_requested);
     }
 
-    *offset = old_offset;
-
-    return ret;
+    return OMPI_SUCCESS;
 }
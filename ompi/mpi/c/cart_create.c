@@ -27,6 +27,7 @@
 
 #include "ompi/mpi/c/bindings.h"
 #include "ompi/runtime/params.h"
+#include "ompi/runtime/mpiruntime.h"
 #include "ompi/communicator/communicator.h"
 #include "ompi/errhandler/errhandler.h"
 #include "ompi/mca/topo/base/base.h"
@@ -111,6 +112,12 @@ int MPI_Cart_create(MPI_Comm old_comm, int ndims, const int dims[],
         return OMPI_ERRHANDLER_INVOKE(old_comm, err, FUNC_NAME);
     }
 
+    err = ompi_comm_preconnect_topo(*comm_cart);
+    if (MPI_SUCCESS != err) {
+        ompi_comm_free(comm_cart);
+        return OMPI_ERRHANDLER_INVOKE(old_comm, err, FUNC_NAME);
+    }
+
     /* All done */
     return MPI_SUCCESS;
 }
@@ -19,6 +19,7 @@
 
 #include "ompi/mpi/c/bindings.h"
 #include "ompi/runtime/params.h"
+#include "ompi/runtime/mpiruntime.h"
 #include "ompi/communicator/communicator.h"
 #include "ompi/errhandler/errhandler.h"
 #include "ompi/memchecker.h"
@@ -91,6 +92,12 @@ int MPI_Dist_graph_create(MPI_Comm comm_old, int n, const int sources[],
     err = topo->topo.dist_graph.dist_graph_create(topo, comm_old, n, sources, degrees,
                                                   destinations, weights, &(info->super),
                                                   reorder, newcomm);
+    if (OMPI_SUCCESS == err) {
+        err = ompi_comm_preconnect_topo(*newcomm);
+        if (OMPI_SUCCESS != err) {
+            ompi_comm_free(newcomm);
+        }
+    }
     OMPI_ERRHANDLER_RETURN(err, comm_old, err, FUNC_NAME);
 }
 
@@ -25,6 +25,7 @@
 
 #include "ompi/mpi/c/bindings.h"
 #include "ompi/runtime/params.h"
+#include "ompi/runtime/mpiruntime.h"
 #include "ompi/communicator/communicator.h"
 #include "ompi/errhandler/errhandler.h"
 #include "ompi/memchecker.h"
@@ -103,6 +104,12 @@ int MPI_Dist_graph_create_adjacent(MPI_Comm comm_old,
                                                            sources, sourceweights, outdegree,
                                                            destinations, destweights, &(info->super),
                                                            reorder, comm_dist_graph);
+    if (OMPI_SUCCESS == err) {
+        err = ompi_comm_preconnect_topo(*comm_dist_graph);
+        if (OMPI_SUCCESS != err) {
+            ompi_comm_free(comm_dist_graph);
+        }
+    }
     OMPI_ERRHANDLER_RETURN(err, comm_old, err, FUNC_NAME);
 }
 
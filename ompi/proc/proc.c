@@ -132,12 +132,24 @@ static int ompi_proc_allocate (ompi_jobid_t jobid, ompi_vpid_t vpid, ompi_proc_t
  */
 int ompi_proc_complete_init_single (ompi_proc_t *proc)
 {
+    int ret;
+
     if ((OMPI_CAST_RTE_NAME(&proc->super.proc_name)->jobid == OMPI_PROC_MY_NAME->jobid) &&
         (OMPI_CAST_RTE_NAME(&proc->super.proc_name)->vpid  == OMPI_PROC_MY_NAME->vpid)) {
         /* nothing else to do */
         return OMPI_SUCCESS;
     }
 
+    /* lazy procs: the node-local peers were not set up at startup, so the
+     * locality of a process is only looked up when it is first used */
+    if (ompi_mpi_lazy_procs && OPAL_PROC_NON_LOCAL == proc->super.proc_flags) {
+        uint16_t u16, *u16ptr = &u16;
+        OPAL_MODEX_RECV_VALUE_OPTIONAL(ret, PMIX_LOCALITY, &proc->super.proc_name, &u16ptr, PMIX_UINT16);
+        if (OPAL_SUCCESS == ret) {
+            proc->super.proc_flags = u16;
+        }
+    }
+
 #if OPAL_ENABLE_HETEROGENEOUS_SUPPORT
     /* get the remote architecture - this might force a modex except
      * for those environments where the RM provides it */
@@ -228,8 +240,8 @@ opal_proc_t *ompi_proc_for_name (const opal_process_name_t proc_name)
 
 int ompi_proc_init(void)
 {
-    int opal_proc_hash_init_size = (ompi_process_info.num_procs < ompi_add_procs_cutoff) ? ompi_process_info.num_procs :
-        1024;
+    int opal_proc_hash_init_size = (ompi_process_info.num_procs < ompi_add_procs_cutoff && !ompi_mpi_lazy_procs) ?
+        ompi_process_info.num_procs : 1024;
     ompi_proc_t *proc;
     int ret;
 
@@ -296,6 +308,11 @@ int ompi_proc_complete_init(void)
     int ret, errcode = OMPI_SUCCESS;
     char *val;
 
+    if (ompi_mpi_lazy_procs) {
+        /* every remote proc, local or not, is created on first use */
+        return OMPI_SUCCESS;
+    }
+
     opal_mutex_lock (&ompi_proc_lock);
 
     /* Add all local peers first */
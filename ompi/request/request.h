@@ -389,6 +389,11 @@ static inline int ompi_request_free(ompi_request_t** request)
 #define ompi_request_wait_all   (ompi_request_functions.req_wait_all)
 #define ompi_request_wait_some  (ompi_request_functions.req_wait_some)
 
+static inline bool ompi_request_check_complete(void *req)
+{
+    return REQUEST_COMPLETE((ompi_request_t *) req);
+}
+
 /**
  * Wait a particular request for completion
  */
@@ -410,6 +415,8 @@ static inline void ompi_request_wait_completion(ompi_request_t *req)
 
         assert(REQUEST_COMPLETE(req));
         WAIT_SYNC_RELEASE(&sync);
+    } else if (opal_progress_wait_hybrid) {
+        opal_progress_wait_until(ompi_request_check_complete, req);
     } else {
         while(!REQUEST_COMPLETE(req)) {
             opal_progress();
@@ -217,6 +217,28 @@ OMPI_DECLSPEC int ompi_mpi_abort(struct ompi_communicator_t* comm,
  */
 int ompi_init_preconnect_mpi(void);
 
+/**
+ * Connect the neighbors of a newly created cartesian or distributed
+ * graph communicator when mpi_preconnect_pattern is "topology".
+ * Collective over comm; a no-op in the other cases.
+ */
+int ompi_comm_preconnect_topo(struct ompi_communicator_t *comm);
+
+/**
+ * Whether pattern is a valid value of mpi_preconnect_pattern.
+ */
+bool ompi_mpi_preconnect_pattern_is_valid(const char *pattern);
+
+/**
+ * Start the asynchronous progress thread if mpi_async_progress is set.
+ */
+int ompi_mpi_async_progress_start(void);
+
+/**
+ * Stop the asynchronous progress thread (if it is running).
+ */
+void ompi_mpi_async_progress_stop(void);
+
 /**
  * Called to disable MPI dynamic process support.  It should be called
  * by transports and/or environments where MPI dynamic process
@@ -0,0 +1,120 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+
+#include <time.h>
+
+#include "opal/runtime/opal_progress.h"
+#include "opal/threads/threads.h"
+#include "opal/mca/hwloc/base/base.h"
+#include "opal/util/output.h"
+
+#include "ompi/constants.h"
+#include "ompi/runtime/mpiruntime.h"
+#include "ompi/runtime/params.h"
+
+/*
+ * The asynchronous progress thread simply calls opal_progress() in a
+ * loop. The pml, btl and libnbc progress callbacks registered there
+ * are the same ones application threads call into from MPI_Test and
+ * MPI_Wait, so they already carry the locking needed for concurrent
+ * progress when MPI_THREAD_MULTIPLE support is on. ompi_mpi_init
+ * forces that support on when this thread is requested.
+ */
+
+static opal_thread_t ompi_async_progress_thread;
+static volatile bool ompi_async_progress_active = false;
+
+/* pin the calling thread to the requested core of the process binding */
+static void ompi_async_progress_bind (void)
+{
+    hwloc_cpuset_t cpuset;
+    hwloc_obj_t core;
+    int ncores, index = ompi_mpi_async_progress_core;
+
+    if (-1 == index || OPAL_SUCCESS != opal_hwloc_base_get_topology ()) {
+        return;
+    }
+
+    cpuset = hwloc_bitmap_alloc ();
+    if (NULL == cpuset) {
+        return;
+    }
+
+    if (0 == hwloc_get_cpubind (opal_hwloc_topology, cpuset, HWLOC_CPUBIND_PROCESS)) {
+        ncores = hwloc_get_nbobjs_inside_cpuset_by_type (opal_hwloc_topology, cpuset, HWLOC_OBJ_CORE);
+        if (ncores > 0) {
+            index = (0 > index) ? ncores - 1 : index % ncores;
+            core = hwloc_get_obj_inside_cpuset_by_type (opal_hwloc_topology, cpuset, HWLOC_OBJ_CORE, index);
+            if (NULL != core && 0 != hwloc_set_cpubind (opal_hwloc_topology, core->cpuset, HWLOC_CPUBIND_THREAD)) {
+                opal_output_verbose (1, 0,
+                                     "async progress: could not bind the progress thread to core %d", index);
+            }
+        }
+    }
+
+    hwloc_bitmap_free (cpuset);
+}
+
+static void *ompi_async_progress_engine (opal_object_t *obj)
+{
+    struct timespec idle = {.tv_sec = ompi_mpi_async_progress_poll_usec / 1000000,
+                            .tv_nsec = (ompi_mpi_async_progress_poll_usec % 1000000) * 1000};
+
+    ompi_async_progress_bind ();
+
+    while (ompi_async_progress_active) {
+        if (0 < opal_progress_count () || 0 >= ompi_mpi_async_progress_poll_usec) {
+            continue;
+        }
+
+        nanosleep (&idle, NULL);
+    }
+
+    return OPAL_THREAD_CANCELLED;
+}
+
+int ompi_mpi_async_progress_start (void)
+{
+    int ret;
+
+    if (!ompi_mpi_async_progress || ompi_async_progress_active) {
+        return OMPI_SUCCESS;
+    }
+
+    OBJ_CONSTRUCT(&ompi_async_progress_thread, opal_thread_t);
+    ompi_async_progress_thread.t_run = ompi_async_progress_engine;
+    ompi_async_progress_thread.t_arg = NULL;
+
+    ompi_async_progress_active = true;
+    opal_atomic_wmb ();
+
+    ret = opal_thread_start (&ompi_async_progress_thread);
+    if (OPAL_SUCCESS != ret) {
+        ompi_async_progress_active = false;
+        OBJ_DESTRUCT(&ompi_async_progress_thread);
+        return ret;
+    }
+
+    return OMPI_SUCCESS;
+}
+
+void ompi_mpi_async_progress_stop (void)
+{
+    if (!ompi_async_progress_active) {
+        return;
+    }
+
+    ompi_async_progress_active = false;
+    opal_atomic_wmb ();
+
+    (void) opal_thread_join (&ompi_async_progress_thread, NULL);
+    OBJ_DESTRUCT(&ompi_async_progress_thread);
+}
@@ -166,6 +166,10 @@ int ompi_mpi_finalize(void)
      */
     (void)mca_pml_base_bsend_detach(NULL, NULL);
 
+    /* Stop driving progress in the background before the pml and the
+       other frameworks get torn down */
+    ompi_mpi_async_progress_stop();
+
 #if OPAL_ENABLE_PROGRESS_THREADS == 0
     opal_progress_set_event_flag(OPAL_EVLOOP_ONCE | OPAL_EVLOOP_NONBLOCK);
 #endif
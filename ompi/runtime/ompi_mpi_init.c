@@ -462,6 +462,14 @@ int ompi_mpi_init(int argc, char **argv, int requested, int *provided,
         goto error;
     }
 
+    /* The asynchronous progress thread runs the same progress paths as the
+     * application, so everything has to be set up for concurrent access
+     * as if MPI_THREAD_MULTIPLE had been requested. */
+    if (ompi_mpi_async_progress) {
+        ompi_mpi_thread_multiple = true;
+        opal_set_using_threads(true);
+    }
+
     if (OPAL_SUCCESS != (ret = opal_arch_set_fortran_logical_size(sizeof(ompi_fortran_logical_t)))) {
         error = "ompi_mpi_init: opal_arch_set_fortran_logical_size failed";
         goto error;
@@ -632,6 +640,15 @@ int ompi_mpi_init(int argc, char **argv, int requested, int *provided,
         goto error;
     }
 
+    /* some btls/mtls require add_procs with all the procs in the job
+     * (see below). Decide here, before the modex and MPI_COMM_WORLD are
+     * set up for lazy procs */
+    if (ompi_mpi_lazy_procs && mca_pml_base_requires_world ()) {
+        opal_output_verbose(10, ompi_pml_base_framework.framework_output,
+                            "mpi_lazy_procs ignored: the PML needs all the processes at startup");
+        ompi_mpi_lazy_procs = false;
+    }
+
     OMPI_TIMING_IMPORT_OPAL("orte_init");
     OMPI_TIMING_NEXT("rte_init-commit");
 
@@ -663,6 +680,12 @@ int ompi_mpi_init(int argc, char **argv, int requested, int *provided,
     }
 #endif
 
+    /* lazy procs fetch the modex data of a peer when they first talk to
+     * it, there is no point in gathering everybody's data here */
+    if (ompi_mpi_lazy_procs) {
+        opal_pmix_collect_all_data = false;
+    }
+
     if (!ompi_singleton) {
         if (opal_pmix_base_async_modex) {
             /* if we are doing an async modex, but we are collecting all
@@ -992,6 +1015,11 @@ int ompi_mpi_init(int argc, char **argv, int requested, int *provided,
         goto error;
     }
 
+    if (OMPI_SUCCESS != (ret = ompi_mpi_async_progress_start())) {
+        error = "ompi_mpi_async_progress_start() failed";
+        goto error;
+    }
+
     /* Fall through */
  error:
     if (ret != OMPI_SUCCESS) {
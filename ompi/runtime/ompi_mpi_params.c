@@ -67,16 +67,28 @@ int ompi_mpi_event_tick_rate = -1;
 char *ompi_mpi_show_mca_params_string = NULL;
 bool ompi_mpi_have_sparse_group_storage = !!(OMPI_GROUP_SPARSE);
 bool ompi_mpi_preconnect_mpi = false;
+int ompi_mpi_preconnect_window = 16;
+char *ompi_mpi_preconnect_pattern = NULL;
 
 bool ompi_async_mpi_init = false;
 bool ompi_async_mpi_finalize = false;
 
 #define OMPI_ADD_PROCS_CUTOFF_DEFAULT 0
 uint32_t ompi_add_procs_cutoff = OMPI_ADD_PROCS_CUTOFF_DEFAULT;
+bool ompi_mpi_lazy_procs = false;
 bool ompi_mpi_dynamics_enabled = true;
 
 char *ompi_mpi_spc_attach_string = NULL;
 bool ompi_mpi_spc_dump_enabled = false;
+int ompi_mpi_spc_thread_slots = 0;
+bool ompi_mpi_spc_shm_export = false;
+char *ompi_mpi_spc_shm_dir = NULL;
+bool ompi_mpi_spc_timer_histograms = false;
+bool ompi_mpi_async_progress = false;
+int ompi_mpi_async_progress_core = -1;
+int ompi_mpi_async_progress_poll_usec = 0;
+int ompi_mpi_comm_split_distributed_min = 4096;
+int ompi_mpi_comm_cid_block_size = 8;
 
 static bool show_default_mca_params = false;
 static bool show_file_mca_params = false;
@@ -238,6 +250,31 @@ int ompi_mpi_register_params(void)
     mca_base_var_register_synonym(value, "ompi", "mpi", NULL, "preconnect_all",
                                   MCA_BASE_VAR_SYN_FLAG_DEPRECATED);
 
+    ompi_mpi_preconnect_window = 16;
+    (void) mca_base_var_register("ompi", "mpi", NULL, "preconnect_window",
+                                 "Maximum number of peers each process connects to concurrently when "
+                                 "mpi_preconnect_mpi is set. 1 connects the peers one at a time (default: 16)",
+                                 MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                 OPAL_INFO_LVL_9,
+                                 MCA_BASE_VAR_SCOPE_READONLY,
+                                 &ompi_mpi_preconnect_window);
+
+    ompi_mpi_preconnect_pattern = "all";
+    (void) mca_base_var_register("ompi", "mpi", NULL, "preconnect_pattern",
+                                 "Peers to connect to when mpi_preconnect_mpi is set: \"all\" connects "
+                                 "MPI_COMM_WORLD during MPI_INIT, node-local peers first, \"ring:<n>\" only "
+                                 "the peers up to n ranks away in MPI_COMM_WORLD, and \"topology\" the "
+                                 "neighbors of each cartesian or distributed graph communicator when it is "
+                                 "created (default: all)",
+                                 MCA_BASE_VAR_TYPE_STRING, NULL, 0, 0,
+                                 OPAL_INFO_LVL_9,
+                                 MCA_BASE_VAR_SCOPE_READONLY,
+                                 &ompi_mpi_preconnect_pattern);
+    if (!ompi_mpi_preconnect_pattern_is_valid(ompi_mpi_preconnect_pattern)) {
+        opal_show_help("help-mpi-runtime.txt", "invalid preconnect pattern", true,
+                       ompi_mpi_preconnect_pattern);
+    }
+
     /* Sparse group storage support */
     (void) mca_base_var_register("ompi", "mpi", NULL, "have_sparse_group_storage",
                                  "Whether this Open MPI installation supports storing of data in MPI groups in \"sparse\" formats (good for extremely large process count MPI jobs that create many communicators/groups)",
@@ -288,6 +325,17 @@ int ompi_mpi_register_params(void)
                                   0, 0, OPAL_INFO_LVL_3, MCA_BASE_VAR_SCOPE_LOCAL,
                                   &ompi_add_procs_cutoff);
 
+    ompi_mpi_lazy_procs = false;
+    (void) mca_base_var_register ("ompi", "mpi", NULL, "lazy_procs",
+                                  "Create the resources for a remote process, node-local ones "
+                                  "included, only when this process first communicates with it, "
+                                  "and look up its modex data at that time. MPI_Init then costs "
+                                  "the same whatever the size of the job. Ignored when the PML "
+                                  "needs all the processes up front",
+                                  MCA_BASE_VAR_TYPE_BOOL, NULL,
+                                  0, 0, OPAL_INFO_LVL_3, MCA_BASE_VAR_SCOPE_READONLY,
+                                  &ompi_mpi_lazy_procs);
+
     ompi_mpi_dynamics_enabled = true;
     (void) mca_base_var_register("ompi", "mpi", NULL, "dynamics_enabled",
                                  "Is the MPI dynamic process functionality enabled (e.g., MPI_COMM_SPAWN)?  Default is yes, but certain transports and/or environments may disable it.",
@@ -340,6 +388,95 @@ int ompi_mpi_register_params(void)
                                  MCA_BASE_VAR_SCOPE_READONLY,
                                  &ompi_mpi_spc_dump_enabled);
 
+    ompi_mpi_spc_thread_slots = 0;
+    (void) mca_base_var_register("ompi", "mpi", NULL, "spc_thread_slots",
+                                 "The number of per-thread, cache-line-padded SPC counter slots.  Threads owning a slot update "
+                                 "their counters without atomic operations; once all slots are taken the remaining threads use "
+                                 "the shared counters (default: 0, all threads use the shared counters).",
+                                 MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                 OPAL_INFO_LVL_4,
+                                 MCA_BASE_VAR_SCOPE_READONLY,
+                                 &ompi_mpi_spc_thread_slots);
+
+    ompi_mpi_spc_shm_export = false;
+    (void) mca_base_var_register("ompi", "mpi", NULL, "spc_shm_export",
+                                 "A boolean value for whether (true) or not (false) to keep the SPC counters in a per-process "
+                                 "shared-memory file that external tools can map to sample them while the job runs.",
+                                 MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0,
+                                 OPAL_INFO_LVL_4,
+                                 MCA_BASE_VAR_SCOPE_READONLY,
+                                 &ompi_mpi_spc_shm_export);
+
+    ompi_mpi_spc_shm_dir = NULL;
+    (void) mca_base_var_register("ompi", "mpi", NULL, "spc_shm_dir",
+                                 "The directory in which to create the SPC shared-memory files (default: the job session directory).",
+                                 MCA_BASE_VAR_TYPE_STRING, NULL, 0, 0,
+                                 OPAL_INFO_LVL_4,
+                                 MCA_BASE_VAR_SCOPE_READONLY,
+                                 &ompi_mpi_spc_shm_dir);
+
+    ompi_mpi_spc_timer_histograms = false;
+    (void) mca_base_var_register("ompi", "mpi", NULL, "spc_timer_histograms",
+                                 "A boolean value for whether (true) or not (false) to record a log-linear latency histogram for "
+                                 "each timer-based SPC and expose its buckets and percentiles as MPI_T pvars.",
+                                 MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0,
+                                 OPAL_INFO_LVL_4,
+                                 MCA_BASE_VAR_SCOPE_READONLY,
+                                 &ompi_mpi_spc_timer_histograms);
+
+    ompi_mpi_async_progress = false;
+    (void) mca_base_var_register("ompi", "mpi", NULL, "async_progress",
+                                 "A boolean value for whether (true) or not (false) to start a dedicated thread "
+                                 "driving the progress engine so non-blocking point-to-point and collective "
+                                 "operations advance while the application computes. Enabling it turns on the "
+                                 "MPI_THREAD_MULTIPLE internal locking.",
+                                 MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0,
+                                 OPAL_INFO_LVL_4,
+                                 MCA_BASE_VAR_SCOPE_READONLY,
+                                 &ompi_mpi_async_progress);
+
+    ompi_mpi_async_progress_core = -1;
+    (void) mca_base_var_register("ompi", "mpi", NULL, "async_progress_core",
+                                 "Core to pin the asynchronous progress thread to, given as its logical index among the "
+                                 "cores the process is bound to. -2 selects the last of them and -1 leaves the thread "
+                                 "unpinned (default: -1)",
+                                 MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                 OPAL_INFO_LVL_4,
+                                 MCA_BASE_VAR_SCOPE_READONLY,
+                                 &ompi_mpi_async_progress_core);
+
+    ompi_mpi_async_progress_poll_usec = 0;
+    (void) mca_base_var_register("ompi", "mpi", NULL, "async_progress_poll_usec",
+                                 "Time, in microseconds, the asynchronous progress thread sleeps after a pass over the "
+                                 "progress engine that found nothing to do. 0 busy-polls, which gives the best latency "
+                                 "when the thread has a core of its own (default: 0)",
+                                 MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                 OPAL_INFO_LVL_4,
+                                 MCA_BASE_VAR_SCOPE_READONLY,
+                                 &ompi_mpi_async_progress_poll_usec);
+
+    ompi_mpi_comm_split_distributed_min = 4096;
+    (void) mca_base_var_register("ompi", "mpi", NULL, "comm_split_distributed_min",
+                                 "Communicator size from which MPI_Comm_split on an intra-communicator sends the "
+                                 "(color, key) of each process to a rank owning its color, which returns the "
+                                 "membership of the new group, instead of allgathering the (color, key) of all "
+                                 "the processes. 0 always uses the allgather (default: 4096)",
+                                 MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                 OPAL_INFO_LVL_5,
+                                 MCA_BASE_VAR_SCOPE_READONLY,
+                                 &ompi_mpi_comm_split_distributed_min);
+
+    ompi_mpi_comm_cid_block_size = 8;
+    (void) mca_base_var_register("ompi", "mpi", NULL, "comm_cid_block_size",
+                                 "Number of context IDs an intra-communicator reserves when a communicator is "
+                                 "created from it. The following creations from the same communicator take the "
+                                 "next reserved context ID without agreeing on it, until the block is used up. "
+                                 "Must be the same on all the processes. 1 agrees on every context ID (default: 8)",
+                                 MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                 OPAL_INFO_LVL_5,
+                                 MCA_BASE_VAR_SCOPE_READONLY,
+                                 &ompi_mpi_comm_cid_block_size);
+
     return OMPI_SUCCESS;
 }
 
@@ -20,52 +20,284 @@
 #include "ompi_config.h"
 
 #include <stdlib.h>
+#include <string.h>
+
+#include "opal/mca/hwloc/base/base.h"
 
 #include "ompi/constants.h"
 #include "ompi/mca/pml/pml.h"
+#include "ompi/mca/topo/topo.h"
 #include "ompi/communicator/communicator.h"
+#include "ompi/proc/proc.h"
+#include "ompi/request/request.h"
 #include "ompi/runtime/mpiruntime.h"
-#include "ompi/mca/coll/base/coll_base_util.h"
+#include "ompi/runtime/params.h"
+
+#define PRECONNECT_PATTERN_ALL      0
+#define PRECONNECT_PATTERN_RING     1
+#define PRECONNECT_PATTERN_TOPOLOGY 2
+
+/* Decode a preconnect pattern: "all", "ring:<hops>" or "topology".
+ * Returns -1 for anything else. */
+static int preconnect_pattern_decode(const char *pattern, int *hops)
+{
+    *hops = 0;
+    if (NULL == pattern || 0 == strcmp(pattern, "all")) {
+        return PRECONNECT_PATTERN_ALL;
+    }
+    if (0 == strcmp(pattern, "topology")) {
+        return PRECONNECT_PATTERN_TOPOLOGY;
+    }
+    if (0 == strncmp(pattern, "ring:", 5)) {
+        *hops = atoi(pattern + 5);
+        if (0 < *hops) {
+            return PRECONNECT_PATTERN_RING;
+        }
+    }
+
+    return -1;
+}
+
+bool ompi_mpi_preconnect_pattern_is_valid(const char *pattern)
+{
+    int hops;
+
+    return 0 <= preconnect_pattern_decode(pattern, &hops);
+}
+
+/* Unknown values of mpi_preconnect_pattern were reported when the
+ * parameter was registered and behave like "all". */
+static int preconnect_pattern(int *hops)
+{
+    int pattern = preconnect_pattern_decode(ompi_mpi_preconnect_pattern, hops);
+
+    return (0 <= pattern) ? pattern : PRECONNECT_PATTERN_ALL;
+}
+
+static inline bool preconnect_peer_is_local(ompi_communicator_t *comm, int peer)
+{
+    ompi_proc_t *proc = ompi_group_peer_lookup(comm->c_remote_group, peer);
+    return OPAL_PROC_ON_LOCAL_NODE(proc->super.proc_flags);
+}
+
+/* Exchange one byte with every peer hops 1 to max_hop away on the ring of
+ * the communicator: send to rank + hop and receive from rank - hop. The
+ * hops are processed in batches of window, and all the processes walk the
+ * same batches, so every receive is matched by a send of the same batch.
+ * Node-local peers are connected before the remote ones: whether rank and
+ * rank + hop share a node is the same on both sides of the exchange. */
+static int preconnect_ring(ompi_communicator_t *comm, int max_hop, int window)
+{
+    int size = ompi_comm_size(comm), rank = ompi_comm_rank(comm);
+    int next, prev, nreqs, ret = OMPI_SUCCESS;
+    ompi_request_t **reqs;
+    char *inbuf, outbuf[1];
+    bool local;
+
+    reqs = (ompi_request_t **) malloc(2 * window * sizeof(ompi_request_t *));
+    inbuf = (char *) malloc(window);
+    if (NULL == reqs || NULL == inbuf) {
+        free(reqs);
+        free(inbuf);
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+    outbuf[0] = '\0';
+
+    for (int phase = 0 ; phase < 2 && OMPI_SUCCESS == ret ; ++phase) {
+        local = (0 == phase);
+        for (int hop = 1 ; hop <= max_hop && OMPI_SUCCESS == ret ; hop += window) {
+            nreqs = 0;
+            for (int i = 0 ; i < window && hop + i <= max_hop ; ++i) {
+                next = (rank + hop + i) % size;
+                prev = (rank - hop - i + size) % size;
+
+                if (preconnect_peer_is_local(comm, prev) == local) {
+                    ret = MCA_PML_CALL(irecv(inbuf + i, 1, MPI_CHAR, prev, OMPI_COMM_PRECONNECT_TAG,
+                                             comm, reqs + nreqs));
+                    if (OMPI_SUCCESS != ret) {
+                        break;
+                    }
+                    ++nreqs;
+                }
+                if (preconnect_peer_is_local(comm, next) == local) {
+                    ret = MCA_PML_CALL(isend(outbuf, 1, MPI_CHAR, next, OMPI_COMM_PRECONNECT_TAG,
+                                             MCA_PML_BASE_SEND_STANDARD, comm, reqs + nreqs));
+                    if (OMPI_SUCCESS != ret) {
+                        break;
+                    }
+                    ++nreqs;
+                }
+            }
+
+            if (0 < nreqs) {
+                int rc = ompi_request_wait_all(nreqs, reqs, MPI_STATUSES_IGNORE);
+                if (OMPI_SUCCESS == ret) {
+                    ret = rc;
+                }
+            }
+        }
+    }
+
+    free(reqs);
+    free(inbuf);
+    return ret;
+}
+
+/* Exchange one byte with an arbitrary set of peers. All the receives are
+ * posted first, so the sends cannot wait on each other whatever the
+ * pattern, and at most window of them are in flight at a time. */
+static int preconnect_peers(ompi_communicator_t *comm, int nsend, const int *dests,
+                            int nrecv, const int *sources, int window)
+{
+    ompi_request_t **rreqs, **sreqs;
+    char *inbuf, outbuf[1];
+    int ret = OMPI_SUCCESS, rc, nrreqs = 0, nsreqs;
+
+    rreqs = (ompi_request_t **) malloc((nrecv + window) * sizeof(ompi_request_t *));
+    inbuf = (char *) malloc(nrecv + 1);
+    if (NULL == rreqs || NULL == inbuf) {
+        free(rreqs);
+        free(inbuf);
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+    sreqs = rreqs + nrecv;
+    outbuf[0] = '\0';
+
+    for (int i = 0 ; i < nrecv ; ++i) {
+        if (MPI_PROC_NULL == sources[i]) {
+            continue;
+        }
+        ret = MCA_PML_CALL(irecv(inbuf + i, 1, MPI_CHAR, sources[i], OMPI_COMM_PRECONNECT_TAG,
+                                 comm, rreqs + nrreqs));
+        if (OMPI_SUCCESS != ret) {
+            break;
+        }
+        ++nrreqs;
+    }
+
+    for (int first = 0 ; first < nsend && OMPI_SUCCESS == ret ; first += window) {
+        nsreqs = 0;
+        for (int i = first ; i < nsend && i < first + window ; ++i) {
+            if (MPI_PROC_NULL == dests[i]) {
+                continue;
+            }
+            ret = MCA_PML_CALL(isend(outbuf, 1, MPI_CHAR, dests[i], OMPI_COMM_PRECONNECT_TAG,
+                                     MCA_PML_BASE_SEND_STANDARD, comm, sreqs + nsreqs));
+            if (OMPI_SUCCESS != ret) {
+                break;
+            }
+            ++nsreqs;
+        }
+        if (0 < nsreqs) {
+            rc = ompi_request_wait_all(nsreqs, sreqs, MPI_STATUSES_IGNORE);
+            if (OMPI_SUCCESS == ret) {
+                ret = rc;
+            }
+        }
+    }
+
+    if (0 < nrreqs) {
+        rc = ompi_request_wait_all(nrreqs, rreqs, MPI_STATUSES_IGNORE);
+        if (OMPI_SUCCESS == ret) {
+            ret = rc;
+        }
+    }
+
+    free(rreqs);
+    free(inbuf);
+    return ret;
+}
 
 int
 ompi_init_preconnect_mpi(void)
 {
     int comm_size = ompi_comm_size(MPI_COMM_WORLD);
-    int comm_rank =  ompi_comm_rank(MPI_COMM_WORLD);
-    int param, next, prev, i, ret = OMPI_SUCCESS;
-    char inbuf[1], outbuf[1];
-    const bool *value = NULL;
-
-    param = mca_base_var_find("ompi", "mpi", NULL, "preconnect_mpi");
-    if (0 > param) return OMPI_SUCCESS;
-    ret = mca_base_var_get_value(param, &value, NULL, NULL);
-    if (OMPI_SUCCESS != ret || (NULL != value && 0 == value[0])) {
+    int pattern, hops, window;
+
+    if (!ompi_mpi_preconnect_mpi) {
+        return OMPI_SUCCESS;
+    }
+
+    /* the topology pattern waits for the application to describe its
+       neighborhoods, see ompi_comm_preconnect_topo() */
+    pattern = preconnect_pattern(&hops);
+    if (PRECONNECT_PATTERN_TOPOLOGY == pattern) {
         return OMPI_SUCCESS;
     }
+    if (PRECONNECT_PATTERN_ALL == pattern || hops > comm_size / 2) {
+        hops = comm_size / 2;
+    }
+
+    /* Each hop, every process sends to its neighbor hop ranks to the
+       right and receives from its neighbor hop ranks to the left. At
+       most mpi_preconnect_window hops are in flight at a time, which
+       bounds the number of concurrent connection handshakes each
+       process starts.  A window of 1 is the historical behavior of a
+       single outstanding send and receive; larger windows overlap the
+       handshake latencies without flooding the out-of-band system
+       used to wire up some networks, which can lead to poor
+       performance and hangs. */
+    window = (0 < ompi_mpi_preconnect_window) ? ompi_mpi_preconnect_window : 1;
+
+    return preconnect_ring(MPI_COMM_WORLD, hops, window);
+}
+
+int
+ompi_comm_preconnect_topo(ompi_communicator_t *comm)
+{
+    int pattern, hops, window, ret = OMPI_SUCCESS;
+    int indegree, outdegree, *peers = NULL;
+    int weighted;
+
+    if (!ompi_mpi_preconnect_mpi || MPI_COMM_NULL == comm || NULL == comm->c_topo) {
+        return OMPI_SUCCESS;
+    }
+    pattern = preconnect_pattern(&hops);
+    if (PRECONNECT_PATTERN_TOPOLOGY != pattern) {
+        return OMPI_SUCCESS;
+    }
+    window = (0 < ompi_mpi_preconnect_window) ? ompi_mpi_preconnect_window : 1;
+
+    if (OMPI_COMM_IS_CART(comm)) {
+        int ndims = comm->c_topo->mtc.cart->ndims;
 
-    inbuf[0] = outbuf[0] = '\0';
-
-    /* Each iteration, every process sends to its neighbor i hops to
-       the right and receives from its neighbor i hops to the left.
-       Because send_complete is used, there will only ever be one
-       outstanding send and one outstanding receive in the network at
-       a time for any given process.  This limits any "flooding"
-       effect that can occur with other connection algorithms.  While
-       the flooding algorithms may be a more efficient use of
-       resources, they can overwhelm the out-of-band connection system
-       used to wire up some networks, leading to poor performance and
-       hangs. */
-    for (i = 1 ; i <= comm_size / 2 ; ++i) {
-        next = (comm_rank + i) % comm_size;
-        prev = (comm_rank - i + comm_size) % comm_size;
-
-        ret = ompi_coll_base_sendrecv_actual(outbuf, 1, MPI_CHAR,
-                                             next, 1,
-                                             inbuf, 1, MPI_CHAR,
-                                             prev, 1,
-                                             MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-        if(OMPI_SUCCESS != ret) return ret;
+        /* the destinations and the sources of the shifts, both directions
+         * of each dimension; MPI_PROC_NULL marks a non periodic edge */
+        peers = (int *) malloc((4 * ndims + 1) * sizeof(int));
+        if (NULL == peers) {
+            return OMPI_ERR_OUT_OF_RESOURCE;
+        }
+        for (int d = 0 ; d < ndims && OMPI_SUCCESS == ret ; ++d) {
+            ret = comm->c_topo->topo.cart.cart_shift(comm, d, 1, peers + 2 * ndims + 2 * d,
+                                                     peers + 2 * d);
+            if (OMPI_SUCCESS == ret) {
+                ret = comm->c_topo->topo.cart.cart_shift(comm, d, -1, peers + 2 * ndims + 2 * d + 1,
+                                                         peers + 2 * d + 1);
+            }
+        }
+        if (OMPI_SUCCESS == ret) {
+            ret = preconnect_peers(comm, 2 * ndims, peers, 2 * ndims, peers + 2 * ndims, window);
+        }
+    } else if (OMPI_COMM_IS_DIST_GRAPH(comm)) {
+        ret = comm->c_topo->topo.dist_graph.dist_graph_neighbors_count(comm, &indegree,
+                                                                       &outdegree, &weighted);
+        if (OMPI_SUCCESS != ret) {
+            return ret;
+        }
+        peers = (int *) malloc((indegree + outdegree + 1) * sizeof(int));
+        if (NULL == peers) {
+            return OMPI_ERR_OUT_OF_RESOURCE;
+        }
+        ret = comm->c_topo->topo.dist_graph.dist_graph_neighbors(comm, indegree, peers,
+                                                                 MPI_UNWEIGHTED, outdegree,
+                                                                 peers + indegree, MPI_UNWEIGHTED);
+        if (OMPI_SUCCESS == ret) {
+            ret = preconnect_peers(comm, outdegree, peers + indegree, indegree, peers, window);
+        }
     }
+    /* the edges of a graph communicator are not necessarily listed on both
+       ends, so its peers cannot tell which of them to expect */
 
+    free(peers);
     return ret;
 }
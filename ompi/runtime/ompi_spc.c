@@ -17,6 +17,20 @@
 
 #include "ompi_spc.h"
 
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "opal/align.h"
+#include "opal/runtime/opal.h"
+#include "opal/util/opal_environ.h"
+#include "opal/util/printf.h"
+#include "opal/util/string_copy.h"
+#include "opal/util/bit_ops.h"
+#include "opal/runtime/opal_progress.h"
+#include "ompi/runtime/ompi_rte.h"
+
 opal_timer_t sys_clock_freq_mhz = 0;
 
 static void ompi_spc_dump(void);
@@ -142,15 +156,56 @@ static ompi_spc_event_t ompi_spc_events_names[OMPI_SPC_NUM_COUNTERS] = {
     SET_COUNTER_ARRAY(OMPI_SPC_MAX_UNEXPECTED_IN_QUEUE, "The maximum number of messages that the unexpected message queue(s) within an MPI process "
                                                     "contained at once since the last reset of this counter. Note: This counter is reset each time it is read."),
     SET_COUNTER_ARRAY(OMPI_SPC_MAX_OOS_IN_QUEUE, "The maximum number of messages that the out of sequence message queue(s) within an MPI process "
-                                             "contained at once since the last reset of this counter. Note: This counter is reset each time it is read.")
+                                             "contained at once since the last reset of this counter. Note: This counter is reset each time it is read."),
+    SET_COUNTER_ARRAY(OMPI_SPC_PROGRESS_TIME, "The number of microseconds spent in the progress engine (opal_progress).  Note: This counter "
+                                              "reads the cycle counter twice per progress loop iteration while it is turned on.")
 };
 
 /* An array of integer values to denote whether an event is activated (1) or not (0) */
 static uint32_t ompi_spc_attached_event[OMPI_SPC_NUM_COUNTERS / sizeof(uint32_t)] = { 0 };
 /* An array of integer values to denote whether an event is timer-based (1) or not (0) */
 static uint32_t ompi_spc_timer_event[OMPI_SPC_NUM_COUNTERS / sizeof(uint32_t)] = { 0 };
-/* An array of event structures to store the event data (name and value) */
-static ompi_spc_t *ompi_spc_events = NULL;
+/* An array of integer values to denote whether an event is only updated in the shared slot (1) or not (0) */
+static uint32_t ompi_spc_shared_event[OMPI_SPC_NUM_COUNTERS / sizeof(uint32_t)] = { 0 };
+
+/* The region holding the counter values (see ompi_spc.h for its layout) */
+static char *ompi_spc_region = NULL;
+static size_t ompi_spc_region_size = 0;
+/* The backing file of the region when it is exported through shared memory */
+static char *ompi_spc_region_file = NULL;
+static ompi_spc_region_header_t *ompi_spc_header = NULL;
+/* The values of the slot shared by all threads */
+static ompi_spc_value_t *ompi_spc_shared_values = NULL;
+/* The next per-thread slot to hand out */
+static opal_atomic_int32_t ompi_spc_next_slot = 1;
+
+#if OPAL_HAVE_THREAD_LOCAL
+/* The slot owned by the calling thread: -1 if not yet claimed, 0 if the thread
+ * updates the shared slot and the index of its private slot otherwise.
+ */
+static opal_thread_local int ompi_spc_thread_slot = -1;
+#endif
+
+/* Latency histograms of the timer-based counters, NULL when not enabled */
+static ompi_spc_value_t *ompi_spc_histograms[OMPI_SPC_NUM_COUNTERS] = { NULL };
+
+/* The quantiles reported by the <counter>_PERCENTILES pvars */
+static const double ompi_spc_hist_quantiles[] = { 0.50, 0.90, 0.99, 0.999 };
+#define OMPI_SPC_HIST_NUM_QUANTILES ((int)(sizeof(ompi_spc_hist_quantiles) / sizeof(ompi_spc_hist_quantiles[0])))
+
+/* The kinds of MPI_T pvars attached to a histogram, stored in the upper
+ * bits of the pvar context next to the SPC index.
+ */
+enum {
+    OMPI_SPC_HIST_PVAR_COUNTS,
+    OMPI_SPC_HIST_PVAR_BOUNDS,
+    OMPI_SPC_HIST_PVAR_PERCENTILES
+};
+#define OMPI_SPC_HIST_PVAR_CTX(index, kind) ((void*)(uintptr_t)((index) | ((kind) << 16)))
+
+#define OMPI_SPC_SLOT(slot)                                             \
+    ((volatile size_t*)(ompi_spc_region + ompi_spc_header->slots_offset + \
+                        (size_t)(slot) * ompi_spc_header->slot_stride))
 
 static inline void SET_SPC_BIT(uint32_t* array, int32_t pos)
 {
@@ -170,6 +225,129 @@ static inline void CLEAR_SPC_BIT(uint32_t* array, int32_t pos)
     array[pos / (8 * sizeof(uint32_t))] &= ~(1U << (pos % (8 * sizeof(uint32_t))));
 }
 
+/* Returns the current value of a counter by summing its entry in every slot.
+ * Entries may be concurrently updated by their owner thread, so the result is
+ * a snapshot that can lag behind by the updates in flight.
+ */
+static size_t ompi_spc_read_value(int index)
+{
+    size_t value = 0;
+    uint32_t slot;
+
+    for(slot = 0; slot <= ompi_spc_header->num_slots; slot++) {
+        value += OMPI_SPC_SLOT(slot)[index];
+    }
+    return value;
+}
+
+/* Adds 'value' to a counter, in the private slot of the calling thread when it
+ * owns one and with an atomic add on the shared slot otherwise.
+ */
+static inline void ompi_spc_add(unsigned int event_id, size_t value)
+{
+#if OPAL_HAVE_THREAD_LOCAL
+    if( OPAL_UNLIKELY(ompi_spc_thread_slot < 0) ) {
+        int32_t slot = 0;
+
+        if( 0 < ompi_spc_header->num_slots ) {
+            slot = opal_atomic_fetch_add_32(&ompi_spc_next_slot, 1);
+            if( slot > (int32_t)ompi_spc_header->num_slots ) {
+                /* All slots are taken, fall back on the shared one */
+                slot = 0;
+            }
+        }
+        ompi_spc_thread_slot = slot;
+    }
+    if( 0 < ompi_spc_thread_slot && !IS_SPC_BIT_SET(ompi_spc_shared_event, event_id) ) {
+        /* Only this thread ever writes to this slot, no atomic needed */
+        volatile size_t *values = OMPI_SPC_SLOT(ompi_spc_thread_slot);
+        values[event_id] += value;
+        return;
+    }
+#endif  /* OPAL_HAVE_THREAD_LOCAL */
+    OPAL_THREAD_ADD_FETCH_SIZE_T(&ompi_spc_shared_values[event_id], value);
+}
+
+/* Returns the histogram bucket of a sample of 'cycles' cycles */
+static inline int ompi_spc_hist_bucket(uint64_t cycles)
+{
+    int e;
+
+    if( cycles < OMPI_SPC_HIST_SUB_BUCKETS ) {
+        return (int)cycles;
+    }
+    if( 0 != (cycles >> OMPI_SPC_HIST_MAX_EXP) ) {
+        return OMPI_SPC_HIST_NUM_BUCKETS - 1;
+    }
+    /* Position of the most significant bit, cycles is below 2^40 */
+    if( 0 != (cycles >> 30) ) {
+        e = 30 + opal_hibit((int)(cycles >> 30), OMPI_SPC_HIST_MAX_EXP - 30);
+    } else {
+        e = opal_hibit((int)cycles, 30);
+    }
+    return (e - OMPI_SPC_HIST_SUB_BITS + 1) * OMPI_SPC_HIST_SUB_BUCKETS +
+        (int)((cycles >> (e - OMPI_SPC_HIST_SUB_BITS)) & (OMPI_SPC_HIST_SUB_BUCKETS - 1));
+}
+
+/* Returns the smallest number of cycles that falls into 'bucket' */
+static uint64_t ompi_spc_hist_lower_bound(int bucket)
+{
+    int e;
+
+    if( bucket < OMPI_SPC_HIST_SUB_BUCKETS ) {
+        return (uint64_t)bucket;
+    }
+    e = bucket / OMPI_SPC_HIST_SUB_BUCKETS + OMPI_SPC_HIST_SUB_BITS - 1;
+    return (uint64_t)(OMPI_SPC_HIST_SUB_BUCKETS + bucket % OMPI_SPC_HIST_SUB_BUCKETS) << (e - OMPI_SPC_HIST_SUB_BITS);
+}
+
+/* Computes the quantiles of ompi_spc_hist_quantiles in microseconds.  Each
+ * quantile is reported as the upper bound of the bucket it falls into.
+ */
+static void ompi_spc_hist_percentiles(int index, double *usecs)
+{
+    size_t counts[OMPI_SPC_HIST_NUM_BUCKETS], total = 0, seen = 0, target;
+    int i, q, bucket = 0;
+
+    for(i = 0; i < OMPI_SPC_HIST_NUM_BUCKETS; i++) {
+        counts[i] = ompi_spc_histograms[index][i];
+        total += counts[i];
+    }
+    for(q = 0; q < OMPI_SPC_HIST_NUM_QUANTILES; q++) {
+        if( 0 == total ) {
+            usecs[q] = 0.0;
+            continue;
+        }
+        target = (size_t)(ompi_spc_hist_quantiles[q] * (double)total);
+        if( target < 1 ) {
+            target = 1;
+        }
+        /* The quantiles are sorted, so keep walking from the previous bucket */
+        while( bucket < OMPI_SPC_HIST_NUM_BUCKETS - 1 && seen + counts[bucket] < target ) {
+            seen += counts[bucket++];
+        }
+        usecs[q] = (double)ompi_spc_hist_lower_bound(bucket < OMPI_SPC_HIST_NUM_BUCKETS - 1 ? bucket + 1 : bucket) /
+            (double)sys_clock_freq_mhz;
+    }
+}
+
+/* Records a sample of a timer-based counter in the counter and its histogram */
+static inline void ompi_spc_timer_record(unsigned int event_id, uint64_t cycles)
+{
+    ompi_spc_add(event_id, (size_t)cycles);
+    if( NULL != ompi_spc_histograms[event_id] ) {
+        OPAL_THREAD_ADD_FETCH_SIZE_T(&ompi_spc_histograms[event_id][ompi_spc_hist_bucket(cycles)], 1);
+    }
+}
+
+/* Progress timing callback, installed while OMPI_SPC_PROGRESS_TIME is turned on */
+static void ompi_spc_progress_timing(uint64_t cycles)
+{
+    if( IS_SPC_BIT_SET(ompi_spc_attached_event, OMPI_SPC_PROGRESS_TIME) ) {
+        ompi_spc_timer_record(OMPI_SPC_PROGRESS_TIME, cycles);
+    }
+}
+
 /* ##############################################################
  * ################# Begin MPI_T Functions ######################
  * ##############################################################
@@ -197,15 +375,105 @@ static int ompi_spc_notify(mca_base_pvar_t *pvar, mca_base_pvar_event_t event, v
     /* For this event, we need to turn on the counter */
     else if(MCA_BASE_PVAR_HANDLE_START == event) {
         SET_SPC_BIT(ompi_spc_attached_event, index);
+        if(OMPI_SPC_PROGRESS_TIME == index) {
+            (void)opal_progress_set_timing_callback(ompi_spc_progress_timing);
+        }
     }
     /* For this event, we need to turn off the counter */
     else if(MCA_BASE_PVAR_HANDLE_STOP == event) {
         CLEAR_SPC_BIT(ompi_spc_attached_event, index);
+        if(OMPI_SPC_PROGRESS_TIME == index) {
+            (void)opal_progress_set_timing_callback(NULL);
+        }
+    }
+
+    return MPI_SUCCESS;
+}
+
+/* Notification function of the histogram pvars, which are arrays */
+static int ompi_spc_hist_notify(mca_base_pvar_t *pvar, mca_base_pvar_event_t event, void *obj_handle, int *count)
+{
+    int kind = (int)((uintptr_t)pvar->ctx >> 16);
+
+    if(MCA_BASE_PVAR_HANDLE_BIND == event) {
+        *count = (OMPI_SPC_HIST_PVAR_PERCENTILES == kind) ? OMPI_SPC_HIST_NUM_QUANTILES : OMPI_SPC_HIST_NUM_BUCKETS;
+    }
+
+    return MPI_SUCCESS;
+}
+
+/* Returns the bucket counts, the bucket lower bounds in microseconds or the
+ * percentiles in microseconds of a histogram, depending on the pvar.
+ */
+static int ompi_spc_get_histogram(const struct mca_base_pvar_t *pvar, void *value, void *obj_handle)
+{
+    int index = (int)((uintptr_t)pvar->ctx & 0xffff);
+    int kind = (int)((uintptr_t)pvar->ctx >> 16);
+    int i;
+
+    switch(kind) {
+    case OMPI_SPC_HIST_PVAR_COUNTS:
+        for(i = 0; i < OMPI_SPC_HIST_NUM_BUCKETS; i++) {
+            ((unsigned long long*)value)[i] = (unsigned long long)ompi_spc_histograms[index][i];
+        }
+        break;
+    case OMPI_SPC_HIST_PVAR_BOUNDS:
+        for(i = 0; i < OMPI_SPC_HIST_NUM_BUCKETS; i++) {
+            ((double*)value)[i] = (double)ompi_spc_hist_lower_bound(i) / (double)sys_clock_freq_mhz;
+        }
+        break;
+    default:
+        ompi_spc_hist_percentiles(index, (double*)value);
     }
 
     return MPI_SUCCESS;
 }
 
+/* Allocates the latency histogram of a timer-based counter and registers its
+ * bucket counts, bucket bounds and percentiles as MPI_T pvars.
+ */
+static void ompi_spc_hist_register(int index)
+{
+    static const struct {
+        const char *suffix, *description;
+        int var_class;
+        mca_base_var_type_t type;
+    } pvars[] = {
+        [OMPI_SPC_HIST_PVAR_COUNTS] = { "HISTOGRAM", "The number of samples of %s in each bucket of its log-linear latency histogram.",
+                                        MCA_BASE_PVAR_CLASS_COUNTER, MCA_BASE_VAR_TYPE_UNSIGNED_LONG_LONG },
+        [OMPI_SPC_HIST_PVAR_BOUNDS] = { "HISTOGRAM_BOUNDS", "The lower bound, in microseconds, of each bucket of the latency histogram of %s.",
+                                        MCA_BASE_PVAR_CLASS_GENERIC, MCA_BASE_VAR_TYPE_DOUBLE },
+        [OMPI_SPC_HIST_PVAR_PERCENTILES] = { "PERCENTILES", "The 50th, 90th, 99th and 99.9th percentiles, in microseconds, of the samples of %s.",
+                                             MCA_BASE_PVAR_CLASS_GENERIC, MCA_BASE_VAR_TYPE_DOUBLE }
+    };
+    char *name, *description;
+    int kind, ret;
+
+    ompi_spc_histograms[index] = (ompi_spc_value_t*)calloc(OMPI_SPC_HIST_NUM_BUCKETS, sizeof(ompi_spc_value_t));
+    if(NULL == ompi_spc_histograms[index]) {
+        return;
+    }
+
+    for(kind = OMPI_SPC_HIST_PVAR_COUNTS; kind <= OMPI_SPC_HIST_PVAR_PERCENTILES; kind++) {
+        if(0 > opal_asprintf(&name, "%s_%s", ompi_spc_events_names[index].counter_name, pvars[kind].suffix)) {
+            return;
+        }
+        if(0 > opal_asprintf(&description, pvars[kind].description, ompi_spc_events_names[index].counter_name)) {
+            free(name);
+            return;
+        }
+        ret = mca_base_pvar_register("ompi", "runtime", "spc", name, description,
+                                     OPAL_INFO_LVL_4, pvars[kind].var_class, pvars[kind].type, NULL, MPI_T_BIND_NO_OBJECT,
+                                     MCA_BASE_PVAR_FLAG_READONLY | MCA_BASE_PVAR_FLAG_CONTINUOUS,
+                                     ompi_spc_get_histogram, NULL, ompi_spc_hist_notify, OMPI_SPC_HIST_PVAR_CTX(index, kind));
+        free(name);
+        free(description);
+        if( ret < 0 ) {
+            return;
+        }
+    }
+}
+
 /* ##############################################################
  * ################# Begin SPC Functions ########################
  * ##############################################################
@@ -231,39 +499,128 @@ static int ompi_spc_get_count(const struct mca_base_pvar_t *pvar, void *value, v
     /* Convert from MPI_T pvar index to SPC index */
     int index = (int)(uintptr_t)pvar->ctx;
     /* Set the counter value to the current SPC value */
-    *counter_value = (long long)ompi_spc_events[index].value;
+    *counter_value = (long long)ompi_spc_read_value(index);
     /* If this is a timer-based counter, convert from cycles to microseconds */
     if( IS_SPC_BIT_SET(ompi_spc_timer_event, index) ) {
         *counter_value /= sys_clock_freq_mhz;
     }
     /* If this is a high watermark counter, reset it after it has been read */
     if(index == OMPI_SPC_MAX_UNEXPECTED_IN_QUEUE || index == OMPI_SPC_MAX_OOS_IN_QUEUE) {
-        ompi_spc_events[index].value = 0;
+        ompi_spc_shared_values[index] = 0;
     }
 
     return MPI_SUCCESS;
 }
 
+/* Allocates the counter region, in a file mapped in mpi_spc_shm_dir if the
+ * counters are exported, and from the heap otherwise.
+ */
+static int ompi_spc_region_create(void)
+{
+    size_t line = (0 < opal_cache_line_size) ? (size_t)opal_cache_line_size : 64;
+    size_t names_offset, slots_offset, slot_stride;
+    uint32_t num_slots = (0 < ompi_mpi_spc_thread_slots) ? (uint32_t)ompi_mpi_spc_thread_slots : 0;
+    const char *dir;
+    int fd, i;
+
+    names_offset = OPAL_ALIGN(sizeof(ompi_spc_region_header_t), line, size_t);
+    slots_offset = OPAL_ALIGN(names_offset + OMPI_SPC_NUM_COUNTERS * sizeof(ompi_spc_region_name_t),
+                              line, size_t);
+    slot_stride  = OPAL_ALIGN(OMPI_SPC_NUM_COUNTERS * sizeof(size_t), line, size_t);
+    ompi_spc_region_size = slots_offset + (num_slots + 1) * slot_stride;
+
+    if( ompi_mpi_spc_shm_export ) {
+        dir = ompi_mpi_spc_shm_dir;
+        if( NULL == dir ) {
+            dir = (NULL != ompi_process_info.job_session_dir) ? ompi_process_info.job_session_dir : opal_tmp_directory();
+        }
+        if( 0 > opal_asprintf(&ompi_spc_region_file, "%s" OPAL_PATH_SEP "spc_segment.%s.%x.%d", dir,
+                              ompi_process_info.nodename, OMPI_PROC_MY_NAME->jobid, OMPI_PROC_MY_NAME->vpid) ) {
+            ompi_spc_region_file = NULL;
+        } else if( 0 <= (fd = open(ompi_spc_region_file, O_CREAT | O_RDWR | O_TRUNC, 0600)) ) {
+            if( 0 == ftruncate(fd, ompi_spc_region_size) ) {
+                ompi_spc_region = mmap(NULL, ompi_spc_region_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                if( MAP_FAILED == ompi_spc_region ) {
+                    ompi_spc_region = NULL;
+                }
+            }
+            close(fd);
+        }
+        if( NULL == ompi_spc_region ) {
+            opal_show_help("help-mpi-runtime.txt", "spc: shm export failed", true,
+                           (NULL != ompi_spc_region_file) ? ompi_spc_region_file : dir, strerror(errno));
+            if( NULL != ompi_spc_region_file ) {
+                unlink(ompi_spc_region_file);
+                free(ompi_spc_region_file);
+                ompi_spc_region_file = NULL;
+            }
+        }
+    }
+
+    if( NULL == ompi_spc_region ) {
+        if( 0 != posix_memalign((void**)&ompi_spc_region, line, ompi_spc_region_size) ) {
+            ompi_spc_region = NULL;
+            return OMPI_ERR_OUT_OF_RESOURCE;
+        }
+        memset(ompi_spc_region, 0, ompi_spc_region_size);
+    }
+
+    ompi_spc_header = (ompi_spc_region_header_t*)ompi_spc_region;
+    ompi_spc_header->version = OMPI_SPC_REGION_VERSION;
+    ompi_spc_header->num_counters = OMPI_SPC_NUM_COUNTERS;
+    ompi_spc_header->num_slots = num_slots;
+    ompi_spc_header->value_size = sizeof(size_t);
+    ompi_spc_header->slot_stride = (uint32_t)slot_stride;
+    ompi_spc_header->names_offset = names_offset;
+    ompi_spc_header->slots_offset = slots_offset;
+    ompi_spc_header->cycles_per_usec = sys_clock_freq_mhz;
+    ompi_spc_header->world_rank = (int32_t)OMPI_PROC_MY_NAME->vpid;
+    ompi_spc_header->pid = (int32_t)getpid();
+    for(i = 0; i < OMPI_SPC_NUM_COUNTERS; i++) {
+        ompi_spc_region_name_t *entry = (ompi_spc_region_name_t*)(ompi_spc_region + names_offset) + i;
+        opal_string_copy(entry->name, ompi_spc_events_names[i].counter_name, OMPI_SPC_NAME_LEN);
+    }
+    ompi_spc_shared_values = (ompi_spc_value_t*)OMPI_SPC_SLOT(0);
+
+    return OMPI_SUCCESS;
+}
+
+/* Publishes the per-counter flags in the region and marks it valid for readers */
+static void ompi_spc_region_publish(void)
+{
+    ompi_spc_region_name_t *names = (ompi_spc_region_name_t*)(ompi_spc_region + ompi_spc_header->names_offset);
+    int i;
+
+    for(i = 0; i < OMPI_SPC_NUM_COUNTERS; i++) {
+        names[i].flags = (IS_SPC_BIT_SET(ompi_spc_timer_event, i) ? OMPI_SPC_FLAG_TIMER : 0) |
+                         (IS_SPC_BIT_SET(ompi_spc_shared_event, i) ? OMPI_SPC_FLAG_SHARED : 0);
+    }
+    /* Make sure the header is complete before readers can see the magic */
+    opal_atomic_wmb();
+    ompi_spc_header->magic = OMPI_SPC_REGION_MAGIC;
+}
+
 /* Initializes the events data structure and allocates memory for it if needed. */
 void ompi_spc_events_init(void)
 {
+    uint32_t slot;
     int i;
 
     /* If the events data structure hasn't been allocated yet, allocate memory for it */
-    if(NULL == ompi_spc_events) {
-        ompi_spc_events = (ompi_spc_t*)malloc(OMPI_SPC_NUM_COUNTERS * sizeof(ompi_spc_t));
-        if(ompi_spc_events == NULL) {
+    if(NULL == ompi_spc_region) {
+        if(OMPI_SUCCESS != ompi_spc_region_create()) {
             opal_show_help("help-mpi-runtime.txt", "lib-call-fail", true,
-                           "malloc", __FILE__, __LINE__);
+                           "posix_memalign", __FILE__, __LINE__);
             return;
         }
     }
-    /* The data structure has been allocated, so we simply initialize all of the counters
-     * with their names and an initial count of 0.
+    /* The data structure has been allocated, so we simply reset all of the counters
+     * in every slot to an initial count of 0.
      */
-    for(i = 0; i < OMPI_SPC_NUM_COUNTERS; i++) {
-        ompi_spc_events[i].name = (char*)ompi_spc_events_names[i].counter_name;
-        ompi_spc_events[i].value = 0;
+    for(slot = 0; slot <= ompi_spc_header->num_slots; slot++) {
+        for(i = 0; i < OMPI_SPC_NUM_COUNTERS; i++) {
+            OMPI_SPC_SLOT(slot)[i] = 0;
+        }
     }
 
     ompi_comm_dup(&ompi_mpi_comm_world.comm, &ompi_spc_comm);
@@ -280,6 +637,17 @@ void ompi_spc_init(void)
     sys_clock_freq_mhz = opal_timer_base_get_freq() / 1000000;
 
     ompi_spc_events_init();
+    if(NULL == ompi_spc_region) {
+        return;
+    }
+
+    /* The queue length counters go up and down from different threads and are
+     * compared against their high watermark, so they are kept in the shared slot.
+     */
+    SET_SPC_BIT(ompi_spc_shared_event, OMPI_SPC_UNEXPECTED_IN_QUEUE);
+    SET_SPC_BIT(ompi_spc_shared_event, OMPI_SPC_OOS_IN_QUEUE);
+    SET_SPC_BIT(ompi_spc_shared_event, OMPI_SPC_MAX_UNEXPECTED_IN_QUEUE);
+    SET_SPC_BIT(ompi_spc_shared_event, OMPI_SPC_MAX_OOS_IN_QUEUE);
 
     /* Get the MCA params string of counters to turn on */
     char **arg_strings = opal_argv_split(ompi_mpi_spc_attach_string, ',');
@@ -330,6 +698,22 @@ void ompi_spc_init(void)
 
     /* If this is a timer event, set the corresponding timer_event entry */
     SET_SPC_BIT(ompi_spc_timer_event, OMPI_SPC_MATCH_TIME);
+    SET_SPC_BIT(ompi_spc_timer_event, OMPI_SPC_PROGRESS_TIME);
+
+    /* Attach a latency histogram to every timer-based counter if requested */
+    if( mpi_t_enabled && ompi_mpi_spc_timer_histograms ) {
+        for(i = 0; i < OMPI_SPC_NUM_COUNTERS; i++) {
+            if( IS_SPC_BIT_SET(ompi_spc_timer_event, i) ) {
+                ompi_spc_hist_register(i);
+            }
+        }
+    }
+
+    if( IS_SPC_BIT_SET(ompi_spc_attached_event, OMPI_SPC_PROGRESS_TIME) ) {
+        (void)opal_progress_set_timing_callback(ompi_spc_progress_timing);
+    }
+
+    ompi_spc_region_publish();
 
     opal_argv_free(arg_strings);
 }
@@ -345,13 +729,6 @@ static void ompi_spc_dump(void)
     int rank = ompi_comm_rank(ompi_spc_comm);
     world_size = ompi_comm_size(ompi_spc_comm);
 
-    /* Convert from cycles to usecs before sending */
-    for(i = 0; i < OMPI_SPC_NUM_COUNTERS; i++) {
-        if( IS_SPC_BIT_SET(ompi_spc_timer_event, i) ) {
-            SPC_CYCLES_TO_USECS(&ompi_spc_events[i].value);
-        }
-    }
-
     /* Aggregate all of the information on rank 0 using MPI_Gather on MPI_COMM_WORLD */
     send_buffer = (long long*)malloc(OMPI_SPC_NUM_COUNTERS * sizeof(long long));
     if (NULL == send_buffer) {
@@ -360,7 +737,11 @@ static void ompi_spc_dump(void)
         return;
     }
     for(i = 0; i < OMPI_SPC_NUM_COUNTERS; i++) {
-        send_buffer[i] = (long long)ompi_spc_events[i].value;
+        send_buffer[i] = (long long)ompi_spc_read_value(i);
+        /* Convert from cycles to usecs before sending */
+        if( IS_SPC_BIT_SET(ompi_spc_timer_event, i) ) {
+            send_buffer[i] /= (long long)sys_clock_freq_mhz;
+        }
     }
     if( 0 == rank ) {
         recv_buffer = (long long*)malloc(world_size * OMPI_SPC_NUM_COUNTERS * sizeof(long long));
@@ -382,11 +763,10 @@ static void ompi_spc_dump(void)
         for(j = 0; j < world_size; j++) {
             opal_output(0, "MPI_COMM_WORLD Rank %d:\n", j);
             for(i = 0; i < OMPI_SPC_NUM_COUNTERS; i++) {
-                /* If this is a timer-based counter, we need to covert from cycles to usecs */
                 if( 0 == recv_buffer[offset+i] ) {
                     continue;
                 }
-                opal_output(0, "%s -> %lld\n", ompi_spc_events[i].name, recv_buffer[offset+i]);
+                opal_output(0, "%s -> %lld\n", ompi_spc_events_names[i].counter_name, recv_buffer[offset+i]);
             }
             opal_output(0, "\n");
             offset += OMPI_SPC_NUM_COUNTERS;
@@ -405,20 +785,42 @@ static void ompi_spc_dump(void)
 /* Frees any dynamically alocated OMPI SPC data structures */
 void ompi_spc_fini(void)
 {
+    if (NULL == ompi_spc_region) {
+        return;
+    }
+
+    (void)opal_progress_set_timing_callback(NULL);
+
     if (SPC_ENABLE == 1 && ompi_mpi_spc_dump_enabled) {
         ompi_spc_dump();
     }
 
-    free(ompi_spc_events); ompi_spc_events = NULL;
+    for (int i = 0; i < OMPI_SPC_NUM_COUNTERS; i++) {
+        free(ompi_spc_histograms[i]);
+        ompi_spc_histograms[i] = NULL;
+    }
+
+    if (NULL != ompi_spc_region_file) {
+        munmap(ompi_spc_region, ompi_spc_region_size);
+        unlink(ompi_spc_region_file);
+        free(ompi_spc_region_file); ompi_spc_region_file = NULL;
+    } else {
+        free(ompi_spc_region);
+    }
+    ompi_spc_region = NULL;
+    ompi_spc_header = NULL;
+    ompi_spc_shared_values = NULL;
     ompi_comm_free(&ompi_spc_comm);
 }
 
-/* Records an update to a counter using an atomic add operation. */
+/* Records an update to a counter, in the per-thread slot of the caller if it
+ * owns one and using an atomic add operation otherwise.
+ */
 void ompi_spc_record(unsigned int event_id, ompi_spc_value_t value)
 {
     /* Denoted unlikely because counters will often be turned off. */
     if( OPAL_UNLIKELY(IS_SPC_BIT_SET(ompi_spc_attached_event, event_id)) ) {
-        OPAL_THREAD_ADD_FETCH_SIZE_T(&(ompi_spc_events[event_id].value), value);
+        ompi_spc_add(event_id, (size_t)value);
     }
 }
 
@@ -445,7 +847,7 @@ void ompi_spc_timer_stop(unsigned int event_id, opal_timer_t *cycles)
     /* This is denoted unlikely because the counters will often be turned off. */
     if( OPAL_UNLIKELY(IS_SPC_BIT_SET(ompi_spc_attached_event, event_id)) ) {
         *cycles = opal_timer_base_get_cycles() - *cycles;
-        OPAL_THREAD_ADD_FETCH_SIZE_T(&ompi_spc_events[event_id].value, (size_t) *cycles);
+        ompi_spc_timer_record(event_id, (uint64_t) *cycles);
     }
 }
 
@@ -469,8 +871,8 @@ void ompi_spc_update_watermark(unsigned int watermark_enum, unsigned int value_e
         /* WARNING: This assumes that this function was called while a lock has already been taken.
          *          This function is NOT thread safe otherwise!
          */
-        if(ompi_spc_events[value_enum].value > ompi_spc_events[watermark_enum].value) {
-            ompi_spc_events[watermark_enum].value = ompi_spc_events[value_enum].value;
+        if(ompi_spc_shared_values[value_enum] > ompi_spc_shared_values[watermark_enum]) {
+            ompi_spc_shared_values[watermark_enum] = ompi_spc_shared_values[value_enum];
         }
     }
 }
@@ -48,6 +48,8 @@
  *     SPC_TIMER_START and SPC_TIMER_STOP macros to record
  *     the time in cycles to then be converted to microseconds later
  *     in the ompi_spc_get_count function when requested by MPI_T
+ * 5.) Timer-based counters automatically get a latency histogram when
+ *     the mpi_spc_timer_histograms MCA parameter is set.
  */
 
 /* This enumeration serves as event ids for the various events */
@@ -160,6 +162,7 @@ typedef enum ompi_spc_counters {
     OMPI_SPC_OOS_IN_QUEUE,
     OMPI_SPC_MAX_UNEXPECTED_IN_QUEUE,
     OMPI_SPC_MAX_OOS_IN_QUEUE,
+    OMPI_SPC_PROGRESS_TIME,
     OMPI_SPC_NUM_COUNTERS /* This serves as the number of counters.  It must be last. */
 } ompi_spc_counters_t;
 
@@ -168,11 +171,62 @@ typedef enum ompi_spc_counters {
  */
 typedef opal_atomic_size_t ompi_spc_value_t;
 
-/* A structure for storing the event data */
-typedef struct ompi_spc_s{
-    char *name;
-    ompi_spc_value_t value;
-} ompi_spc_t;
+/* LAYOUT OF THE SPC COUNTER REGION
+ * All counter values live in a single region made of an ompi_spc_region_header_t,
+ * a table of OMPI_SPC_NUM_COUNTERS ompi_spc_region_name_t entries and
+ * (1 + num_slots) slots of OMPI_SPC_NUM_COUNTERS size_t values each.  Slot 0
+ * is shared by all threads and updated atomically.  The remaining slots are
+ * handed out to threads on their first update (mpi_spc_thread_slots) and are
+ * only ever written by their owner, so updates are plain stores.  Every slot
+ * starts on its own cache line.  The value of a counter is the sum of its
+ * entry in all slots.
+ *
+ * When mpi_spc_shm_export is set the region is a file mapped in
+ * mpi_spc_shm_dir (the job session directory by default) named
+ * spc_segment.<nodename>.<jobid>.<vpid>, so that external tools can sample
+ * the counters of all local processes without calling into MPI.  Timer-based
+ * counters are exported in cycles; divide by cycles_per_usec to convert them.
+ */
+#define OMPI_SPC_REGION_MAGIC   0x4f535043  /* "OSPC" */
+#define OMPI_SPC_REGION_VERSION 1
+#define OMPI_SPC_NAME_LEN       60
+
+/* Counter flags exported in the name table */
+#define OMPI_SPC_FLAG_TIMER     0x1  /* value is in cycles */
+#define OMPI_SPC_FLAG_SHARED    0x2  /* only ever updated in the shared slot */
+
+typedef struct ompi_spc_region_header_t {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t num_counters;
+    uint32_t num_slots;        /* number of per-thread slots after the shared one */
+    uint32_t value_size;       /* sizeof(size_t) of the writer */
+    uint32_t slot_stride;      /* bytes between the start of consecutive slots */
+    uint64_t names_offset;     /* offset of the name table from the region start */
+    uint64_t slots_offset;     /* offset of the shared slot from the region start */
+    uint64_t cycles_per_usec;
+    int32_t  world_rank;
+    int32_t  pid;
+} ompi_spc_region_header_t;
+
+typedef struct ompi_spc_region_name_t {
+    uint32_t flags;
+    char name[OMPI_SPC_NAME_LEN];
+} ompi_spc_region_name_t;
+
+/* LATENCY HISTOGRAMS
+ * Each sample of a timer-based counter is also binned, in cycles, into a
+ * log-linear histogram: the first OMPI_SPC_HIST_SUB_BUCKETS buckets hold one
+ * value each, then every power of two [2^e, 2^(e+1)) is split into
+ * OMPI_SPC_HIST_SUB_BUCKETS equal buckets, which bounds the relative error of
+ * a reported quantile to 1/OMPI_SPC_HIST_SUB_BUCKETS.  Samples of
+ * 2^OMPI_SPC_HIST_MAX_EXP cycles and more go into the last bucket.
+ */
+#define OMPI_SPC_HIST_SUB_BITS    3
+#define OMPI_SPC_HIST_SUB_BUCKETS (1 << OMPI_SPC_HIST_SUB_BITS)
+#define OMPI_SPC_HIST_MAX_EXP     40
+#define OMPI_SPC_HIST_NUM_BUCKETS \
+    ((OMPI_SPC_HIST_MAX_EXP - OMPI_SPC_HIST_SUB_BITS + 1) * OMPI_SPC_HIST_SUB_BUCKETS + 1)
 
 /* Events data structure initialization function */
 void ompi_spc_events_init(void);
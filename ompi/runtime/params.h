@@ -129,6 +129,13 @@ OMPI_DECLSPEC extern bool ompi_use_sparse_group_storage;
  */
 OMPI_DECLSPEC extern uint32_t ompi_add_procs_cutoff;
 
+/**
+ * Whether the ompi_proc_t's, including the ones of the node-local
+ * peers, and their PML endpoints are only created on first
+ * communication with a process
+ */
+OMPI_DECLSPEC extern bool ompi_mpi_lazy_procs;
+
 /**
  * Whether anything in the code base has disabled MPI dynamic process
  * functionality or not
@@ -154,6 +161,78 @@ OMPI_DECLSPEC extern char * ompi_mpi_spc_attach_string;
  */
 OMPI_DECLSPEC extern bool ompi_mpi_spc_dump_enabled;
 
+/**
+ * The number of per-thread SPC counter slots.  Threads that own a slot
+ * update their counters with plain stores instead of atomic operations.
+ */
+OMPI_DECLSPEC extern int ompi_mpi_spc_thread_slots;
+
+/**
+ * A boolean value that determines whether or not the SPC counters are kept
+ * in a shared-memory file that external tools can map and sample.
+ */
+OMPI_DECLSPEC extern bool ompi_mpi_spc_shm_export;
+
+/**
+ * The directory in which the SPC shared-memory files are created.  NULL
+ * selects the job session directory.
+ */
+OMPI_DECLSPEC extern char * ompi_mpi_spc_shm_dir;
+
+/**
+ * A boolean value that determines whether or not timer-based SPC counters
+ * record a latency histogram, exposed through MPI_T.
+ */
+OMPI_DECLSPEC extern bool ompi_mpi_spc_timer_histograms;
+
+/**
+ * A boolean value that determines whether or not a dedicated thread
+ * drives the progress engine in the background.
+ */
+OMPI_DECLSPEC extern bool ompi_mpi_async_progress;
+
+/**
+ * Core the asynchronous progress thread is pinned to: its logical
+ * index among the cores this process is bound to, -2 for the last
+ * of them or -1 to leave the thread unpinned.
+ */
+OMPI_DECLSPEC extern int ompi_mpi_async_progress_core;
+
+/**
+ * Time, in microseconds, the asynchronous progress thread sleeps
+ * after an idle pass over the progress engine (0 busy-polls).
+ */
+OMPI_DECLSPEC extern int ompi_mpi_async_progress_poll_usec;
+
+/**
+ * Size from which MPI_Comm_split on an intra-communicator exchanges
+ * the (color, key) pairs with the owner of each color instead of
+ * allgathering them (0 always allgathers).
+ */
+OMPI_DECLSPEC extern int ompi_mpi_comm_split_distributed_min;
+
+/**
+ * Number of context IDs an intra-communicator reserves at once for the
+ * communicators created from it (1 agrees on every context ID).
+ */
+OMPI_DECLSPEC extern int ompi_mpi_comm_cid_block_size;
+
+/**
+ * Whether to wire up the MPI connections eagerly (mpi_preconnect_mpi)
+ */
+OMPI_DECLSPEC extern bool ompi_mpi_preconnect_mpi;
+
+/**
+ * Maximum number of peers a process connects to concurrently when
+ * preconnecting.
+ */
+OMPI_DECLSPEC extern int ompi_mpi_preconnect_window;
+
+/**
+ * Peers to preconnect: "all", "ring:<n>" or "topology".
+ */
+OMPI_DECLSPEC extern char *ompi_mpi_preconnect_pattern;
+
 
 /**
  * Register MCA parameters used by the MPI layer.
@@ -524,6 +524,9 @@ void mca_btl_tcp_endpoint_close(mca_btl_base_endpoint_t* btl_endpoint)
     if( mca_btl_tcp_event_base == opal_sync_event_base ) {
         /* If no progress thread then lower the awarness of the default progress engine */
         opal_progress_event_users_decrement();
+        if( opal_progress_wait_hybrid ) {
+            (void) opal_progress_wait_unregister_fd(btl_endpoint->endpoint_sd);
+        }
     }
     MCA_BTL_TCP_ENDPOINT_DUMP(1, btl_endpoint, false, "event_del(send) [close]");
     opal_event_del(&btl_endpoint->endpoint_send_event);
@@ -592,6 +595,11 @@ static void mca_btl_tcp_endpoint_connected(mca_btl_base_endpoint_t* btl_endpoint
     btl_endpoint->endpoint_retries = 0;
     MCA_BTL_TCP_ENDPOINT_DUMP(1, btl_endpoint, true, "READY [endpoint_connected]");
 
+    if( opal_progress_wait_hybrid && mca_btl_tcp_event_base == opal_sync_event_base ) {
+        /* let blocked waiters sleep until data shows up on the socket */
+        (void) opal_progress_wait_register_fd(btl_endpoint->endpoint_sd);
+    }
+
     if(opal_list_get_size(&btl_endpoint->endpoint_frags) > 0) {
         if(NULL == btl_endpoint->endpoint_send_frag)
             btl_endpoint->endpoint_send_frag = (mca_btl_tcp_frag_t*)
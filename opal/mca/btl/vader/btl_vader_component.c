@@ -336,6 +336,9 @@ static int mca_btl_vader_component_close(void)
     OBJ_DESTRUCT(&mca_btl_vader_component.pending_endpoints);
     OBJ_DESTRUCT(&mca_btl_vader_component.pending_fragments);
 
+    /* the wait control block lives in the segment */
+    opal_progress_wait_set_ctl (NULL);
+
     if (MCA_BTL_VADER_XPMEM == mca_btl_vader_component.single_copy_mechanism &&
         NULL != mca_btl_vader_component.my_segment) {
         munmap (mca_btl_vader_component.my_segment, mca_btl_vader_component.segment_size);
@@ -618,6 +621,8 @@ static mca_btl_base_module_t **mca_btl_vader_component_init (int *num_btls,
 
     return btls;
 failed:
+    opal_progress_wait_set_ctl (NULL);
+
 #if OPAL_BTL_VADER_HAVE_XPMEM
     if (MCA_BTL_VADER_XPMEM == mca_btl_vader_component.single_copy_mechanism) {
         munmap (component->my_segment, component->segment_size);
@@ -30,6 +30,8 @@
 #include "btl_vader_endpoint.h"
 #include "btl_vader_frag.h"
 
+#include "opal/runtime/opal_progress.h"
+
 #define vader_item_compare_exchange(x, y, z) opal_atomic_compare_exchange_strong_ptr ((opal_atomic_intptr_t *) (x), (intptr_t *) (y), (intptr_t) (z))
 
 #if SIZEOF_VOID_P == 8
@@ -70,6 +72,8 @@ typedef struct vader_fifo_t {
     atomic_fifo_value_t fifo_head;
     atomic_fifo_value_t fifo_tail;
     opal_atomic_int32_t fbox_available;
+    /* senders wake the owner up through this if it blocks in a hybrid wait */
+    opal_progress_wait_ctl_t wait_ctl;
 } vader_fifo_t;
 
 /* large enough to ensure the fifo is on its own cache line */
@@ -100,6 +104,17 @@ static inline void *relative2virtual (fifo_value_t offset)
     return (void *)(intptr_t)((offset & MCA_BTL_VADER_OFFSET_MASK) + mca_btl_vader_component.endpoints[offset >> MCA_BTL_VADER_OFFSET_BITS].segment_base);
 }
 
+/**
+ * Wake up the peer if it went to sleep waiting for data. Must be called
+ * after the data is visible in the fifo or fast box.
+ */
+static inline void mca_btl_vader_wake_peer (struct mca_btl_base_endpoint_t *ep)
+{
+    if (opal_progress_wait_hybrid) {
+        opal_progress_wakeup (&ep->fifo->wait_ctl);
+    }
+}
+
 #include "btl_vader_fbox.h"
 
 /**
@@ -160,7 +175,12 @@ static inline void vader_fifo_init (vader_fifo_t *fifo)
     fifo->fifo_head = VADER_FIFO_FREE;
     fifo->fifo_tail = VADER_FIFO_FREE;
     fifo->fbox_available = mca_btl_vader_component.fbox_max;
+    fifo->wait_ctl.seq = 0;
+    fifo->wait_ctl.sleepers = 0;
     mca_btl_vader_component.my_fifo = fifo;
+
+    /* sleep where local peers can wake us up */
+    opal_progress_wait_set_ctl (&fifo->wait_ctl);
 }
 
 static inline void vader_fifo_write (vader_fifo_t *fifo, fifo_value_t value)
@@ -206,6 +226,7 @@ static inline bool vader_fifo_write_ep (mca_btl_vader_hdr_t *hdr, struct mca_btl
     mca_btl_vader_try_fbox_setup (ep, hdr);
     hdr->next = VADER_FIFO_FREE;
     vader_fifo_write (ep->fifo, rhdr);
+    mca_btl_vader_wake_peer (ep);
 
     return true;
 }
@@ -225,6 +246,7 @@ static inline void vader_fifo_write_back (mca_btl_vader_hdr_t *hdr, struct mca_b
 {
     hdr->next = VADER_FIFO_FREE;
     vader_fifo_write(ep->fifo, virtual2relativepeer (ep, (char *) hdr));
+    mca_btl_vader_wake_peer (ep);
 }
 
 #endif /* MCA_BTL_VADER_FIFO_H */
@@ -438,6 +438,8 @@ static int vader_finalize(struct mca_btl_base_module_t *btl)
     free (component->fbox_in_endpoints);
     component->fbox_in_endpoints = NULL;
 
+    opal_progress_wait_set_ctl (NULL);
+
     if (MCA_BTL_VADER_XPMEM != mca_btl_vader_component.single_copy_mechanism) {
         opal_shmem_unlink (&mca_btl_vader_component.seg_ds);
         opal_shmem_segment_detach (&mca_btl_vader_component.seg_ds);
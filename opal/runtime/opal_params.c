@@ -172,6 +172,84 @@ int opal_register_params(void)
                                  &opal_progress_yield_when_idle);
 #endif
 
+    opal_progress_adaptive = false;
+    ret = mca_base_var_register ("opal", "opal", "progress", "adaptive",
+                                 "Back off polling of progress callbacks that did not progress any event recently. "
+                                 "Callbacks that progress an event are polled on every call again.",
+                                 MCA_BASE_VAR_TYPE_BOOL, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE,
+                                 OPAL_INFO_LVL_8, MCA_BASE_VAR_SCOPE_LOCAL,
+                                 &opal_progress_adaptive);
+    if (0 > ret) {
+        return ret;
+    }
+
+    opal_progress_backoff_threshold = 32;
+    ret = mca_base_var_register ("opal", "opal", "progress", "backoff_threshold",
+                                 "Number of consecutive idle polls after which the polling interval of a progress "
+                                 "callback is doubled when opal_progress_adaptive is set (minimum: 1)",
+                                 MCA_BASE_VAR_TYPE_INT, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE,
+                                 OPAL_INFO_LVL_9, MCA_BASE_VAR_SCOPE_LOCAL,
+                                 &opal_progress_backoff_threshold);
+    if (0 > ret) {
+        return ret;
+    }
+
+    opal_progress_max_backoff = 64;
+    ret = mca_base_var_register ("opal", "opal", "progress", "max_backoff",
+                                 "Maximum polling interval, in calls to the progress engine, of an idle progress "
+                                 "callback when opal_progress_adaptive is set. This bounds the extra latency to "
+                                 "notice an event on an idle transport (minimum: 1)",
+                                 MCA_BASE_VAR_TYPE_INT, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE,
+                                 OPAL_INFO_LVL_9, MCA_BASE_VAR_SCOPE_LOCAL,
+                                 &opal_progress_max_backoff);
+    if (0 > ret) {
+        return ret;
+    }
+
+    opal_progress_wait_hybrid = false;
+    ret = mca_base_var_register ("opal", "opal", "progress", "wait_hybrid",
+                                 "Spin for a calibrated window in blocking waits and then sleep until a peer "
+                                 "or a file descriptor wakes the process up (default: false)",
+                                 MCA_BASE_VAR_TYPE_BOOL, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE,
+                                 OPAL_INFO_LVL_9, MCA_BASE_VAR_SCOPE_ALL_EQ,
+                                 &opal_progress_wait_hybrid);
+    if (0 > ret) {
+        return ret;
+    }
+
+    opal_progress_wait_spin_usec = 50;
+    ret = mca_base_var_register ("opal", "opal", "progress", "wait_spin_usec",
+                                 "Initial time, in microseconds, a blocking wait spins without progress before "
+                                 "going to sleep when opal_progress_wait_hybrid is set",
+                                 MCA_BASE_VAR_TYPE_INT, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE,
+                                 OPAL_INFO_LVL_9, MCA_BASE_VAR_SCOPE_LOCAL,
+                                 &opal_progress_wait_spin_usec);
+    if (0 > ret) {
+        return ret;
+    }
+
+    opal_progress_wait_spin_max_usec = 1000;
+    ret = mca_base_var_register ("opal", "opal", "progress", "wait_spin_max_usec",
+                                 "Maximum time, in microseconds, the calibrated spin window of a blocking wait "
+                                 "can grow to when opal_progress_wait_hybrid is set",
+                                 MCA_BASE_VAR_TYPE_INT, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE,
+                                 OPAL_INFO_LVL_9, MCA_BASE_VAR_SCOPE_LOCAL,
+                                 &opal_progress_wait_spin_max_usec);
+    if (0 > ret) {
+        return ret;
+    }
+
+    opal_progress_wait_block_usec = 1000;
+    ret = mca_base_var_register ("opal", "opal", "progress", "wait_block_usec",
+                                 "Maximum time, in microseconds, a sleeping wait blocks before polling again. "
+                                 "This bounds the latency of events that do not wake sleepers up",
+                                 MCA_BASE_VAR_TYPE_INT, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE,
+                                 OPAL_INFO_LVL_9, MCA_BASE_VAR_SCOPE_LOCAL,
+                                 &opal_progress_wait_block_usec);
+    if (0 > ret) {
+        return ret;
+    }
+
 #if OPAL_ENABLE_DEBUG
     opal_progress_debug = false;
     ret = mca_base_var_register ("opal", "opal", "progress", "debug",
@@ -25,9 +25,30 @@
 
 #include "opal_config.h"
 
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
 #ifdef HAVE_SCHED_H
 #include <sched.h>
 #endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#ifdef HAVE_POLL_H
+#include <poll.h>
+#endif
+#ifdef HAVE_SYS_EVENTFD_H
+#include <sys/eventfd.h>
+#endif
+#if defined(HAVE_LINUX_FUTEX_H) && defined(HAVE_SYS_SYSCALL_H)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#define OPAL_PROGRESS_HAVE_FUTEX 1
+#else
+#define OPAL_PROGRESS_HAVE_FUTEX 0
+#endif
 
 #include "opal/runtime/opal_progress.h"
 #include "opal/mca/event/event.h"
@@ -39,6 +60,7 @@
 
 #define OPAL_PROGRESS_USE_TIMERS (OPAL_TIMER_CYCLE_SUPPORTED || OPAL_TIMER_USEC_SUPPORTED)
 #define OPAL_PROGRESS_ONLY_USEC_NATIVE (OPAL_TIMER_USEC_NATIVE && !OPAL_TIMER_CYCLE_NATIVE)
+#define OPAL_PROGRESS_CAN_BLOCK (OPAL_PROGRESS_USE_TIMERS && OPAL_PROGRESS_HAVE_FUTEX)
 
 #if OPAL_ENABLE_DEBUG
 bool opal_progress_debug = false;
@@ -68,6 +90,60 @@ static size_t callbacks_lp_size = 0;
 /* do we want to call sched_yield() if nothing happened */
 bool opal_progress_yield_when_idle = false;
 
+/* adaptive polling of the callbacks */
+bool opal_progress_adaptive = false;
+int opal_progress_backoff_threshold = 32;
+int opal_progress_max_backoff = 64;
+
+/**
+ * Polling state of a callback in adaptive mode. A callback is polled on
+ * one out of interval opportunities. The interval is reset to 1 as soon
+ * as the callback progresses an event, and doubled (up to
+ * opal_progress_max_backoff) every opal_progress_backoff_threshold
+ * consecutive idle polls, so the latency to notice a new event on a
+ * cold callback stays bounded. The state is updated without atomics:
+ * a race only costs an extra or a missed poll.
+ */
+typedef struct opal_progress_heat_t {
+    uint32_t interval;
+    uint32_t countdown;
+    uint32_t idle;
+} opal_progress_heat_t;
+
+/* only the first callbacks of each array are tracked, the others are
+ * polled every time */
+#define OPAL_PROGRESS_MAX_TRACKED 64
+
+static opal_progress_heat_t callbacks_heat[OPAL_PROGRESS_MAX_TRACKED];
+static opal_progress_heat_t callbacks_lp_heat[OPAL_PROGRESS_MAX_TRACKED];
+
+/* hybrid spin-then-block waiting */
+bool opal_progress_wait_hybrid = false;
+int opal_progress_wait_spin_usec = 50;
+int opal_progress_wait_spin_max_usec = 1000;
+int opal_progress_wait_block_usec = 1000;
+
+static opal_progress_wait_ctl_t wait_ctl_private = { .seq = 0, .sleepers = 0 };
+opal_progress_wait_ctl_t *opal_progress_wait_ctl = &wait_ctl_private;
+
+#if OPAL_PROGRESS_CAN_BLOCK
+/* current spin window and its bounds, in timer ticks */
+static opal_timer_t wait_window = 0;
+static opal_timer_t wait_window_min = 0;
+static opal_timer_t wait_window_max = 0;
+
+/* file descriptors blocked waiters poll on. the first one is an eventfd
+ * used for wakeups from within this process */
+static opal_mutex_t wait_fds_lock = OPAL_MUTEX_STATIC_INIT;
+static struct pollfd *wait_fds = NULL;
+static int wait_fds_len = 0;
+static int wait_fds_size = 0;
+static int wait_event_fd = -1;
+#endif
+
+/* callback receiving the duration of each call to opal_progress() */
+static volatile opal_progress_timing_callback_t opal_progress_timing_cb = NULL;
+
 #if OPAL_PROGRESS_USE_TIMERS
 static opal_timer_t event_progress_last_time = 0;
 static opal_timer_t event_progress_delta = 0;
@@ -98,6 +174,58 @@ static int fake_cb(void) { return 0; }
 static int _opal_progress_unregister (opal_progress_callback_t cb, volatile opal_progress_callback_t *callback_array,
                                       size_t *callback_array_len);
 
+/* mark all callbacks as hot. called whenever the callbacks move around
+ * in their array */
+static void opal_progress_heat_reset (opal_progress_heat_t *heat)
+{
+    for (size_t i = 0 ; i < OPAL_PROGRESS_MAX_TRACKED ; ++i) {
+        heat[i].interval = 1;
+        heat[i].countdown = 0;
+        heat[i].idle = 0;
+    }
+}
+
+static inline int opal_progress_callbacks_adaptive (volatile opal_progress_callback_t *cbs, size_t cbs_len,
+                                                    opal_progress_heat_t *heat)
+{
+    int events = 0, ret;
+    size_t i;
+    /* both are settable through MPI_T at any time: an interval of 0 would
+     * never poll the callback again, a negative threshold never back off */
+    uint32_t threshold = (opal_progress_backoff_threshold > 1) ?
+        (uint32_t) opal_progress_backoff_threshold : 1;
+    uint32_t max_backoff = (opal_progress_max_backoff > 1) ?
+        (uint32_t) opal_progress_max_backoff : 1;
+
+    for (i = 0 ; i < cbs_len && i < OPAL_PROGRESS_MAX_TRACKED ; ++i) {
+        if (heat[i].countdown > 0) {
+            --heat[i].countdown;
+            continue;
+        }
+
+        ret = (cbs[i])();
+        if (ret > 0) {
+            events += ret;
+            heat[i].interval = 1;
+            heat[i].idle = 0;
+        } else if (++heat[i].idle >= threshold) {
+            heat[i].idle = 0;
+            heat[i].interval = (heat[i].interval > max_backoff / 2) ? max_backoff : 2 * heat[i].interval;
+        }
+        if (heat[i].interval > max_backoff) {
+            /* the maximum was lowered since the interval grew */
+            heat[i].interval = max_backoff;
+        }
+        heat[i].countdown = heat[i].interval - 1;
+    }
+
+    for ( ; i < cbs_len ; ++i) {
+        events += (cbs[i])();
+    }
+
+    return events;
+}
+
 static void opal_progress_finalize (void)
 {
     /* free memory associated with the callbacks */
@@ -114,6 +242,17 @@ static void opal_progress_finalize (void)
     callbacks_lp = NULL;
 
     opal_atomic_unlock(&progress_lock);
+
+#if OPAL_PROGRESS_CAN_BLOCK
+    free (wait_fds);
+    wait_fds = NULL;
+    wait_fds_len = wait_fds_size = 0;
+    if (0 <= wait_event_fd) {
+        close (wait_event_fd);
+        wait_event_fd = -1;
+    }
+#endif
+    opal_progress_wait_ctl = &wait_ctl_private;
 }
 
 
@@ -154,6 +293,28 @@ opal_progress_init(void)
         callbacks_lp[i] = fake_cb;
     }
 
+    opal_progress_heat_reset (callbacks_heat);
+    opal_progress_heat_reset (callbacks_lp_heat);
+
+#if OPAL_PROGRESS_CAN_BLOCK
+#if OPAL_PROGRESS_ONLY_USEC_NATIVE
+    wait_window = (opal_timer_t) opal_progress_wait_spin_usec;
+    wait_window_max = (opal_timer_t) opal_progress_wait_spin_max_usec;
+#else
+    wait_window = (opal_timer_t) opal_progress_wait_spin_usec * opal_timer_base_get_freq () / 1000000;
+    wait_window_max = (opal_timer_t) opal_progress_wait_spin_max_usec * opal_timer_base_get_freq () / 1000000;
+#endif
+    wait_window_min = wait_window / 8;
+    if (wait_window_max < wait_window) {
+        wait_window_max = wait_window;
+    }
+#else
+    if (opal_progress_wait_hybrid) {
+        OPAL_OUTPUT((debug_output, "progress: blocking waits are not supported on this platform"));
+        opal_progress_wait_hybrid = false;
+    }
+#endif
+
     OPAL_OUTPUT((debug_output, "progress: initialized event flag to: %x",
                  opal_progress_event_flag));
     OPAL_OUTPUT((debug_output, "progress: initialized yield_when_idle to: %s",
@@ -218,16 +379,26 @@ static int opal_progress_events(void)
  * care, as the cost of that happening is far outweighed by the cost
  * of the if checks (they were resulting in bad pipe stalling behavior)
  */
-void
-opal_progress(void)
+static inline int
+opal_progress_internal(void)
 {
     static uint32_t num_calls = 0;
+    opal_progress_timing_callback_t timing_cb = opal_progress_timing_cb;
+    opal_timer_t start = 0;
     size_t i;
     int events = 0;
 
+    if (OPAL_UNLIKELY(NULL != timing_cb)) {
+        start = opal_timer_base_get_cycles();
+    }
+
     /* progress all registered callbacks */
-    for (i = 0 ; i < callbacks_len ; ++i) {
-        events += (callbacks[i])();
+    if (opal_progress_adaptive) {
+        events += opal_progress_callbacks_adaptive (callbacks, callbacks_len, callbacks_heat);
+    } else {
+        for (i = 0 ; i < callbacks_len ; ++i) {
+            events += (callbacks[i])();
+        }
     }
 
     /* Run low priority callbacks and events once every 8 calls to opal_progress().
@@ -237,8 +408,12 @@ opal_progress(void)
      * it's not a problem.
      */
     if (((num_calls++) & 0x7) == 0) {
-        for (i = 0 ; i < callbacks_lp_len ; ++i) {
-            events += (callbacks_lp[i])();
+        if (opal_progress_adaptive) {
+            events += opal_progress_callbacks_adaptive (callbacks_lp, callbacks_lp_len, callbacks_lp_heat);
+        } else {
+            for (i = 0 ; i < callbacks_lp_len ; ++i) {
+                events += (callbacks_lp[i])();
+            }
         }
 
         opal_progress_events();
@@ -246,6 +421,10 @@ opal_progress(void)
         opal_progress_events();
     }
 
+    if (OPAL_UNLIKELY(NULL != timing_cb)) {
+        timing_cb((uint64_t) (opal_timer_base_get_cycles() - start));
+    }
+
 #if OPAL_HAVE_SCHED_YIELD
     if (opal_progress_yield_when_idle && events <= 0) {
         /* If there is nothing to do - yield the processor - otherwise
@@ -256,6 +435,244 @@ opal_progress(void)
         sched_yield();
     }
 #endif  /* defined(HAVE_SCHED_YIELD) */
+
+    return events;
+}
+
+void
+opal_progress(void)
+{
+    (void) opal_progress_internal ();
+}
+
+int
+opal_progress_count(void)
+{
+    return opal_progress_internal ();
+}
+
+
+#if OPAL_PROGRESS_CAN_BLOCK
+static inline opal_timer_t opal_progress_wait_now (void)
+{
+#if OPAL_PROGRESS_ONLY_USEC_NATIVE
+    return opal_timer_base_get_usec ();
+#else
+    return opal_timer_base_get_cycles ();
+#endif
+}
+
+/* sleep until seq changes, a registered file descriptor is readable or
+ * the block time elapsed */
+static void opal_progress_wait_block (opal_progress_wait_ctl_t *ctl, int32_t seq)
+{
+    int timeout = opal_progress_wait_block_usec;
+
+    if (wait_fds_len > 0) {
+        struct pollfd local_fds[16], *fds = local_fds;
+        int nfds = 0;
+
+        /* poll on a copy so that (un)registering does not wait for the
+         * sleepers. a change of the set wakes them up through the eventfd
+         * and they pick up the new set on their next sleep */
+        OPAL_THREAD_LOCK(&wait_fds_lock);
+        if (ctl->seq == seq && wait_fds_len > 0) {
+            if (wait_fds_len > (int) (sizeof (local_fds) / sizeof (local_fds[0]))) {
+                fds = malloc (wait_fds_len * sizeof (fds[0]));
+            }
+            if (NULL != fds) {
+                nfds = wait_fds_len;
+                memcpy (fds, wait_fds, nfds * sizeof (fds[0]));
+            }
+        }
+        OPAL_THREAD_UNLOCK(&wait_fds_lock);
+
+        if (nfds > 0) {
+            (void) poll (fds, nfds, (timeout + 999) / 1000);
+            if (fds[0].revents & POLLIN) {
+                uint64_t value;
+                /* consume the in-process wakeups */
+                (void) read (fds[0].fd, &value, sizeof (value));
+            }
+        }
+        if (fds != local_fds) {
+            free (fds);
+        }
+        return;
+    }
+
+    struct timespec ts = {.tv_sec = timeout / 1000000, .tv_nsec = (timeout % 1000000) * 1000};
+    /* shared (not private) futex: the word may be in a segment shared with peers */
+    (void) syscall (SYS_futex, (int32_t *) &ctl->seq, FUTEX_WAIT, seq, &ts, NULL, 0);
+}
+#endif  /* OPAL_PROGRESS_CAN_BLOCK */
+
+void
+opal_progress_wait_until(opal_progress_wait_cond_fn_t cond, void *arg)
+{
+#if OPAL_PROGRESS_CAN_BLOCK
+    opal_progress_wait_ctl_t *ctl = opal_progress_wait_ctl;
+    opal_timer_t start, spin_start, elapsed;
+    bool slept = false;
+    int32_t seq;
+
+    start = spin_start = opal_progress_wait_now ();
+
+    while (!cond (arg)) {
+        if (opal_progress_internal () > 0) {
+            /* things are moving, restart the spin window */
+            spin_start = opal_progress_wait_now ();
+            continue;
+        }
+
+        if (opal_progress_wait_now () - spin_start < wait_window) {
+            continue;
+        }
+
+        /* announce that we are about to sleep then progress one last time.
+         * anything delivered before the announcement is seen by this pass
+         * and whoever delivers after it sees the sleeper and wakes us up. */
+        (void) opal_atomic_add_fetch_32 (&ctl->sleepers, 1);
+        seq = ctl->seq;
+        if (opal_progress_internal () <= 0 && !cond (arg)) {
+            opal_progress_wait_block (ctl, seq);
+            slept = true;
+        }
+        (void) opal_atomic_add_fetch_32 (&ctl->sleepers, -1);
+        spin_start = opal_progress_wait_now ();
+    }
+
+    if (slept) {
+        /* calibrate the spin window: if the wait ended shortly after we went
+         * to sleep we should have kept spinning, if it lasted much longer than
+         * the window we spun for nothing */
+        elapsed = opal_progress_wait_now () - start;
+        if (elapsed < 2 * wait_window) {
+            wait_window = (2 * wait_window < wait_window_max) ? 2 * wait_window : wait_window_max;
+        } else if (elapsed > 16 * wait_window) {
+            wait_window = (wait_window / 2 > wait_window_min) ? wait_window / 2 : wait_window_min;
+        }
+    }
+#else
+    while (!cond (arg)) {
+        opal_progress ();
+    }
+#endif  /* OPAL_PROGRESS_CAN_BLOCK */
+}
+
+
+void
+opal_progress_wakeup_sleepers(opal_progress_wait_ctl_t *ctl)
+{
+#if OPAL_PROGRESS_CAN_BLOCK
+    (void) opal_atomic_add_fetch_32 (&ctl->seq, 1);
+    (void) syscall (SYS_futex, (int32_t *) &ctl->seq, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+
+    if (ctl == opal_progress_wait_ctl && 0 <= wait_event_fd) {
+        uint64_t one = 1;
+        (void) write (wait_event_fd, &one, sizeof (one));
+    }
+#endif
+}
+
+
+void
+opal_progress_wait_set_ctl(opal_progress_wait_ctl_t *ctl)
+{
+    opal_progress_wait_ctl = (NULL != ctl) ? ctl : &wait_ctl_private;
+}
+
+
+#if OPAL_PROGRESS_CAN_BLOCK && defined(HAVE_SYS_EVENTFD_H)
+/* called with wait_fds_lock held */
+static void opal_progress_wait_fds_changed (void)
+{
+    uint64_t one = 1;
+
+    if (0 <= wait_event_fd) {
+        (void) write (wait_event_fd, &one, sizeof (one));
+    }
+}
+#endif
+
+int
+opal_progress_wait_register_fd(int fd)
+{
+#if OPAL_PROGRESS_CAN_BLOCK && defined(HAVE_SYS_EVENTFD_H)
+    int ret = OPAL_SUCCESS;
+
+    OPAL_THREAD_LOCK(&wait_fds_lock);
+    do {
+        if (0 > wait_event_fd) {
+            wait_event_fd = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (0 > wait_event_fd) {
+                ret = OPAL_ERR_OUT_OF_RESOURCE;
+                break;
+            }
+        }
+
+        if (wait_fds_len + 2 > wait_fds_size) {
+            int new_size = (0 == wait_fds_size) ? 16 : 2 * wait_fds_size;
+            struct pollfd *tmp = realloc (wait_fds, new_size * sizeof (wait_fds[0]));
+            if (NULL == tmp) {
+                ret = OPAL_ERR_OUT_OF_RESOURCE;
+                break;
+            }
+            wait_fds = tmp;
+            wait_fds_size = new_size;
+        }
+
+        if (0 == wait_fds_len) {
+            wait_fds[0].fd = wait_event_fd;
+            wait_fds[0].events = POLLIN;
+            wait_fds_len = 1;
+        }
+
+        wait_fds[wait_fds_len].fd = fd;
+        wait_fds[wait_fds_len].events = POLLIN;
+        wait_fds[wait_fds_len].revents = 0;
+        ++wait_fds_len;
+
+        /* sleepers poll on the old set */
+        opal_progress_wait_fds_changed ();
+    } while (0);
+    OPAL_THREAD_UNLOCK(&wait_fds_lock);
+
+    return ret;
+#else
+    return OPAL_ERR_NOT_SUPPORTED;
+#endif
+}
+
+
+int
+opal_progress_wait_unregister_fd(int fd)
+{
+#if OPAL_PROGRESS_CAN_BLOCK && defined(HAVE_SYS_EVENTFD_H)
+    int ret = OPAL_ERR_NOT_FOUND;
+
+    OPAL_THREAD_LOCK(&wait_fds_lock);
+    for (int i = 1 ; i < wait_fds_len ; ++i) {
+        if (wait_fds[i].fd == fd) {
+            wait_fds[i] = wait_fds[--wait_fds_len];
+            ret = OPAL_SUCCESS;
+            break;
+        }
+    }
+    if (1 == wait_fds_len) {
+        /* only the eventfd is left, go back to sleeping on the futex */
+        wait_fds_len = 0;
+    }
+    if (OPAL_SUCCESS == ret) {
+        /* sleepers may still poll on fd */
+        opal_progress_wait_fds_changed ();
+    }
+    OPAL_THREAD_UNLOCK(&wait_fds_lock);
+
+    return ret;
+#else
+    return OPAL_ERR_NOT_SUPPORTED;
+#endif
 }
 
 
@@ -327,6 +744,18 @@ opal_progress_set_yield_when_idle(bool yieldopt)
 }
 
 
+opal_progress_timing_callback_t
+opal_progress_set_timing_callback(opal_progress_timing_callback_t cb)
+{
+    opal_progress_timing_callback_t tmp = opal_progress_timing_cb;
+    opal_progress_timing_cb = cb;
+
+    OPAL_OUTPUT((debug_output, "progress: set_timing_callback to %p", (void *) cb));
+
+    return tmp;
+}
+
+
 void
 opal_progress_set_event_poll_rate(int polltime)
 {
@@ -435,6 +864,9 @@ int opal_progress_register (opal_progress_callback_t cb)
 
     ret = _opal_progress_register (cb, &callbacks, &callbacks_size, &callbacks_len);
 
+    opal_progress_heat_reset (callbacks_heat);
+    opal_progress_heat_reset (callbacks_lp_heat);
+
     opal_atomic_unlock(&progress_lock);
 
     return ret;
@@ -450,6 +882,9 @@ int opal_progress_register_lp (opal_progress_callback_t cb)
 
     ret = _opal_progress_register (cb, &callbacks_lp, &callbacks_lp_size, &callbacks_lp_len);
 
+    opal_progress_heat_reset (callbacks_heat);
+    opal_progress_heat_reset (callbacks_lp_heat);
+
     opal_atomic_unlock(&progress_lock);
 
     return ret;
@@ -493,6 +928,9 @@ int opal_progress_unregister (opal_progress_callback_t cb)
         ret = _opal_progress_unregister (cb, callbacks_lp, &callbacks_lp_len);
     }
 
+    opal_progress_heat_reset (callbacks_heat);
+    opal_progress_heat_reset (callbacks_lp_heat);
+
     opal_atomic_unlock(&progress_lock);
 
     return ret;
@@ -59,6 +59,15 @@ OPAL_DECLSPEC int opal_progress_init(void);
  */
 OPAL_DECLSPEC void opal_progress(void);
 
+/**
+ * Progress all pending events once
+ *
+ * Same as opal_progress() but returns the number of events reported by
+ * the registered callbacks, so a caller polling in a loop can tell an
+ * idle pass from a useful one.
+ */
+OPAL_DECLSPEC int opal_progress_count(void);
+
 
 /**
  * Control how the event library is called
@@ -167,11 +176,135 @@ OPAL_DECLSPEC int opal_progress_register_lp (opal_progress_callback_t cb);
 OPAL_DECLSPEC int opal_progress_unregister(opal_progress_callback_t cb);
 
 
+/**
+ * Progress timing callback function typedef
+ *
+ * Prototype for a function that is handed the duration, in cycles of
+ * the opal timer, of every call to opal_progress().
+ */
+typedef void (*opal_progress_timing_callback_t)(uint64_t cycles);
+
+
+/**
+ * Set the progress timing callback
+ *
+ * Install a callback that receives the duration of every call to
+ * opal_progress() (excluding any yield when idle).  Only one callback
+ * can be installed at a time; passing NULL disables the timing, which
+ * is the default.
+ *
+ * @param   cb     Timing callback or NULL
+ * @return         Previously installed callback
+ */
+OPAL_DECLSPEC opal_progress_timing_callback_t
+opal_progress_set_timing_callback(opal_progress_timing_callback_t cb);
+
+
+/**
+ * Wait control block of the hybrid spin-then-block wait mode
+ *
+ * A process sleeping in opal_progress_wait_until() announces itself in
+ * the current wait control block (opal_progress_wait_ctl) and sleeps
+ * on its seq word.  The block can live in memory shared with other
+ * processes (see opal_progress_wait_set_ctl()) so that they can wake
+ * the process up with opal_progress_wakeup() after delivering data to
+ * it.
+ */
+typedef struct opal_progress_wait_ctl_t {
+    /** futex word, incremented by every wakeup */
+    opal_atomic_int32_t seq;
+    /** number of threads sleeping on seq */
+    opal_atomic_int32_t sleepers;
+} opal_progress_wait_ctl_t;
+
+/* do we want to block instead of spinning in long waits */
+OPAL_DECLSPEC extern bool opal_progress_wait_hybrid;
+
+/* initial spin window before blocking, in microseconds */
+OPAL_DECLSPEC extern int opal_progress_wait_spin_usec;
+
+/* maximum spin window before blocking, in microseconds */
+OPAL_DECLSPEC extern int opal_progress_wait_spin_max_usec;
+
+/* maximum time to block before polling again, in microseconds */
+OPAL_DECLSPEC extern int opal_progress_wait_block_usec;
+
+/* wait control block sleepers of this process announce themselves in */
+OPAL_DECLSPEC extern opal_progress_wait_ctl_t *opal_progress_wait_ctl;
+
+/**
+ * Wait condition function typedef
+ *
+ * @return         true once the wait is complete
+ */
+typedef bool (*opal_progress_wait_cond_fn_t)(void *arg);
+
+/**
+ * Progress until a condition is true, spinning then blocking
+ *
+ * Spin on opal_progress() for a calibrated window. If nothing was
+ * progressed during the window, block until another thread or process
+ * calls opal_progress_wakeup() on this process' wait control block,
+ * one of the registered file descriptors becomes readable or
+ * opal_progress_wait_block_usec elapsed. The spin window adapts to the
+ * observed waits between opal_progress_wait_spin_usec / 8 and
+ * opal_progress_wait_spin_max_usec.
+ */
+OPAL_DECLSPEC void opal_progress_wait_until(opal_progress_wait_cond_fn_t cond, void *arg);
+
+/**
+ * Set the wait control block of this process
+ *
+ * @param   ctl    Initialized wait control block or NULL to go back to the
+ *                 process-private one
+ */
+OPAL_DECLSPEC void opal_progress_wait_set_ctl(opal_progress_wait_ctl_t *ctl);
+
+/**
+ * Register a file descriptor whose readability wakes blocked waiters
+ *
+ * While file descriptors are registered, blocked waiters sleep in
+ * poll() instead of on the wait control block, so wakeups from other
+ * processes are only noticed after opal_progress_wait_block_usec.
+ */
+OPAL_DECLSPEC int opal_progress_wait_register_fd(int fd);
+
+OPAL_DECLSPEC int opal_progress_wait_unregister_fd(int fd);
+
+OPAL_DECLSPEC void opal_progress_wakeup_sleepers(opal_progress_wait_ctl_t *ctl);
+
+/**
+ * Wake up the threads blocked on a wait control block
+ *
+ * Must be called after the data or completion the sleepers wait for
+ * has been made visible.
+ */
+static inline void opal_progress_wakeup(opal_progress_wait_ctl_t *ctl)
+{
+    opal_atomic_mb ();
+    if (OPAL_UNLIKELY(ctl->sleepers > 0)) {
+        opal_progress_wakeup_sleepers (ctl);
+    }
+}
+
+
 OPAL_DECLSPEC extern int opal_progress_spin_count;
 
 /* do we want to call sched_yield() if nothing happened */
 OPAL_DECLSPEC extern bool opal_progress_yield_when_idle;
 
+/* do we want to back off polling of callbacks that did not progress
+ * anything recently */
+OPAL_DECLSPEC extern bool opal_progress_adaptive;
+
+/* number of consecutive idle polls after which the polling interval of a
+ * callback is doubled */
+OPAL_DECLSPEC extern int opal_progress_backoff_threshold;
+
+/* maximum polling interval of a callback, in calls to opal_progress() for
+ * high priority callbacks and in low priority rounds for the others */
+OPAL_DECLSPEC extern int opal_progress_max_backoff;
+
 /**
  * Progress until flag is true or poll iterations completed
  */
@@ -84,8 +84,12 @@ int ompi_sync_wait_mt(ompi_wait_sync_t *sync)
     pthread_mutex_unlock(&sync->lock);
 
     OPAL_THREAD_ADD_FETCH32(&num_thread_in_progress, 1);
-    while(sync->count > 0) {  /* progress till completion */
-        opal_progress();  /* don't progress with the sync lock locked or you'll deadlock */
+    if (opal_progress_wait_hybrid) {
+        opal_progress_wait_until (wait_sync_complete, sync);
+    } else {
+        while(sync->count > 0) {  /* progress till completion */
+            opal_progress();  /* don't progress with the sync lock locked or you'll deadlock */
+        }
     }
     OPAL_THREAD_ADD_FETCH32(&num_thread_in_progress, -1);
 
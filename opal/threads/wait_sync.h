@@ -78,9 +78,19 @@ typedef struct ompi_wait_sync_t {
         (sync)->signaling = false;                    \
 }
 
+static inline bool wait_sync_complete (void *sync)
+{
+    return ((ompi_wait_sync_t *) sync)->count <= 0;
+}
+
 OPAL_DECLSPEC int ompi_sync_wait_mt(ompi_wait_sync_t *sync);
 static inline int sync_wait_st (ompi_wait_sync_t *sync)
 {
+    if (opal_progress_wait_hybrid) {
+        opal_progress_wait_until (wait_sync_complete, sync);
+        return sync->status;
+    }
+
     while (sync->count > 0) {
         opal_progress();
     }
@@ -120,6 +130,10 @@ static inline void wait_sync_update(ompi_wait_sync_t *sync, int updates, int sta
         opal_atomic_wmb ();
         opal_atomic_swap_32 (&sync->count, 0);
     }
+    if (opal_progress_wait_hybrid) {
+        /* the waiter may be sleeping in opal_progress_wait_until() */
+        opal_progress_wakeup (opal_progress_wait_ctl);
+    }
     WAIT_SYNC_SIGNAL(sync);
 }
 
@@ -0,0 +1,82 @@
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#ifndef MCA_ATOMIC_SM_H
+#define MCA_ATOMIC_SM_H
+
+#include "oshmem_config.h"
+
+#include "opal/sys/atomic.h"
+#include "oshmem/mca/mca.h"
+#include "oshmem/mca/atomic/atomic.h"
+#include "oshmem/mca/memheap/memheap.h"
+#include "oshmem/mca/memheap/base/base.h"
+#include "oshmem/proc/proc.h"
+#include "oshmem/util/oshmem_util.h"
+
+BEGIN_C_DECLS
+
+/* Globally exported variables */
+
+OSHMEM_MODULE_DECLSPEC extern mca_atomic_base_component_1_0_0_t
+mca_atomic_sm_component;
+
+/* best of the other atomic modules, used when the target is not
+ * mapped into this process
+ */
+extern mca_atomic_base_module_t *mca_atomic_sm_fallback;
+
+/* API functions */
+
+int mca_atomic_sm_startup(bool enable_progress_threads, bool enable_threads);
+int mca_atomic_sm_finalize(void);
+mca_atomic_base_module_t*
+mca_atomic_sm_query(int *priority);
+
+int mca_atomic_sm_cswap(shmem_ctx_t ctx,
+                        void *target,
+                        uint64_t *prev,
+                        uint64_t cond,
+                        uint64_t value,
+                        size_t size,
+                        int pe);
+
+struct mca_atomic_sm_module_t {
+    mca_atomic_base_module_t super;
+};
+typedef struct mca_atomic_sm_module_t mca_atomic_sm_module_t;
+OBJ_CLASS_DECLARATION(mca_atomic_sm_module_t);
+
+/**
+ * Return the address of target on pe in this process, or NULL when
+ * the segment holding target is not attached. The decision depends on
+ * the segment only, so every PE uses the same path for a given
+ * location and CPU atomics never race with the fallback protocol.
+ */
+static inline void *mca_atomic_sm_ptr(shmem_ctx_t ctx, void *target, int pe)
+{
+    sshmem_mkey_t *mkey;
+    void *rva;
+
+    if (pe == oshmem_my_proc_id()) {
+        mkey = mca_memheap_base_get_mkey(target, 0);
+        rva  = target;
+    } else {
+        mkey = mca_memheap_base_get_cached_mkey(ctx, pe, target, 0, &rva);
+    }
+
+    if (OPAL_UNLIKELY(NULL == mkey || !mca_memheap_base_mkey_is_shm(mkey))) {
+        return NULL;
+    }
+
+    return rva;
+}
+
+END_C_DECLS
+
+#endif /* MCA_ATOMIC_SM_H */
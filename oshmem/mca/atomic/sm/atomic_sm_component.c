@@ -0,0 +1,102 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "oshmem_config.h"
+#include <string.h>
+
+#include "oshmem/constants.h"
+#include "oshmem/mca/atomic/atomic.h"
+#include "oshmem/mca/atomic/base/base.h"
+#include "oshmem/mca/spml/base/base.h"
+#include "atomic_sm.h"
+
+/*
+ * Public string showing the atomic sm component version number
+ */
+const char *mca_atomic_sm_component_version_string =
+"Open SHMEM sm atomic MCA component version " OSHMEM_VERSION;
+
+/*
+ * Global variable
+ */
+mca_atomic_base_module_t *mca_atomic_sm_fallback = NULL;
+
+/*
+ * Local function
+ */
+static int _sm_register(void);
+static int _sm_open(void);
+
+/*
+ * Instantiate the public struct with all of our public information
+ * and pointers to our public functions in it
+ */
+
+mca_atomic_base_component_t mca_atomic_sm_component = {
+
+    /* First, the mca_component_t struct containing meta information
+       about the component itself */
+
+    .atomic_version = {
+        MCA_ATOMIC_BASE_VERSION_2_0_0,
+
+        /* Component name and version */
+        .mca_component_name = "sm",
+        MCA_BASE_MAKE_VERSION(component, OSHMEM_MAJOR_VERSION, OSHMEM_MINOR_VERSION,
+                              OSHMEM_RELEASE_VERSION),
+
+        .mca_open_component = _sm_open,
+        .mca_register_component_params = _sm_register,
+    },
+    .atomic_data = {
+        /* The component is checkpoint ready */
+        MCA_BASE_METADATA_PARAM_CHECKPOINT
+    },
+
+    /* Initialization / querying functions */
+
+    .atomic_startup = mca_atomic_sm_startup,
+    .atomic_finalize = mca_atomic_sm_finalize,
+    .atomic_query = mca_atomic_sm_query,
+};
+
+static int _sm_register(void)
+{
+    mca_atomic_sm_component.priority = 100;
+    mca_base_component_var_register (&mca_atomic_sm_component.atomic_version,
+                                     "priority", "Priority of the atomic:sm "
+                                     "component (default: 100)", MCA_BASE_VAR_TYPE_INT,
+                                     NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE,
+                                     OPAL_INFO_LVL_3,
+                                     MCA_BASE_VAR_SCOPE_ALL_EQ,
+                                     &mca_atomic_sm_component.priority);
+
+    return OSHMEM_SUCCESS;
+}
+
+static int _sm_open(void)
+{
+    /*
+     * Peers segments are attached by memheap for spml:sm only; with a
+     * network spml on-node CPU atomics would not be atomic with respect
+     * to the ones issued by the NIC for off-node PEs
+     */
+    if (strcmp(mca_spml_base_selected_component.spmlm_version.mca_component_name, "sm")) {
+        ATOMIC_VERBOSE(5,
+                       "Can not use atomic/sm because spml sm component disabled");
+        return OSHMEM_ERR_NOT_AVAILABLE;
+    }
+
+    return OSHMEM_SUCCESS;
+}
+
+OBJ_CLASS_INSTANCE(mca_atomic_sm_module_t,
+                   mca_atomic_base_module_t,
+                   NULL,
+                   NULL);
@@ -0,0 +1,60 @@
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "oshmem_config.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "oshmem/constants.h"
+#include "oshmem/mca/atomic/atomic.h"
+#include "oshmem/mca/atomic/base/base.h"
+#include "atomic_sm.h"
+
+int mca_atomic_sm_cswap(shmem_ctx_t ctx,
+                        void *target,
+                        uint64_t *prev,
+                        uint64_t cond,
+                        uint64_t value,
+                        size_t size,
+                        int pe)
+{
+    void *ptr;
+
+    if ((8 != size) && (4 != size)) {
+        ATOMIC_ERROR("[#%d] Type size must be 4 or 8 bytes.", oshmem_my_proc_id());
+        return OSHMEM_ERROR;
+    }
+
+    assert(NULL != prev);
+
+    ptr = mca_atomic_sm_ptr(ctx, target, pe);
+    if (OPAL_UNLIKELY(NULL == ptr)) {
+        return mca_atomic_sm_fallback->atomic_cswap(ctx, target, prev, cond,
+                                                   value, size, pe);
+    }
+
+    /* on failure the compare-exchange stores the current value in the
+     * expected operand, on success it already equals it: either way it
+     * is the value to return
+     */
+    if (sizeof(uint64_t) == size) {
+        int64_t expected = (int64_t)cond;
+
+        (void)opal_atomic_compare_exchange_strong_64((opal_atomic_int64_t *)ptr,
+                                                     &expected, (int64_t)value);
+        *(int64_t *)prev = expected;
+    } else {
+        int32_t expected = (int32_t)cond;
+
+        (void)opal_atomic_compare_exchange_strong_32((opal_atomic_int32_t *)ptr,
+                                                     &expected, (int32_t)value);
+        *(int32_t *)prev = expected;
+    }
+
+    return OSHMEM_SUCCESS;
+}
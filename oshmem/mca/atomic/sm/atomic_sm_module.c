@@ -0,0 +1,182 @@
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "oshmem_config.h"
+#include <stdio.h>
+
+#include "oshmem/constants.h"
+#include "oshmem/mca/atomic/atomic.h"
+#include "oshmem/mca/atomic/base/base.h"
+#include "oshmem/proc/proc.h"
+#include "atomic_sm.h"
+
+/*
+ * Initial query function that is invoked during initialization, allowing
+ * this module to indicate what level of thread support it provides.
+ */
+int mca_atomic_sm_startup(bool enable_progress_threads, bool enable_threads)
+{
+    return OSHMEM_SUCCESS;
+}
+
+int mca_atomic_sm_finalize(void)
+{
+    if (mca_atomic_sm_fallback) {
+        OBJ_RELEASE(mca_atomic_sm_fallback);
+        mca_atomic_sm_fallback = NULL;
+    }
+
+    return OSHMEM_SUCCESS;
+}
+
+/*
+ * Each operation is a single CPU atomic on the attached segment. A
+ * target that is not attached (static data, non shareable heap) goes
+ * to the fallback module.
+ */
+#define MCA_ATOMIC_SM_FOP(name, op)                                           \
+static int mca_atomic_sm_f##name(shmem_ctx_t ctx, void *target, void *prev,   \
+                                 uint64_t value, size_t size, int pe)         \
+{                                                                             \
+    void *ptr = mca_atomic_sm_ptr(ctx, target, pe);                           \
+                                                                              \
+    if (OPAL_UNLIKELY(NULL == ptr)) {                                         \
+        return mca_atomic_sm_fallback->atomic_f##name(ctx, target, prev,      \
+                                                      value, size, pe);       \
+    }                                                                         \
+                                                                              \
+    assert((8 == size) || (4 == size));                                       \
+                                                                              \
+    if (sizeof(uint64_t) == size) {                                           \
+        *(int64_t *)prev = opal_atomic_##op##_64((opal_atomic_int64_t *)ptr,  \
+                                                 (int64_t)value);             \
+    } else {                                                                  \
+        *(int32_t *)prev = opal_atomic_##op##_32((opal_atomic_int32_t *)ptr,  \
+                                                 (int32_t)value);             \
+    }                                                                         \
+                                                                              \
+    return OSHMEM_SUCCESS;                                                    \
+}                                                                             \
+                                                                              \
+static int mca_atomic_sm_##name(shmem_ctx_t ctx, void *target,                \
+                                uint64_t value, size_t size, int pe)          \
+{                                                                             \
+    void *ptr = mca_atomic_sm_ptr(ctx, target, pe);                           \
+                                                                              \
+    if (OPAL_UNLIKELY(NULL == ptr)) {                                         \
+        return mca_atomic_sm_fallback->atomic_##name(ctx, target,             \
+                                                     value, size, pe);        \
+    }                                                                         \
+                                                                              \
+    assert((8 == size) || (4 == size));                                       \
+                                                                              \
+    if (sizeof(uint64_t) == size) {                                           \
+        (void)opal_atomic_##op##_64((opal_atomic_int64_t *)ptr,               \
+                                    (int64_t)value);                          \
+    } else {                                                                  \
+        (void)opal_atomic_##op##_32((opal_atomic_int32_t *)ptr,               \
+                                    (int32_t)value);                          \
+    }                                                                         \
+                                                                              \
+    return OSHMEM_SUCCESS;                                                    \
+}
+
+MCA_ATOMIC_SM_FOP(add, fetch_add)
+MCA_ATOMIC_SM_FOP(and, fetch_and)
+MCA_ATOMIC_SM_FOP(or,  fetch_or)
+MCA_ATOMIC_SM_FOP(xor, fetch_xor)
+
+static int mca_atomic_sm_swap(shmem_ctx_t ctx, void *target, void *prev, uint64_t value,
+                              size_t size, int pe)
+{
+    void *ptr = mca_atomic_sm_ptr(ctx, target, pe);
+
+    if (OPAL_UNLIKELY(NULL == ptr)) {
+        return mca_atomic_sm_fallback->atomic_swap(ctx, target, prev, value, size, pe);
+    }
+
+    assert((8 == size) || (4 == size));
+
+    if (sizeof(uint64_t) == size) {
+        *(int64_t *)prev = opal_atomic_swap_64((opal_atomic_int64_t *)ptr, (int64_t)value);
+    } else {
+        *(int32_t *)prev = opal_atomic_swap_32((opal_atomic_int32_t *)ptr, (int32_t)value);
+    }
+
+    return OSHMEM_SUCCESS;
+}
+
+mca_atomic_base_module_t *
+mca_atomic_sm_query(int *priority)
+{
+    mca_atomic_sm_module_t *module;
+    mca_base_component_list_item_t *cli;
+    mca_atomic_base_component_t *component;
+    mca_atomic_base_module_t *candidate;
+    int best_priority = -1, candidate_priority;
+
+    /* a heap that peers could not attach leaves no location to serve
+     * with a load/store, see mca_atomic_sm_ptr()
+     */
+    if (MAP_SEGMENT_SHM_INVALID == memheap_find_seg(HEAP_SEG_INDEX)->seg_id) {
+        ATOMIC_VERBOSE(5, "atomic/sm disabled: symmetric heap is not shared memory");
+        return NULL;
+    }
+
+    /* pick the module the framework would select without us: it
+     * serves the locations we can not reach with a load/store
+     */
+    if (NULL == mca_atomic_sm_fallback) {
+        OPAL_LIST_FOREACH(cli, &oshmem_atomic_base_framework.framework_components,
+                          mca_base_component_list_item_t) {
+            component = (mca_atomic_base_component_t *) cli->cli_component;
+            if (component == &mca_atomic_sm_component) {
+                continue;
+            }
+
+            candidate = component->atomic_query(&candidate_priority);
+            if (NULL == candidate) {
+                continue;
+            }
+
+            if (candidate_priority > best_priority) {
+                if (mca_atomic_sm_fallback) {
+                    OBJ_RELEASE(mca_atomic_sm_fallback);
+                }
+                mca_atomic_sm_fallback = candidate;
+                best_priority = candidate_priority;
+            } else {
+                OBJ_RELEASE(candidate);
+            }
+        }
+
+        if (NULL == mca_atomic_sm_fallback) {
+            ATOMIC_VERBOSE(5, "atomic/sm disabled: no fallback component");
+            return NULL;
+        }
+    }
+
+    *priority = mca_atomic_sm_component.priority;
+
+    module = OBJ_NEW(mca_atomic_sm_module_t);
+    if (module) {
+        module->super.atomic_add   = mca_atomic_sm_add;
+        module->super.atomic_and   = mca_atomic_sm_and;
+        module->super.atomic_or    = mca_atomic_sm_or;
+        module->super.atomic_xor   = mca_atomic_sm_xor;
+        module->super.atomic_fadd  = mca_atomic_sm_fadd;
+        module->super.atomic_fand  = mca_atomic_sm_fand;
+        module->super.atomic_for   = mca_atomic_sm_for;
+        module->super.atomic_fxor  = mca_atomic_sm_fxor;
+        module->super.atomic_swap  = mca_atomic_sm_swap;
+        module->super.atomic_cswap = mca_atomic_sm_cswap;
+        return &(module->super);
+    }
+
+    return NULL ;
+}
@@ -0,0 +1,34 @@
+# -*- shell-script -*-
+#
+# $COPYRIGHT$
+#
+# Additional copyrights may follow
+#
+# $HEADER$
+#
+
+# MCA_oshmem_spml_sm_CONFIG([action-if-can-compile],
+#                           [action-if-cant-compile])
+# ------------------------------------------------
+
+AC_DEFUN([MCA_oshmem_spml_sm_CONFIG],[
+    AC_CONFIG_FILES([oshmem/mca/spml/sm/Makefile])
+
+    OPAL_VAR_SCOPE_PUSH([spml_sm_cma_happy])
+
+    # CMA is only needed to reach the static data segment of peers,
+    # the symmetric heap is always attached through sshmem
+    OPAL_CHECK_CMA([spml_sm], [AC_CHECK_HEADER([sys/prctl.h]) spml_sm_cma_happy=1], [spml_sm_cma_happy=0])
+
+    AC_DEFINE_UNQUOTED([OSHMEM_SPML_SM_HAVE_CMA], [$spml_sm_cma_happy],
+        [If CMA support can be enabled within spml sm])
+
+    OPAL_VAR_SCOPE_POP
+
+    # always happy
+    [$1]
+
+    AC_SUBST([spml_sm_CPPFLAGS])
+    AC_SUBST([spml_sm_LDFLAGS])
+    AC_SUBST([spml_sm_LIBS])
+])dnl
@@ -0,0 +1,386 @@
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#include <sys/types.h>
+#include <unistd.h>
+#include <stdint.h>
+
+#include "oshmem_config.h"
+#include "opal/sys/atomic.h"
+#include "opal/util/proc.h"
+#include "opal/util/show_help.h"
+#include "ompi/datatype/ompi_datatype.h"
+#include "ompi/mca/pml/pml.h"
+
+#include "oshmem/mca/spml/sm/spml_sm.h"
+#include "oshmem/include/shmem.h"
+#include "oshmem/mca/memheap/memheap.h"
+#include "oshmem/mca/memheap/base/base.h"
+#include "oshmem/proc/proc.h"
+#include "oshmem/mca/spml/base/base.h"
+#include "oshmem/mca/sshmem/base/base.h"
+#include "oshmem/mca/atomic/atomic.h"
+#include "oshmem/runtime/runtime.h"
+
+#include "oshmem/mca/spml/sm/spml_sm_component.h"
+
+#if OSHMEM_SPML_SM_HAVE_CMA
+#include <sys/uio.h>
+
+#if OPAL_CMA_NEED_SYSCALL_DEFS
+#include "opal/sys/cma.h"
+#endif /* OPAL_CMA_NEED_SYSCALL_DEFS */
+#endif
+
+mca_spml_sm_t mca_spml_sm = {
+    .super = {
+        /* Init mca_spml_base_module_t */
+        .spml_add_procs     = mca_spml_sm_add_procs,
+        .spml_del_procs     = mca_spml_sm_del_procs,
+        .spml_enable        = mca_spml_sm_enable,
+        .spml_register      = mca_spml_sm_register,
+        .spml_deregister    = mca_spml_sm_deregister,
+        .spml_oob_get_mkeys = mca_spml_base_oob_get_mkeys,
+        .spml_ctx_create    = mca_spml_sm_ctx_create,
+        .spml_ctx_destroy   = mca_spml_sm_ctx_destroy,
+        .spml_put           = mca_spml_sm_put,
+        .spml_put_nb        = mca_spml_sm_put_nb,
+        .spml_get           = mca_spml_sm_get,
+        .spml_get_nb        = mca_spml_sm_get_nb,
+        .spml_recv          = mca_spml_sm_recv,
+        .spml_send          = mca_spml_sm_send,
+        .spml_wait          = mca_spml_base_wait,
+        .spml_wait_nb       = mca_spml_base_wait_nb,
+        .spml_test          = mca_spml_base_test,
+        .spml_fence         = mca_spml_sm_fence,
+        .spml_quiet         = mca_spml_sm_quiet,
+        .spml_rmkey_unpack  = mca_spml_base_rmkey_unpack,
+        .spml_rmkey_free    = mca_spml_base_rmkey_free,
+        .spml_rmkey_ptr     = mca_spml_base_rmkey_ptr,
+        .spml_memuse_hook   = mca_spml_base_memuse_hook,
+        .spml_put_all_nb    = mca_spml_sm_put_all_nb,
+        .self               = (void*)&mca_spml_sm
+    },
+
+    .priority               = 0,
+    .enabled                = false
+};
+
+mca_spml_sm_ctx_t mca_spml_sm_ctx_default = {
+    .options = 0
+};
+
+static char spml_sm_transport_ids[1] = { 0 };
+
+int mca_spml_sm_enable(bool enable)
+{
+    SPML_VERBOSE(50, "*** sm ENABLED ****");
+    if (false == enable) {
+        return OSHMEM_SUCCESS;
+    }
+
+    mca_spml_sm.enabled = true;
+
+    return OSHMEM_SUCCESS;
+}
+
+int mca_spml_sm_add_procs(ompi_proc_t** procs, size_t nprocs)
+{
+    size_t i;
+
+    for (i = 0; i < nprocs; i++) {
+        if (!OPAL_PROC_ON_LOCAL_NODE(procs[i]->super.proc_flags)) {
+            SPML_ERROR("PE %d is not on the local node, spml sm "
+                       "supports single node jobs only", (int)i);
+            return OSHMEM_ERR_NOT_SUPPORTED;
+        }
+
+        OSHMEM_PROC_DATA(procs[i])->num_transports = 1;
+        OSHMEM_PROC_DATA(procs[i])->transport_ids = spml_sm_transport_ids;
+    }
+
+    SPML_VERBOSE(50, "*** sm ADDED PROCS ***");
+    return OSHMEM_SUCCESS;
+}
+
+int mca_spml_sm_del_procs(ompi_proc_t** procs, size_t nprocs)
+{
+    /* peers segments are detached by memheap, nothing is kept here */
+    return OSHMEM_SUCCESS;
+}
+
+sshmem_mkey_t *mca_spml_sm_register(void* addr,
+                                    size_t size,
+                                    uint64_t shmid,
+                                    int *count)
+{
+    sshmem_mkey_t *mkeys;
+
+    *count = 0;
+    mkeys = (sshmem_mkey_t *) calloc(1, sizeof(*mkeys));
+    if (!mkeys) {
+        return NULL;
+    }
+
+    if (MAP_SEGMENT_SHM_INVALID != (int)shmid) {
+        /* shared memory key: peers attach the segment by its id
+         * when the mkeys are unpacked, see memheap_attach_segment()
+         */
+        mkeys[0].va_base = 0;
+        mkeys[0].len     = 0;
+        mkeys[0].u.key   = shmid;
+    } else {
+        static bool heap_warned = false;
+        int segno = memheap_find_segnum(addr);
+
+        /* only static data is expected here: a heap that is not shared
+         * memory means the sshmem component can not serve spml sm */
+        if (!heap_warned && MEMHEAP_SEG_INVALID != segno &&
+            MAP_SEGMENT_STATIC != memheap_find_seg(segno)->type) {
+            heap_warned = true;
+            opal_show_help("help-oshmem-spml-sm.txt", "heap not shared", true,
+                           mca_sshmem_base_component->base_version.mca_component_name,
+                           opal_process_info.nodename,
+#if OSHMEM_SPML_SM_HAVE_CMA
+                           "process_vm_readv/writev"
+#else
+                           "none (remote access will fail)"
+#endif
+                           );
+        }
+#if OSHMEM_SPML_SM_HAVE_CMA
+        /* static data or a private heap: publish our pid so that peers
+         * can reach the segment with process_vm_readv/writev
+         */
+        pid_t *pid = (pid_t *) malloc(sizeof(*pid));
+
+        if (!pid) {
+            free(mkeys);
+            return NULL;
+        }
+        *pid = getpid();
+        mkeys[0].va_base = addr;
+        mkeys[0].len     = sizeof(*pid);
+        mkeys[0].u.data  = pid;
+#else
+        SPML_VERBOSE(5, "segment %p - %p is not shareable, remote access "
+                     "to it will fail", addr, (void *)((uintptr_t)addr + size));
+        mkeys[0].va_base = 0;
+        mkeys[0].len     = 0;
+        mkeys[0].u.key   = MAP_SEGMENT_SHM_INVALID;
+#endif
+    }
+
+    *count = 1;
+    return mkeys;
+}
+
+int mca_spml_sm_deregister(sshmem_mkey_t *mkeys)
+{
+    MCA_SPML_CALL(quiet(oshmem_ctx_default));
+    if (!mkeys) {
+        return OSHMEM_SUCCESS;
+    }
+
+    if (0 < mkeys[0].len) {
+        free(mkeys[0].u.data);
+    }
+
+    free(mkeys);
+
+    return OSHMEM_SUCCESS;
+}
+
+int mca_spml_sm_ctx_create(long options, shmem_ctx_t *ctx)
+{
+    mca_spml_sm_ctx_t *sm_ctx;
+
+    /* there is no per context state: all operations complete in the
+     * caller, the context only has to be a distinct handle
+     */
+    sm_ctx = (mca_spml_sm_ctx_t *) malloc(sizeof(*sm_ctx));
+    if (NULL == sm_ctx) {
+        return OSHMEM_ERR_OUT_OF_RESOURCE;
+    }
+
+    sm_ctx->options = options;
+    *ctx = (shmem_ctx_t)sm_ctx;
+
+    return OSHMEM_SUCCESS;
+}
+
+void mca_spml_sm_ctx_destroy(shmem_ctx_t ctx)
+{
+    MCA_SPML_CALL(quiet(ctx));
+
+    if (ctx != oshmem_ctx_default) {
+        free(ctx);
+    }
+}
+
+#if OSHMEM_SPML_SM_HAVE_CMA
+static int spml_sm_cma_copy(sshmem_mkey_t *mkey, void *local_addr,
+                            void *remote_addr, size_t size, bool is_write)
+{
+    struct iovec local_iov  = {.iov_base = local_addr, .iov_len = size};
+    struct iovec remote_iov = {.iov_base = remote_addr, .iov_len = size};
+    pid_t pid = *(pid_t *)mkey->u.data;
+    ssize_t ret;
+
+    /* large transfers may complete partially, see btl vader */
+    while (0 < remote_iov.iov_len) {
+        ret = is_write ?
+            process_vm_writev(pid, &local_iov, 1, &remote_iov, 1, 0) :
+            process_vm_readv(pid, &local_iov, 1, &remote_iov, 1, 0);
+        if (0 > ret) {
+            SPML_ERROR("%s of %llu bytes at pid %d failed: errno = %d",
+                       is_write ? "write" : "read",
+                       (unsigned long long)remote_iov.iov_len, (int)pid, errno);
+            return OSHMEM_ERROR;
+        }
+        local_iov.iov_base  = (void *)((char *)local_iov.iov_base + ret);
+        local_iov.iov_len  -= ret;
+        remote_iov.iov_base = (void *)((char *)remote_iov.iov_base + ret);
+        remote_iov.iov_len -= ret;
+    }
+
+    return OSHMEM_SUCCESS;
+}
+#endif
+
+static inline int spml_sm_copy(shmem_ctx_t ctx, void *va, void *local_addr,
+                               size_t size, int pe, bool is_write)
+{
+    sshmem_mkey_t *mkey;
+    void *rva;
+
+    if (0 == size) {
+        return OSHMEM_SUCCESS;
+    }
+
+    mkey = mca_spml_sm_get_mkey(ctx, pe, va, &rva);
+    if (NULL == mkey || mca_memheap_base_mkey_is_shm(mkey)) {
+        if (is_write) {
+            memcpy(rva, local_addr, size);
+        } else {
+            memcpy(local_addr, rva, size);
+        }
+        return OSHMEM_SUCCESS;
+    }
+
+#if OSHMEM_SPML_SM_HAVE_CMA
+    if (sizeof(pid_t) == mkey->len) {
+        return spml_sm_cma_copy(mkey, local_addr, rva, size, is_write);
+    }
+#endif
+
+    SPML_ERROR("pe=%d: %p is not mapped by this process", pe, va);
+    return OSHMEM_ERROR;
+}
+
+int mca_spml_sm_get(shmem_ctx_t ctx, void *src_addr, size_t size, void *dst_addr, int src)
+{
+    return spml_sm_copy(ctx, src_addr, dst_addr, size, src, false);
+}
+
+int mca_spml_sm_get_nb(shmem_ctx_t ctx, void *src_addr, size_t size, void *dst_addr, int src, void **handle)
+{
+    /* copies complete in place */
+    return spml_sm_copy(ctx, src_addr, dst_addr, size, src, false);
+}
+
+int mca_spml_sm_put(shmem_ctx_t ctx, void* dst_addr, size_t size, void* src_addr, int dst)
+{
+    return spml_sm_copy(ctx, dst_addr, src_addr, size, dst, true);
+}
+
+int mca_spml_sm_put_nb(shmem_ctx_t ctx, void* dst_addr, size_t size, void* src_addr, int dst, void **handle)
+{
+    /* copies complete in place */
+    return spml_sm_copy(ctx, dst_addr, src_addr, size, dst, true);
+}
+
+int mca_spml_sm_fence(shmem_ctx_t ctx)
+{
+    /* order our stores to peer segments */
+    opal_atomic_wmb();
+    return OSHMEM_SUCCESS;
+}
+
+int mca_spml_sm_quiet(shmem_ctx_t ctx)
+{
+    /* every put already happened in the caller, make them visible
+     * before any later load or store
+     */
+    opal_atomic_mb();
+    return OSHMEM_SUCCESS;
+}
+
+/* blocking receive */
+int mca_spml_sm_recv(void* buf, size_t size, int src)
+{
+    int rc = OSHMEM_SUCCESS;
+
+    rc = MCA_PML_CALL(recv(buf,
+                size,
+                &(ompi_mpi_unsigned_char.dt),
+                src,
+                0,
+                &(ompi_mpi_comm_world.comm),
+                NULL));
+
+    return rc;
+}
+
+/* for now only do blocking copy send */
+int mca_spml_sm_send(void* buf,
+                     size_t size,
+                     int dst,
+                     mca_spml_base_put_mode_t mode)
+{
+    int rc = OSHMEM_SUCCESS;
+
+    rc = MCA_PML_CALL(send(buf,
+                size,
+                &(ompi_mpi_unsigned_char.dt),
+                dst,
+                0,
+                (mca_pml_base_send_mode_t)mode,
+                &(ompi_mpi_comm_world.comm)));
+
+    return rc;
+}
+
+int mca_spml_sm_put_all_nb(void *dest, const void *source, size_t size, long *counter)
+{
+    int my_pe = oshmem_my_proc_id();
+    long val  = 1;
+    int peer, dst_pe, rc;
+
+    for (peer = 0; peer < oshmem_num_procs(); peer++) {
+        dst_pe = (peer + my_pe) % oshmem_num_procs();
+        rc = mca_spml_sm_put(oshmem_ctx_default,
+                             (void*)((uintptr_t)dest + my_pe * size),
+                             size,
+                             (void*)((uintptr_t)source + dst_pe * size),
+                             dst_pe);
+        RUNTIME_CHECK_RC(rc);
+
+        mca_spml_sm_fence(oshmem_ctx_default);
+
+        rc = MCA_ATOMIC_CALL(add(oshmem_ctx_default, (void*)counter, val, sizeof(val), dst_pe));
+        RUNTIME_CHECK_RC(rc);
+    }
+
+    return OSHMEM_SUCCESS;
+}
@@ -0,0 +1,121 @@
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+/**
+ *  @file
+ */
+
+#ifndef MCA_SPML_SM_H
+#define MCA_SPML_SM_H
+
+#include "oshmem_config.h"
+#include "oshmem/mca/spml/spml.h"
+#include "oshmem/mca/spml/base/base.h"
+#include "oshmem/util/oshmem_util.h"
+#include "oshmem/proc/proc.h"
+#include "oshmem/runtime/runtime.h"
+
+#include "oshmem/mca/memheap/memheap.h"
+#include "oshmem/mca/memheap/base/base.h"
+
+BEGIN_C_DECLS
+
+/**
+ * Shared memory SPML module
+ *
+ * Every PE of the job lives on the same node. The symmetric heap of
+ * each peer is attached by memheap through sshmem while the mkeys are
+ * exchanged, so put/get are plain copies into the attached mapping.
+ * The static data segment cannot be shared this way; it is reached
+ * through Linux CMA when available.
+ */
+struct mca_spml_sm_ctx {
+    long options;
+};
+typedef struct mca_spml_sm_ctx mca_spml_sm_ctx_t;
+
+struct mca_spml_sm {
+    mca_spml_base_module_t   super;
+    int                      priority;
+    bool                     enabled;
+};
+typedef struct mca_spml_sm mca_spml_sm_t;
+
+extern mca_spml_sm_t mca_spml_sm;
+extern mca_spml_sm_ctx_t mca_spml_sm_ctx_default;
+
+extern int mca_spml_sm_enable(bool enable);
+extern int mca_spml_sm_ctx_create(long options,
+                                  shmem_ctx_t *ctx);
+extern void mca_spml_sm_ctx_destroy(shmem_ctx_t ctx);
+extern int mca_spml_sm_get(shmem_ctx_t ctx,
+                           void* dst_addr,
+                           size_t size,
+                           void* src_addr,
+                           int src);
+extern int mca_spml_sm_get_nb(shmem_ctx_t ctx,
+                              void* dst_addr,
+                              size_t size,
+                              void* src_addr,
+                              int src,
+                              void **handle);
+extern int mca_spml_sm_put(shmem_ctx_t ctx,
+                           void* dst_addr,
+                           size_t size,
+                           void* src_addr,
+                           int dst);
+extern int mca_spml_sm_put_nb(shmem_ctx_t ctx,
+                              void* dst_addr,
+                              size_t size,
+                              void* src_addr,
+                              int dst,
+                              void **handle);
+extern int mca_spml_sm_recv(void* buf, size_t size, int src);
+extern int mca_spml_sm_send(void* buf,
+                            size_t size,
+                            int dst,
+                            mca_spml_base_put_mode_t mode);
+extern sshmem_mkey_t *mca_spml_sm_register(void* addr,
+                                           size_t size,
+                                           uint64_t shmid,
+                                           int *count);
+extern int mca_spml_sm_deregister(sshmem_mkey_t *mkeys);
+extern int mca_spml_sm_add_procs(ompi_proc_t** procs, size_t nprocs);
+extern int mca_spml_sm_del_procs(ompi_proc_t** procs, size_t nprocs);
+extern int mca_spml_sm_fence(shmem_ctx_t ctx);
+extern int mca_spml_sm_quiet(shmem_ctx_t ctx);
+extern int mca_spml_sm_put_all_nb(void *target, const void *source,
+                                  size_t size, long *counter);
+
+/**
+ * Look up the mkey of pe for the symmetric address va and translate va
+ * into rva. For a shared memory key rva is directly addressable by this
+ * process; otherwise it is the address of the object in the peer.
+ * Returns NULL (and rva = va) when pe is this process.
+ */
+static inline sshmem_mkey_t *mca_spml_sm_get_mkey(shmem_ctx_t ctx, int pe,
+                                                  void *va, void **rva)
+{
+    sshmem_mkey_t *mkey;
+
+    if (pe == oshmem_my_proc_id()) {
+        *rva = va;
+        return NULL;
+    }
+
+    mkey = mca_memheap_base_get_cached_mkey(ctx, pe, va, 0, rva);
+    if (OPAL_UNLIKELY(NULL == mkey)) {
+        SPML_ERROR("pe=%d: %p is not address of shared variable", pe, va);
+        oshmem_shmem_abort(-1);
+    }
+
+    return mkey;
+}
+
+END_C_DECLS
+
+#endif
@@ -0,0 +1,137 @@
+/*
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "oshmem_config.h"
+#include "shmem.h"
+#include "oshmem/runtime/params.h"
+#include "oshmem/mca/spml/spml.h"
+#include "oshmem/mca/spml/base/base.h"
+#include "spml_sm_component.h"
+#include "oshmem/mca/spml/sm/spml_sm.h"
+
+#include "opal/util/proc.h"
+#include "ompi/proc/proc.h"
+
+#if OSHMEM_SPML_SM_HAVE_CMA && defined(HAVE_SYS_PRCTL_H)
+#include <sys/prctl.h>
+#endif
+
+static int mca_spml_sm_component_register(void);
+static int mca_spml_sm_component_open(void);
+static int mca_spml_sm_component_close(void);
+static mca_spml_base_module_t*
+mca_spml_sm_component_init(int* priority,
+                           bool enable_progress_threads,
+                           bool enable_mpi_threads);
+static int mca_spml_sm_component_fini(void);
+mca_spml_base_component_2_0_0_t mca_spml_sm_component = {
+
+    /* First, the mca_base_component_t struct containing meta
+       information about the component itself */
+
+    .spmlm_version = {
+        MCA_SPML_BASE_VERSION_2_0_0,
+
+        .mca_component_name            = "sm",
+        .mca_component_major_version   = OSHMEM_MAJOR_VERSION,
+        .mca_component_minor_version   = OSHMEM_MINOR_VERSION,
+        .mca_component_release_version = OSHMEM_RELEASE_VERSION,
+        .mca_open_component            = mca_spml_sm_component_open,
+        .mca_close_component           = mca_spml_sm_component_close,
+        .mca_query_component           = NULL,
+        .mca_register_component_params = mca_spml_sm_component_register
+    },
+    .spmlm_data = {
+        /* The component is checkpoint ready */
+        .param_field                   = MCA_BASE_METADATA_PARAM_CHECKPOINT
+    },
+
+    .spmlm_init                        = mca_spml_sm_component_init,
+    .spmlm_finalize                    = mca_spml_sm_component_fini
+};
+
+static inline void mca_spml_sm_param_register_int(const char* param_name,
+                                                  int default_value,
+                                                  const char *help_msg,
+                                                  int *storage)
+{
+    *storage = default_value;
+    (void) mca_base_component_var_register(&mca_spml_sm_component.spmlm_version,
+                                           param_name,
+                                           help_msg,
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                           OPAL_INFO_LVL_9,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           storage);
+}
+
+static int mca_spml_sm_component_register(void)
+{
+    mca_spml_sm_param_register_int("priority", 10,
+                                   "[integer] sm priority",
+                                   &mca_spml_sm.priority);
+
+    return OSHMEM_SUCCESS;
+}
+
+static int mca_spml_sm_component_open(void)
+{
+    return OSHMEM_SUCCESS;
+}
+
+static int mca_spml_sm_component_close(void)
+{
+    return OSHMEM_SUCCESS;
+}
+
+static mca_spml_base_module_t*
+mca_spml_sm_component_init(int* priority,
+                           bool enable_progress_threads,
+                           bool enable_mpi_threads)
+{
+    SPML_VERBOSE( 10, "in sm, my priority is %d\n", mca_spml_sm.priority);
+
+    if ((*priority) > mca_spml_sm.priority) {
+        *priority = mca_spml_sm.priority;
+        return NULL ;
+    }
+
+    /* peers segments can only be attached when every PE is on this node */
+    if ((size_t)opal_process_info.num_local_peers + 1 != ompi_proc_world_size()) {
+        SPML_VERBOSE(10, "sm disqualified: job spans more than one node");
+        return NULL ;
+    }
+    *priority = mca_spml_sm.priority;
+
+#if OSHMEM_SPML_SM_HAVE_CMA && defined(PR_SET_PTRACER)
+    /* let peers reach our static data segment with CMA even when
+     * yama restricts ptrace to the process tree
+     */
+    (void) prctl(PR_SET_PTRACER, PR_SET_PTRACER_ANY, 0, 0, 0);
+#endif
+
+    oshmem_ctx_default = (shmem_ctx_t) &mca_spml_sm_ctx_default;
+
+    SPML_VERBOSE(50, "*** sm initialized ****");
+    return &mca_spml_sm.super;
+}
+
+static int mca_spml_sm_component_fini(void)
+{
+    if (!mca_spml_sm.enabled) {
+        return OSHMEM_SUCCESS; /* never selected.. return success.. */
+    }
+
+    mca_spml_sm.enabled = false;  /* not anymore */
+    return OSHMEM_SUCCESS;
+}
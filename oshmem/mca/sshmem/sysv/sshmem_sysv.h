@@ -27,6 +27,8 @@ typedef struct mca_sshmem_sysv_component_t {
     mca_sshmem_base_component_t super;
     /* priority for sysv component */
     int priority;
+    /* priority used instead when spml sm is selected */
+    int spml_sm_priority;
     int use_hp;
 } mca_sshmem_sysv_component_t;
 
@@ -40,6 +40,7 @@
 
 #include "oshmem/mca/sshmem/sshmem.h"
 #include "oshmem/mca/sshmem/base/base.h"
+#include "oshmem/mca/spml/base/base.h"
 
 #include "sshmem_sysv.h"
 
@@ -165,6 +166,12 @@ sysv_runtime_query(mca_base_module_t **module,
     /* all is well - rainbows and butterflies */
     else {
         *priority = mca_sshmem_sysv_component.priority;
+        /* spml sm reaches peers by attaching their heap, which an
+         * anonymous private mapping can not provide: outbid mmap then */
+        if (!strcmp(mca_spml_base_selected_component.spmlm_version.mca_component_name, "sm") &&
+            *priority < mca_sshmem_sysv_component.spml_sm_priority) {
+            *priority = mca_sshmem_sysv_component.spml_sm_priority;
+        }
         *module = (mca_base_module_t *)&mca_sshmem_sysv_module.super;
     }
 
@@ -190,6 +197,16 @@ sysv_register(void)
                                            MCA_BASE_VAR_SCOPE_ALL_EQ,
                                            &mca_sshmem_sysv_component.priority);
 
+    mca_sshmem_sysv_component.spml_sm_priority = 50;
+    (void) mca_base_component_var_register(&mca_sshmem_sysv_component.super.base_version,
+                                           "spml_sm_priority", "Priority for the sshmem sysv "
+                                           "component when spml sm is selected, set higher "
+                                           "than mmap's priority (default: 50)", MCA_BASE_VAR_TYPE_INT,
+                                           NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE,
+                                           OPAL_INFO_LVL_3,
+                                           MCA_BASE_VAR_SCOPE_ALL_EQ,
+                                           &mca_sshmem_sysv_component.spml_sm_priority);
+
     mca_sshmem_sysv_component.use_hp = -1;
     mca_base_component_var_register (&mca_sshmem_sysv_component.super.base_version,
                                            "use_hp", "Huge pages usage "